@@ -35,3 +35,25 @@ CREATE OR REPLACE FUNCTION _timescaledb_internal.calculate_chunk_interval(
         dimension_coord BIGINT,
         chunk_target_size BIGINT
 ) RETURNS BIGINT AS '@MODULE_PATHNAME@', 'ts_calculate_chunk_interval' LANGUAGE C;
+
+-- Create the chunks for the next time interval (one per space
+-- partition) of a hypertable ahead of time, and for the following
+-- intervals that are needed to cover the lookahead. Returns the number
+-- of chunks created. This is also done periodically for all hypertables
+-- by the 'precreate_chunks' background job, with its schedule interval
+-- as the lookahead, if timescaledb.precreate_chunks is turned on.
+CREATE OR REPLACE FUNCTION _timescaledb_internal.precreate_chunks(
+        hypertable REGCLASS,
+        lookahead INTERVAL = NULL
+) RETURNS INTEGER AS '@MODULE_PATHNAME@', 'ts_hypertable_precreate_chunks_sql' LANGUAGE C VOLATILE;
+
+-- Rewrite a chunk to the physical layout of its hypertable. A chunk
+-- that was created after a column was dropped from the hypertable
+-- lacks the dropped column, so rows inserted into the hypertable have
+-- to be converted to the chunk's row type. The rewritten chunk keeps
+-- its rows, privileges and the constraints, triggers and indexes it
+-- gets from the hypertable. Returns true if the chunk was rewritten
+-- and false if it already had the hypertable's layout.
+CREATE OR REPLACE FUNCTION _timescaledb_internal.repair_chunk_layout(
+        chunk REGCLASS
+) RETURNS BOOLEAN AS '@MODULE_PATHNAME@', 'ts_chunk_repair_layout' LANGUAGE C VOLATILE STRICT;
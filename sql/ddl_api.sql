@@ -129,3 +129,22 @@ AS '@MODULE_PATHNAME@', 'ts_tablespace_detach_all_from_hypertable' LANGUAGE C VO
 
 CREATE OR REPLACE FUNCTION show_tablespaces(hypertable REGCLASS) RETURNS SETOF NAME
 AS '@MODULE_PATHNAME@', 'ts_tablespace_show' LANGUAGE C VOLATILE STRICT;
+
+-- Insert rows given as one array per column, in the order of the
+-- hypertable's columns. All arrays must have the same length.
+-- Returns the number of rows inserted.
+CREATE OR REPLACE FUNCTION ingest(
+    hypertable REGCLASS,
+    VARIADIC columns "any"
+) RETURNS BIGINT
+AS '@MODULE_PATHNAME@', 'ts_copy_ingest_arrays' LANGUAGE C VOLATILE;
+
+-- Track the latest row of each series in a last-point table, which is
+-- created next to the hypertable's chunks and returned. A series is
+-- identified by the value of series_column. The table is kept up-to-date by
+-- INSERT and COPY into the hypertable; drop it to stop tracking.
+CREATE OR REPLACE FUNCTION enable_last_point(
+    hypertable    REGCLASS,
+    series_column NAME
+) RETURNS REGCLASS
+AS '@MODULE_PATHNAME@', 'ts_last_point_enable' LANGUAGE C VOLATILE STRICT;
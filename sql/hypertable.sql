@@ -6,3 +6,8 @@
 -- Trigger that blocks INSERTs on the hypertable's root table
 CREATE OR REPLACE FUNCTION _timescaledb_internal.insert_blocker() RETURNS trigger
 AS '@MODULE_PATHNAME@', 'ts_hypertable_insert_blocker' LANGUAGE C;
+
+-- Trigger on the chunks of hypertables with a last-point table that tracks
+-- the rows written by INSERT and COPY
+CREATE OR REPLACE FUNCTION _timescaledb_internal.last_point_trigger() RETURNS trigger
+AS '@MODULE_PATHNAME@', 'ts_last_point_trigger' LANGUAGE C;
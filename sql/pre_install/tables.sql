@@ -66,6 +66,16 @@ CREATE TABLE IF NOT EXISTS _timescaledb_catalog.tablespace (
 );
 SELECT pg_catalog.pg_extension_config_dump('_timescaledb_catalog.tablespace', '');
 
+-- The hypertable_last_point table maps hypertables to their last-point
+-- tables, which hold the latest row of each series.
+CREATE TABLE IF NOT EXISTS _timescaledb_catalog.hypertable_last_point (
+   hypertable_id     INTEGER PRIMARY KEY REFERENCES _timescaledb_catalog.hypertable(id) ON DELETE CASCADE,
+   schema_name       NAME NOT NULL,
+   table_name        NAME NOT NULL,
+   UNIQUE (schema_name, table_name)
+);
+SELECT pg_catalog.pg_extension_config_dump('_timescaledb_catalog.hypertable_last_point', '');
+
 -- A dimension represents an axis along which data is partitioned.
 CREATE TABLE IF NOT EXISTS _timescaledb_catalog.dimension (
     id                          SERIAL   NOT NULL PRIMARY KEY,
@@ -134,6 +144,8 @@ CREATE TABLE IF NOT EXISTS _timescaledb_catalog.chunk_constraint (
 SELECT pg_catalog.pg_extension_config_dump('_timescaledb_catalog.chunk_constraint', '');
 CREATE INDEX IF NOT EXISTS chunk_constraint_chunk_id_dimension_slice_id_idx
 ON _timescaledb_catalog.chunk_constraint(chunk_id, dimension_slice_id);
+CREATE INDEX IF NOT EXISTS chunk_constraint_dimension_slice_id_idx
+ON _timescaledb_catalog.chunk_constraint(dimension_slice_id);
 
 CREATE SEQUENCE IF NOT EXISTS _timescaledb_catalog.chunk_constraint_name;
 SELECT pg_catalog.pg_extension_config_dump('_timescaledb_catalog.chunk_constraint_name', '');
@@ -164,7 +176,7 @@ CREATE TABLE IF NOT EXISTS _timescaledb_config.bgw_job (
     max_runtime         INTERVAL    NOT NULL,
     max_retries         INT         NOT NULL,
     retry_period        INTERVAL    NOT NULL,
-    CONSTRAINT  valid_job_type CHECK (job_type IN ('telemetry_and_version_check_if_enabled'))
+    CONSTRAINT  valid_job_type CHECK (job_type IN ('telemetry_and_version_check_if_enabled', 'precreate_chunks'))
 );
 ALTER SEQUENCE _timescaledb_config.bgw_job_id_seq OWNED BY _timescaledb_config.bgw_job.id;
 
@@ -1 +1,17 @@
  DROP FUNCTION IF EXISTS _timescaledb_internal.get_version();
+
+ALTER TABLE _timescaledb_config.bgw_job
+DROP CONSTRAINT valid_job_type,
+ADD CONSTRAINT valid_job_type CHECK (job_type IN ('telemetry_and_version_check_if_enabled', 'precreate_chunks'));
+
+CREATE INDEX IF NOT EXISTS chunk_constraint_dimension_slice_id_idx
+ON _timescaledb_catalog.chunk_constraint(dimension_slice_id);
+
+CREATE TABLE IF NOT EXISTS _timescaledb_catalog.hypertable_last_point (
+   hypertable_id     INTEGER PRIMARY KEY REFERENCES _timescaledb_catalog.hypertable(id) ON DELETE CASCADE,
+   schema_name       NAME NOT NULL,
+   table_name        NAME NOT NULL,
+   UNIQUE (schema_name, table_name)
+);
+SELECT pg_catalog.pg_extension_config_dump('_timescaledb_catalog.hypertable_last_point', '');
+GRANT SELECT ON _timescaledb_catalog.hypertable_last_point TO PUBLIC;
@@ -21,11 +21,13 @@
 #include "job_stat.h"
 #include "utils.h"
 #include "telemetry/telemetry.h"
+#include "hypertable.h"
 
 #define TELEMETRY_INITIAL_NUM_RUNS	12
 
 const char *job_type_names[_MAX_JOB_TYPE] = {
 	[JOB_TYPE_VERSION_CHECK] = "telemetry_and_version_check_if_enabled",
+	[JOB_TYPE_CHUNK_PRECREATE] = "precreate_chunks",
 	[JOB_TYPE_UNKNOWN] = "unknown"
 };
 
@@ -262,6 +264,8 @@ ts_bgw_job_execute(BgwJob *job)
 
 				return ts_bgw_job_run_and_set_next_start(job, ts_telemetry_main_wrapper, TELEMETRY_INITIAL_NUM_RUNS, one_hour);
 			}
+		case JOB_TYPE_CHUNK_PRECREATE:
+			return ts_hypertable_precreate_chunks_main(&job->fd.schedule_interval);
 		case JOB_TYPE_UNKNOWN:
 			if (unknown_job_type_hook != NULL)
 				return unknown_job_type_hook(job);
@@ -13,6 +13,7 @@
 typedef enum JobType
 {
 	JOB_TYPE_VERSION_CHECK = 0,
+	JOB_TYPE_CHUNK_PRECREATE,
 	JOB_TYPE_UNKNOWN,
 	_MAX_JOB_TYPE
 } JobType;
@@ -34,6 +34,12 @@
  * to signal other backends. If the received table OID is a dummy table, we know
  * that this is an event that we care about.
  *
+ * Changes that only affect a single hypertable are instead signaled on the
+ * hypertable's main table, so that only the cache entry for that hypertable
+ * (and its chunks) is invalidated. Since the events for the main table also
+ * include regular relcache invalidations (e.g., on ALTER TABLE), entries may be
+ * invalidated more often than necessary, but never less.
+ *
  * Caches for catalog tables should be invalidated on:
  *
  * 1. INSERT/UPDATE/DELETE on a catalog table
@@ -44,7 +50,10 @@
  * (e.g., a new dimension of a hypertable), or when replacing an existing entry
  * (e.g., when replacing a negative hypertable entry with a positive one). Note,
  * also, that INSERTS can taint the cache if the transaction that did the INSERT
- * fails. This is why we also need to invalidate caches on transaction failure.
+ * fails. This is why we also need to invalidate caches on transaction failure,
+ * unless the transaction did not modify the catalog. Keeping the caches on
+ * other failures matters for workloads with frequent aborts, since the caches
+ * also hold negative entries for the regular tables that queries plan on.
  */
 
 void		_cache_invalidate_init(void);
@@ -76,8 +85,12 @@ cache_invalidate_callback(Datum arg, Oid relid)
 
 	catalog = ts_catalog_get();
 
-	if (relid == ts_catalog_get_cache_proxy_id(catalog, CACHE_TYPE_HYPERTABLE))
+	/* An invalid OID means that all relcache entries are invalidated */
+	if (!OidIsValid(relid) ||
+		relid == ts_catalog_get_cache_proxy_id(catalog, CACHE_TYPE_HYPERTABLE))
 		ts_hypertable_cache_invalidate_callback();
+	else
+		ts_hypertable_cache_invalidate_entry(relid);
 
 	if (relid == ts_catalog_get_cache_proxy_id(catalog, CACHE_TYPE_BGW_JOB))
 		ts_bgw_job_cache_invalidate_callback();
@@ -116,7 +129,15 @@ cache_invalidate_xact_end(XactEvent event, void *arg)
 			 * change since the transaction hasn't been committed and other
 			 * backends cannot have the invalid state.
 			 */
-			cache_invalidate_all();
+			if (ts_catalog_modified_in_transaction())
+				cache_invalidate_all();
+			ts_catalog_reset_modified();
+			break;
+		case XACT_EVENT_COMMIT:
+		case XACT_EVENT_PARALLEL_COMMIT:
+		case XACT_EVENT_PREPARE:
+			ts_catalog_reset_modified();
+			break;
 		default:
 			break;
 	}
@@ -134,7 +155,8 @@ cache_invalidate_subxact_end(SubXactEvent event, SubTransactionId mySubid,
 			 * Invalidate caches on aborted sub transactions. See notes above
 			 * in cache_invalidate_xact_end.
 			 */
-			cache_invalidate_all();
+			if (ts_catalog_modified_in_transaction())
+				cache_invalidate_all();
 		default:
 			break;
 	}
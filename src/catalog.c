@@ -20,7 +20,10 @@
 
 #include "compat.h"
 #include "catalog.h"
+#include "chunk.h"
+#include "dimension.h"
 #include "extension.h"
+#include "hypertable.h"
 
 #if PG10
 #include <utils/regproc.h>
@@ -55,6 +58,10 @@ static const TableInfoDef catalog_table_names[_MAX_CATALOG_TABLES + 1] = {
 		.schema_name = CATALOG_SCHEMA_NAME,
 		.table_name = TABLESPACE_TABLE_NAME,
 	},
+	[HYPERTABLE_LAST_POINT] = {
+		.schema_name = CATALOG_SCHEMA_NAME,
+		.table_name = HYPERTABLE_LAST_POINT_TABLE_NAME,
+	},
 	[BGW_JOB] = {
 		.schema_name = CONFIG_SCHEMA_NAME,
 		.table_name = BGW_JOB_TABLE_NAME,
@@ -108,6 +115,7 @@ static const TableIndexDef catalog_table_index_definitions[_MAX_CATALOG_TABLES]
 		.names = (char *[]) {
 			[CHUNK_CONSTRAINT_CHUNK_ID_CONSTRAINT_NAME_IDX] = "chunk_constraint_chunk_id_constraint_name_key",
 			[CHUNK_CONSTRAINT_CHUNK_ID_DIMENSION_SLICE_ID_IDX] = "chunk_constraint_chunk_id_dimension_slice_id_idx",
+			[CHUNK_CONSTRAINT_DIMENSION_SLICE_ID_IDX] = "chunk_constraint_dimension_slice_id_idx",
 		}
 	},
 	[CHUNK_INDEX] = {
@@ -124,6 +132,13 @@ static const TableIndexDef catalog_table_index_definitions[_MAX_CATALOG_TABLES]
 			[TABLESPACE_HYPERTABLE_ID_TABLESPACE_NAME_IDX] = "tablespace_hypertable_id_tablespace_name_key",
 		}
 	},
+	[HYPERTABLE_LAST_POINT] = {
+		.length = _MAX_HYPERTABLE_LAST_POINT_INDEX,
+		.names = (char *[]) {
+			[HYPERTABLE_LAST_POINT_PKEY_IDX] = "hypertable_last_point_pkey",
+			[HYPERTABLE_LAST_POINT_SCHEMA_NAME_TABLE_NAME_IDX] = "hypertable_last_point_schema_name_table_name_key",
+		}
+	},
 	[BGW_JOB] = {
 		.length = _MAX_BGW_JOB_INDEX,
 		.names = (char *[]) {
@@ -152,6 +167,7 @@ static const char *catalog_table_serial_id_names[_MAX_CATALOG_TABLES] = {
 	[CHUNK_CONSTRAINT] = CATALOG_SCHEMA_NAME ".chunk_constraint_name",
 	[CHUNK_INDEX] = NULL,
 	[TABLESPACE] = CATALOG_SCHEMA_NAME ".tablespace_id_seq",
+	[HYPERTABLE_LAST_POINT] = NULL,
 	[BGW_JOB] = CONFIG_SCHEMA_NAME ".bgw_job_id_seq",
 	[BGW_JOB_STAT] = NULL,
 };
@@ -457,23 +473,93 @@ ts_catalog_restore_user(CatalogSecurityContext *sec_ctx)
 	SetUserIdAndSecContext(sec_ctx->saved_uid, sec_ctx->saved_security_context);
 }
 
-#if PG96
-#define CatalogTupleInsert(relation, tuple)		\
-	do {										\
-		simple_heap_insert(relation, tuple);	\
-		CatalogUpdateIndexes(relation, tuple);	\
-	} while (0);
+static void catalog_invalidate_cache(Oid catalog_relid, CmdType operation, Oid hypertable_relid);
 
-#define CatalogTupleUpdate(relation, tid, tuple)	\
-	do {											\
-		simple_heap_update(relation, tid, tuple);	\
-		CatalogUpdateIndexes(relation, tuple);		\
-	} while (0);
+/*
+ * Whether the current transaction modified the catalog. Caches might hold
+ * rows that the transaction added, so they need to be invalidated if such a
+ * transaction aborts. Other aborts can keep the caches.
+ */
+static bool catalog_modified = false;
 
-#define CatalogTupleDelete(relation, tid)		\
-	simple_heap_delete(relation, tid);
+bool
+ts_catalog_modified_in_transaction(void)
+{
+	return catalog_modified;
+}
 
-#endif							/* PG96 */
+void
+ts_catalog_reset_modified(void)
+{
+	catalog_modified = false;
+}
+
+/*
+ * Get the hypertable whose cache entry is affected by a change to a catalog
+ * tuple, so that only that hypertable's cache entry needs invalidation.
+ *
+ * This must be called before the change is made, since the lookups for some
+ * catalog tables would otherwise not find the parent of a deleted tuple.
+ * Returns InvalidOid if the change does not invalidate the hypertable cache
+ * or the hypertable cannot be determined, in which case the entire cache is
+ * invalidated.
+ */
+static Oid
+catalog_get_hypertable_relid(Relation rel, HeapTuple tuple, CmdType operation)
+{
+	Catalog    *catalog = ts_catalog_get();
+	int32		hypertable_id = 0;
+
+	switch (catalog_get_table(catalog, RelationGetRelid(rel)))
+	{
+		case HYPERTABLE:
+			{
+				Form_hypertable form = (Form_hypertable) GETSTRUCT(tuple);
+				Oid			schema_oid = get_namespace_oid(NameStr(form->schema_name), true);
+
+				if (!OidIsValid(schema_oid))
+					return InvalidOid;
+
+				return get_relname_relid(NameStr(form->table_name), schema_oid);
+			}
+		case DIMENSION:
+			hypertable_id = ((Form_dimension) GETSTRUCT(tuple))->hypertable_id;
+			break;
+		case CHUNK:
+			if (operation == CMD_INSERT)
+				return InvalidOid;
+			hypertable_id = ((Form_chunk) GETSTRUCT(tuple))->hypertable_id;
+			break;
+		case CHUNK_CONSTRAINT:
+			{
+				Chunk	   *chunk;
+				bool		isnull;
+				Datum		chunk_id;
+
+				if (operation == CMD_INSERT)
+					return InvalidOid;
+
+				chunk_id = heap_getattr(tuple, Anum_chunk_constraint_chunk_id, RelationGetDescr(rel), &isnull);
+				chunk = ts_chunk_get_by_id(DatumGetInt32(chunk_id), 0, false);
+
+				if (NULL != chunk)
+					hypertable_id = chunk->fd.hypertable_id;
+				break;
+			}
+		case DIMENSION_SLICE:
+			if (operation == CMD_INSERT)
+				return InvalidOid;
+			hypertable_id = ts_dimension_get_hypertable_id(((Form_dimension_slice) GETSTRUCT(tuple))->dimension_id);
+			break;
+		default:
+			return InvalidOid;
+	}
+
+	if (hypertable_id <= 0)
+		return InvalidOid;
+
+	return ts_hypertable_id_to_relid(hypertable_id);
+}
 
 /*
  * Insert a new row into a catalog table.
@@ -481,8 +567,10 @@ ts_catalog_restore_user(CatalogSecurityContext *sec_ctx)
 static void
 catalog_insert(Relation rel, HeapTuple tuple)
 {
+	Oid			hypertable_relid = catalog_get_hypertable_relid(rel, tuple, CMD_INSERT);
+
 	CatalogTupleInsert(rel, tuple);
-	ts_catalog_invalidate_cache(RelationGetRelid(rel), CMD_INSERT);
+	catalog_invalidate_cache(RelationGetRelid(rel), CMD_INSERT, hypertable_relid);
 	/* Make changes visible */
 	CommandCounterIncrement();
 }
@@ -499,11 +587,53 @@ ts_catalog_insert_values(Relation rel, TupleDesc tupdesc, Datum *values, bool *n
 	heap_freetuple(tuple);
 }
 
+void
+ts_catalog_multi_insert_begin(CatalogMultiInsertState *state, Relation rel)
+{
+	state->rel = rel;
+	state->indstate = CatalogOpenIndexes(rel);
+	state->num_inserted = 0;
+}
+
+/*
+ * Insert a row as part of a multi-insert. The row is not visible until the
+ * multi-insert ends.
+ */
+void
+ts_catalog_multi_insert_values(CatalogMultiInsertState *state, Datum *values, bool *nulls)
+{
+	HeapTuple	tuple = heap_form_tuple(RelationGetDescr(state->rel), values, nulls);
+
+#if PG96
+	simple_heap_insert(state->rel, tuple);
+	CatalogIndexInsert(state->indstate, tuple);
+#else
+	CatalogTupleInsertWithInfo(state->rel, tuple, state->indstate);
+#endif
+	heap_freetuple(tuple);
+	state->num_inserted++;
+}
+
+void
+ts_catalog_multi_insert_end(CatalogMultiInsertState *state)
+{
+	CatalogCloseIndexes(state->indstate);
+
+	if (state->num_inserted > 0)
+	{
+		ts_catalog_invalidate_cache(RelationGetRelid(state->rel), CMD_INSERT);
+		/* Make changes visible */
+		CommandCounterIncrement();
+	}
+}
+
 void
 ts_catalog_update_tid(Relation rel, ItemPointer tid, HeapTuple tuple)
 {
+	Oid			hypertable_relid = catalog_get_hypertable_relid(rel, tuple, CMD_UPDATE);
+
 	CatalogTupleUpdate(rel, tid, tuple);
-	ts_catalog_invalidate_cache(RelationGetRelid(rel), CMD_UPDATE);
+	catalog_invalidate_cache(RelationGetRelid(rel), CMD_UPDATE, hypertable_relid);
 	/* Make changes visible */
 	CommandCounterIncrement();
 }
@@ -525,13 +655,18 @@ ts_catalog_delete_tid(Relation rel, ItemPointer tid)
 void
 ts_catalog_delete(Relation rel, HeapTuple tuple)
 {
-	ts_catalog_delete_tid(rel, &tuple->t_self);
+	Oid			hypertable_relid = catalog_get_hypertable_relid(rel, tuple, CMD_DELETE);
+
+	CatalogTupleDelete(rel, &tuple->t_self);
+	catalog_invalidate_cache(RelationGetRelid(rel), CMD_DELETE, hypertable_relid);
+	CommandCounterIncrement();
 }
 
 void
 ts_catalog_delete_only(Relation rel, HeapTuple tuple)
 {
 	CatalogTupleDelete(rel, &tuple->t_self);
+	catalog_modified = true;
 }
 
 /*
@@ -551,33 +686,38 @@ ts_catalog_delete_only(Relation rel, HeapTuple tuple)
  * triggers on catalog tables that cause side effects.
  *
  * The invalidation event is signaled to other backends (processes) via the
- * relcache invalidation mechanism on a dummy relation (table).
+ * relcache invalidation mechanism on a dummy relation (table). If the change
+ * only affects a single hypertable, the event is instead signaled on the
+ * hypertable's main table, so that backends only need to invalidate that
+ * hypertable's cache entry.
  *
- * Parameters: The OID of the catalog table that changed, and the operation
- * involved (e.g., INSERT, UPDATE, DELETE).
+ * Parameters: The OID of the catalog table that changed, the operation
+ * involved (e.g., INSERT, UPDATE, DELETE), and the OID of the affected
+ * hypertable or InvalidOid if not known.
  */
-void
-ts_catalog_invalidate_cache(Oid catalog_relid, CmdType operation)
+static void
+catalog_invalidate_cache(Oid catalog_relid, CmdType operation, Oid hypertable_relid)
 {
 	Catalog    *catalog = ts_catalog_get();
 	CatalogTable table = catalog_get_table(catalog, catalog_relid);
 	Oid			relid;
 
+	catalog_modified = true;
+
+	if (!OidIsValid(hypertable_relid))
+		hypertable_relid = ts_catalog_get_cache_proxy_id(catalog, CACHE_TYPE_HYPERTABLE);
+
 	switch (table)
 	{
 		case CHUNK:
 		case CHUNK_CONSTRAINT:
 		case DIMENSION_SLICE:
 			if (operation == CMD_UPDATE || operation == CMD_DELETE)
-			{
-				relid = ts_catalog_get_cache_proxy_id(catalog, CACHE_TYPE_HYPERTABLE);
-				CacheInvalidateRelcacheByRelid(relid);
-			}
+				CacheInvalidateRelcacheByRelid(hypertable_relid);
 			break;
 		case HYPERTABLE:
 		case DIMENSION:
-			relid = ts_catalog_get_cache_proxy_id(catalog, CACHE_TYPE_HYPERTABLE);
-			CacheInvalidateRelcacheByRelid(relid);
+			CacheInvalidateRelcacheByRelid(hypertable_relid);
 			break;
 		case BGW_JOB:
 			relid = ts_catalog_get_cache_proxy_id(catalog, CACHE_TYPE_BGW_JOB);
@@ -588,3 +728,9 @@ ts_catalog_invalidate_cache(Oid catalog_relid, CmdType operation)
 			break;
 	}
 }
+
+void
+ts_catalog_invalidate_cache(Oid catalog_relid, CmdType operation)
+{
+	catalog_invalidate_cache(catalog_relid, operation, InvalidOid);
+}
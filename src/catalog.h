@@ -12,6 +12,7 @@
 #include <utils/rel.h>
 #include <nodes/nodes.h>
 #include <access/heapam.h>
+#include <catalog/indexing.h>
 #include "export.h"
 #include "extension_constants.h"
 /*
@@ -38,6 +39,7 @@ typedef enum CatalogTable
 	CHUNK_CONSTRAINT,
 	CHUNK_INDEX,
 	TABLESPACE,
+	HYPERTABLE_LAST_POINT,
 	BGW_JOB,
 	BGW_JOB_STAT,
 	INSTALLATION_METADATA,
@@ -361,6 +363,7 @@ enum
 {
 	CHUNK_CONSTRAINT_CHUNK_ID_CONSTRAINT_NAME_IDX = 0,
 	CHUNK_CONSTRAINT_CHUNK_ID_DIMENSION_SLICE_ID_IDX,
+	CHUNK_CONSTRAINT_DIMENSION_SLICE_ID_IDX,
 	_MAX_CHUNK_CONSTRAINT_INDEX,
 };
 
@@ -371,6 +374,12 @@ enum Anum_chunk_constraint_chunk_id_dimension_slice_id_idx
 	_Anum_chunk_constraint_chunk_id_dimension_slice_id_idx_max,
 };
 
+enum Anum_chunk_constraint_dimension_slice_id_idx
+{
+	Anum_chunk_constraint_dimension_slice_id_idx_dimension_slice_id = 1,
+	_Anum_chunk_constraint_dimension_slice_id_idx_max,
+};
+
 enum Anum_chunk_constraint_chunk_id_constraint_name_idx
 {
 	Anum_chunk_constraint_chunk_id_constraint_name_idx_chunk_id = 1,
@@ -488,6 +497,54 @@ typedef struct FormData_tablespace_hypertable_id_tablespace_name_idx
 	NameData	tablespace_name;
 }			FormData_tablespace_hypertable_id_tablespace_name_idx;
 
+/************************************
+ *
+ * Hypertable last-point table definitions
+ *
+ ************************************/
+
+#define HYPERTABLE_LAST_POINT_TABLE_NAME "hypertable_last_point"
+
+enum Anum_hypertable_last_point
+{
+	Anum_hypertable_last_point_hypertable_id = 1,
+	Anum_hypertable_last_point_schema_name,
+	Anum_hypertable_last_point_table_name,
+	_Anum_hypertable_last_point_max,
+};
+
+#define Natts_hypertable_last_point \
+	(_Anum_hypertable_last_point_max - 1)
+
+typedef struct FormData_hypertable_last_point
+{
+	int32		hypertable_id;
+	NameData	schema_name;
+	NameData	table_name;
+} FormData_hypertable_last_point;
+
+typedef FormData_hypertable_last_point *Form_hypertable_last_point;
+
+enum
+{
+	HYPERTABLE_LAST_POINT_PKEY_IDX = 0,
+	HYPERTABLE_LAST_POINT_SCHEMA_NAME_TABLE_NAME_IDX,
+	_MAX_HYPERTABLE_LAST_POINT_INDEX,
+};
+
+enum Anum_hypertable_last_point_pkey_idx
+{
+	Anum_hypertable_last_point_pkey_idx_hypertable_id = 1,
+	_Anum_hypertable_last_point_pkey_idx_max,
+};
+
+enum Anum_hypertable_last_point_schema_name_table_name_idx
+{
+	Anum_hypertable_last_point_schema_name_table_name_idx_schema_name = 1,
+	Anum_hypertable_last_point_schema_name_table_name_idx_table_name,
+	_Anum_hypertable_last_point_schema_name_table_name_idx_max,
+};
+
 /************************************
  *
  * bgw_job table definitions
@@ -699,6 +756,18 @@ typedef struct CatalogSecurityContext
 	int			saved_security_context;
 } CatalogSecurityContext;
 
+/*
+ * State for inserting several rows into a catalog table. The table's indexes
+ * are opened once for all rows, and caches are invalidated and the rows made
+ * visible only when the insert ends.
+ */
+typedef struct CatalogMultiInsertState
+{
+	Relation	rel;
+	CatalogIndexState indstate;
+	int			num_inserted;
+} CatalogMultiInsertState;
+
 extern void ts_catalog_table_info_init(CatalogTableInfo *tables, int max_table, const TableInfoDef *table_ary, const TableIndexDef *index_ary, const char **serial_id_ary);
 
 extern CatalogDatabaseInfo *ts_catalog_database_info_get(void);
@@ -725,11 +794,16 @@ extern Oid	ts_catalog_get_cache_proxy_id(Catalog *catalog, CacheType type);
 extern bool ts_catalog_database_info_become_owner(CatalogDatabaseInfo *database_info, CatalogSecurityContext *sec_ctx);
 extern void ts_catalog_restore_user(CatalogSecurityContext *sec_ctx);
 extern void ts_catalog_insert_values(Relation rel, TupleDesc tupdesc, Datum *values, bool *nulls);
+extern void ts_catalog_multi_insert_begin(CatalogMultiInsertState *state, Relation rel);
+extern void ts_catalog_multi_insert_values(CatalogMultiInsertState *state, Datum *values, bool *nulls);
+extern void ts_catalog_multi_insert_end(CatalogMultiInsertState *state);
 extern void ts_catalog_update_tid(Relation rel, ItemPointer tid, HeapTuple tuple);
 extern void ts_catalog_update(Relation rel, HeapTuple tuple);
 extern void ts_catalog_delete_tid(Relation rel, ItemPointer tid);
 extern void ts_catalog_delete(Relation rel, HeapTuple tuple);
 extern void ts_catalog_invalidate_cache(Oid catalog_relid, CmdType operation);
+extern bool ts_catalog_modified_in_transaction(void);
+extern void ts_catalog_reset_modified(void);
 
 /* Delete only: do not increment command counter or invalidate caches */
 extern void ts_catalog_delete_only(Relation rel, HeapTuple tuple);
@@ -5,13 +5,20 @@
  * see LICENSE-APACHE at the top level directory.
  */
 #include <postgres.h>
+#include <access/genam.h>
+#include <catalog/dependency.h>
 #include <catalog/namespace.h>
+#include <catalog/pg_constraint.h>
+#include <catalog/pg_namespace.h>
 #include <catalog/pg_trigger.h>
 #include <catalog/indexing.h>
 #include <catalog/pg_inherits.h>
 #include <catalog/toasting.h>
 #include <commands/trigger.h>
 #include <commands/tablecmds.h>
+#include <commands/defrem.h>
+#include <commands/tablespace.h>
+#include <executor/spi.h>
 #include <tcop/tcopprot.h>
 #include <access/htup.h>
 #include <access/htup_details.h>
@@ -21,7 +28,10 @@
 #include <utils/builtins.h>
 #include <utils/lsyscache.h>
 #include <utils/syscache.h>
+#include <utils/acl.h>
+#include <utils/fmgroids.h>
 #include <utils/hsearch.h>
+#include <utils/inval.h>
 #include <storage/lmgr.h>
 #include <miscadmin.h>
 #include <funcapi.h>
@@ -38,6 +48,7 @@
 #include "catalog.h"
 #include "dimension.h"
 #include "dimension_slice.h"
+#include "dimension_slice_index.h"
 #include "dimension_vector.h"
 #include "errors.h"
 #include "partitioning.h"
@@ -50,9 +61,13 @@
 #include "utils.h"
 #include "hypertable_cache.h"
 #include "cache.h"
+#include "shared_chunk_cache.h"
+#include "chunk_constraint.h"
+#include "chunk_insert_state.h"
 
 TS_FUNCTION_INFO_V1(ts_chunk_show_chunks);
 TS_FUNCTION_INFO_V1(ts_chunk_drop_chunks);
+TS_FUNCTION_INFO_V1(ts_chunk_repair_layout);
 
 /* Used when processing scanned chunks */
 typedef enum ChunkResult
@@ -581,6 +596,456 @@ chunk_create_table(Chunk *chunk, Hypertable *ht)
 	return objaddr.objectId;
 }
 
+/*
+ * Find a type with the same length and alignment as a dropped column, to
+ * create a placeholder for the column. Types in pg_catalog are preferred.
+ */
+static Oid
+dropped_column_placeholder_type(Form_pg_attribute attr)
+{
+	Relation	rel = heap_open(TypeRelationId, AccessShareLock);
+	SysScanDesc scan = systable_beginscan(rel, InvalidOid, false, NULL, 0, NULL);
+	HeapTuple	tuple;
+	Oid			typid = InvalidOid;
+
+	while (HeapTupleIsValid(tuple = systable_getnext(scan)))
+	{
+		Form_pg_type type = (Form_pg_type) GETSTRUCT(tuple);
+
+		if (type->typtype != TYPTYPE_BASE ||
+			!type->typisdefined ||
+			type->typlen != attr->attlen ||
+			type->typalign != attr->attalign)
+			continue;
+
+		typid = HeapTupleGetOid(tuple);
+
+		if (type->typnamespace == PG_CATALOG_NAMESPACE)
+			break;
+	}
+
+	systable_endscan(scan);
+	heap_close(rel, AccessShareLock);
+
+	if (!OidIsValid(typid))
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("no type matches the layout of dropped column %d", attr->attnum)));
+
+	return typid;
+}
+
+/*
+ * Create a table with the physical layout of the hypertable to replace a
+ * chunk's table.
+ *
+ * A table that inherits from the hypertable does not get the hypertable's
+ * dropped columns, so the table is created outside inheritance, with
+ * placeholders for the dropped columns that are then dropped again. The
+ * table gets the hypertable's columns, defaults and CHECK constraints, which
+ * it needs to be added as a child of the hypertable, and the owner,
+ * tablespace and storage options of the chunk's current table.
+ */
+static Oid
+chunk_create_table_with_layout(Chunk *chunk, Relation htrel, Relation chunkrel, const char *relname)
+{
+	TupleDesc	tupdesc = RelationGetDescr(htrel);
+	TupleConstr *constr = tupdesc->constr;
+	Oid			tablespace = chunkrel->rd_rel->reltablespace;
+	CreateStmt	stmt = {
+		.type = T_CreateStmt,
+		.relation = makeRangeVar(NameStr(chunk->fd.schema_name), pstrdup(relname), 0),
+		.tablespacename = OidIsValid(tablespace) ? get_tablespace_name(tablespace) : NULL,
+		.options = get_reloptions(RelationGetRelid(chunkrel)),
+	};
+	ObjectAddress objaddr;
+	Oid			uid,
+				saved_uid;
+	int			sec_ctx;
+	int			i;
+
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = tupdesc->attrs[i];
+		ColumnDef  *coldef = makeNode(ColumnDef);
+
+		/* Placeholders get the name that they get again when dropped */
+		coldef->colname = pstrdup(NameStr(attr->attname));
+		coldef->is_local = true;
+		coldef->location = -1;
+
+		if (attr->attisdropped)
+			coldef->typeName = makeTypeNameFromOid(dropped_column_placeholder_type(attr), -1);
+		else
+		{
+			coldef->typeName = makeTypeNameFromOid(attr->atttypid, attr->atttypmod);
+			coldef->collOid = attr->attcollation;
+			coldef->is_not_null = attr->attnotnull;
+			coldef->storage = attr->attstorage;
+		}
+
+		stmt.tableElts = lappend(stmt.tableElts, coldef);
+	}
+
+	if (NULL != constr)
+	{
+		for (i = 0; i < constr->num_defval; i++)
+		{
+			ColumnDef  *coldef = list_nth(stmt.tableElts, constr->defval[i].adnum - 1);
+
+			coldef->cooked_default = stringToNode(constr->defval[i].adbin);
+		}
+
+		for (i = 0; i < constr->num_check; i++)
+		{
+			ConstrCheck *check = &constr->check[i];
+			Constraint *cdef;
+
+			if (check->ccnoinherit)
+				continue;
+
+			cdef = makeNode(Constraint);
+			cdef->contype = CONSTR_CHECK;
+			cdef->conname = pstrdup(check->ccname);
+			cdef->cooked_expr = pstrdup(check->ccbin);
+			cdef->initially_valid = true;
+			cdef->location = -1;
+			stmt.constraints = lappend(stmt.constraints, cdef);
+		}
+	}
+
+	if (htrel->rd_rel->relhasoids)
+		stmt.options = lappend(stmt.options,
+							   makeDefElem("oids", (Node *) makeInteger(true)
+#if PG10
+										   ,-1
+#endif
+										   ));
+
+	/* Create the table as the same user as chunk_create_table() does */
+	if (namestrcmp(&chunk->fd.schema_name, INTERNAL_SCHEMA_NAME) == 0)
+		uid = ts_catalog_database_info_get()->owner_uid;
+	else
+		uid = htrel->rd_rel->relowner;
+
+	GetUserIdAndSecContext(&saved_uid, &sec_ctx);
+
+	if (uid != saved_uid)
+		SetUserIdAndSecContext(uid, sec_ctx | SECURITY_LOCAL_USERID_CHANGE);
+
+	objaddr = DefineRelation(&stmt,
+							 RELKIND_RELATION,
+							 chunkrel->rd_rel->relowner,
+							 NULL
+#if PG10
+							 ,NULL
+#endif
+		);
+
+	create_toast_table(&stmt, objaddr.objectId);
+
+	if (uid != saved_uid)
+		SetUserIdAndSecContext(saved_uid, sec_ctx);
+
+	CommandCounterIncrement();
+
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		ObjectAddress colobj;
+
+		if (!tupdesc->attrs[i]->attisdropped)
+			continue;
+
+		ObjectAddressSubSet(colobj, RelationRelationId, objaddr.objectId, i + 1);
+		performDeletion(&colobj, DROP_RESTRICT, PERFORM_DELETION_INTERNAL);
+	}
+
+	CommandCounterIncrement();
+
+	set_attoptions(htrel, objaddr.objectId);
+
+	return objaddr.objectId;
+}
+
+/*
+ * Copy the rows of a chunk's table to the table that replaces it.
+ */
+static void
+chunk_table_copy_rows(Oid from_relid, Oid to_relid, TupleDesc tupdesc)
+{
+	StringInfoData columns;
+	StringInfoData command;
+	int			i;
+
+	initStringInfo(&columns);
+
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		if (tupdesc->attrs[i]->attisdropped)
+			continue;
+
+		appendStringInfo(&columns, "%s%s",
+						 columns.len > 0 ? ", " : "",
+						 quote_identifier(NameStr(tupdesc->attrs[i]->attname)));
+	}
+
+	initStringInfo(&command);
+	appendStringInfo(&command, "INSERT INTO %s (%s) SELECT %s FROM ONLY %s",
+					 quote_qualified_identifier(get_namespace_name(get_rel_namespace(to_relid)),
+												get_rel_name(to_relid)),
+					 columns.data,
+					 columns.data,
+					 quote_qualified_identifier(get_namespace_name(get_rel_namespace(from_relid)),
+												get_rel_name(from_relid)));
+
+	if (SPI_connect() != SPI_OK_CONNECT)
+		elog(ERROR, "could not connect to SPI");
+
+	if (SPI_execute(command.data, false, 0) != SPI_OK_INSERT)
+		elog(ERROR, "could not copy rows of chunk \"%s\"", get_rel_name(from_relid));
+
+	SPI_finish();
+}
+
+/*
+ * Make a table a child of the hypertable.
+ *
+ * The columns and CHECK constraints that the table gets from the hypertable
+ * are marked as only inherited, like those of a table that was created as a
+ * child, so that they are dropped together with the hypertable's.
+ */
+static void
+chunk_table_inherit(Hypertable *ht, Oid relid)
+{
+	AlterTableCmd *cmd = makeNode(AlterTableCmd);
+	Relation	rel;
+	ScanKeyData scankey;
+	SysScanDesc scan;
+	HeapTuple	tuple;
+	AttrNumber	attno;
+	int			natts = get_relnatts(relid);
+
+	cmd->subtype = AT_AddInherit;
+	cmd->def = (Node *) makeRangeVar(NameStr(ht->fd.schema_name), NameStr(ht->fd.table_name), 0);
+	AlterTableInternal(relid, list_make1(cmd), false);
+	CommandCounterIncrement();
+
+	rel = heap_open(AttributeRelationId, RowExclusiveLock);
+
+	for (attno = 1; attno <= natts; attno++)
+	{
+		Form_pg_attribute attr;
+
+		tuple = SearchSysCacheCopy2(ATTNUM, ObjectIdGetDatum(relid), Int16GetDatum(attno));
+
+		if (!HeapTupleIsValid(tuple))
+			elog(ERROR, "cache lookup failed for attribute %d of relation %u", attno, relid);
+
+		attr = (Form_pg_attribute) GETSTRUCT(tuple);
+
+		if (attr->attinhcount > 0)
+		{
+			attr->attislocal = false;
+			CatalogTupleUpdate(rel, &tuple->t_self, tuple);
+		}
+
+		heap_freetuple(tuple);
+	}
+
+	heap_close(rel, RowExclusiveLock);
+
+	rel = heap_open(ConstraintRelationId, RowExclusiveLock);
+	ScanKeyInit(&scankey, Anum_pg_constraint_conrelid, BTEqualStrategyNumber,
+				F_OIDEQ, ObjectIdGetDatum(relid));
+	scan = systable_beginscan(rel, ConstraintRelidIndexId, true, NULL, 1, &scankey);
+
+	while (HeapTupleIsValid(tuple = systable_getnext(scan)))
+	{
+		HeapTuple	copy;
+
+		if (((Form_pg_constraint) GETSTRUCT(tuple))->coninhcount == 0)
+			continue;
+
+		copy = heap_copytuple(tuple);
+		((Form_pg_constraint) GETSTRUCT(copy))->conislocal = false;
+		CatalogTupleUpdate(rel, &copy->t_self, copy);
+		heap_freetuple(copy);
+	}
+
+	systable_endscan(scan);
+	heap_close(rel, RowExclusiveLock);
+
+	CommandCounterIncrement();
+}
+
+/*
+ * Set the ACL of a table or column in a catalog tuple, and record the roles
+ * in it as dependencies.
+ */
+static void
+catalog_tuple_set_acl(Relation rel, HeapTuple tuple, AttrNumber acl_attnum, Acl *acl,
+					  Oid relid, int32 attnum, Oid ownerid)
+{
+	TupleDesc	desc = RelationGetDescr(rel);
+	Datum	   *values = palloc0(sizeof(Datum) * desc->natts);
+	bool	   *nulls = palloc0(sizeof(bool) * desc->natts);
+	bool	   *replace = palloc0(sizeof(bool) * desc->natts);
+	Datum		old_acl;
+	bool		isnull;
+	Oid		   *old_members = NULL;
+	Oid		   *new_members;
+	int			num_old_members = 0;
+	int			num_new_members;
+	HeapTuple	newtuple;
+
+	/* The table can have default privileges */
+	old_acl = heap_getattr(tuple, acl_attnum, desc, &isnull);
+
+	if (!isnull)
+		num_old_members = aclmembers(DatumGetAclP(old_acl), &old_members);
+
+	num_new_members = aclmembers(acl, &new_members);
+
+	values[AttrNumberGetAttrOffset(acl_attnum)] = PointerGetDatum(acl);
+	replace[AttrNumberGetAttrOffset(acl_attnum)] = true;
+	newtuple = heap_modify_tuple(tuple, desc, values, nulls, replace);
+	CatalogTupleUpdate(rel, &newtuple->t_self, newtuple);
+	heap_freetuple(newtuple);
+
+	updateAclDependencies(RelationRelationId, relid, attnum, ownerid,
+						  num_old_members, old_members,
+						  num_new_members, new_members);
+}
+
+/*
+ * Give the table that replaces a chunk's table the privileges of the chunk's
+ * table, including those on columns.
+ */
+static void
+chunk_table_copy_privileges(Oid from_relid, Oid to_relid)
+{
+	Relation	rel = heap_open(RelationRelationId, RowExclusiveLock);
+	HeapTuple	from_tuple = SearchSysCache1(RELOID, ObjectIdGetDatum(from_relid));
+	HeapTuple	to_tuple;
+	Oid			ownerid;
+	Datum		acl;
+	bool		isnull;
+	AttrNumber	attno;
+	int			natts = get_relnatts(to_relid);
+
+	if (!HeapTupleIsValid(from_tuple))
+		elog(ERROR, "cache lookup failed for relation %u", from_relid);
+
+	ownerid = ((Form_pg_class) GETSTRUCT(from_tuple))->relowner;
+	acl = SysCacheGetAttr(RELOID, from_tuple, Anum_pg_class_relacl, &isnull);
+
+	if (!isnull)
+	{
+		to_tuple = SearchSysCache1(RELOID, ObjectIdGetDatum(to_relid));
+
+		if (!HeapTupleIsValid(to_tuple))
+			elog(ERROR, "cache lookup failed for relation %u", to_relid);
+
+		catalog_tuple_set_acl(rel, to_tuple, Anum_pg_class_relacl, DatumGetAclPCopy(acl),
+							  to_relid, 0, ownerid);
+		ReleaseSysCache(to_tuple);
+	}
+
+	ReleaseSysCache(from_tuple);
+	heap_close(rel, RowExclusiveLock);
+
+	rel = heap_open(AttributeRelationId, RowExclusiveLock);
+
+	for (attno = 1; attno <= natts; attno++)
+	{
+		Form_pg_attribute attr;
+
+		to_tuple = SearchSysCache2(ATTNUM, ObjectIdGetDatum(to_relid), Int16GetDatum(attno));
+
+		if (!HeapTupleIsValid(to_tuple))
+			elog(ERROR, "cache lookup failed for attribute %d of relation %u", attno, to_relid);
+
+		attr = (Form_pg_attribute) GETSTRUCT(to_tuple);
+		from_tuple = attr->attisdropped ? NULL : SearchSysCacheAttName(from_relid, NameStr(attr->attname));
+
+		if (HeapTupleIsValid(from_tuple))
+		{
+			acl = SysCacheGetAttr(ATTNAME, from_tuple, Anum_pg_attribute_attacl, &isnull);
+
+			if (!isnull)
+				catalog_tuple_set_acl(rel, to_tuple, Anum_pg_attribute_attacl, DatumGetAclPCopy(acl),
+									  to_relid, attno, ownerid);
+
+			ReleaseSysCache(from_tuple);
+		}
+
+		ReleaseSysCache(to_tuple);
+	}
+
+	heap_close(rel, RowExclusiveLock);
+
+	CommandCounterIncrement();
+}
+
+/*
+ * Rewrite a chunk to the physical layout of its hypertable.
+ *
+ * The chunk's table is replaced by a table that is created with the
+ * hypertable's layout, including its dropped columns. The rows and privileges
+ * of the chunk's table are copied to the new table, which is then made a child
+ * of the hypertable and given the chunk's name, constraints, triggers and
+ * indexes. The chunk's metadata is kept, except for its indexes, which are
+ * recreated. Other objects that depend on the chunk's table, like indexes that
+ * were created directly on the chunk, are dropped with it.
+ *
+ * The chunk's relation is closed, keeping its lock, since it cannot be dropped
+ * while open.
+ */
+static void
+chunk_rewrite_layout(Hypertable *ht, Chunk *chunk, Relation htrel, Relation chunkrel)
+{
+	Oid			old_relid = RelationGetRelid(chunkrel);
+	Oid			new_relid;
+	ObjectAddress objaddr;
+	char	   *relname;
+
+	relname = ChooseRelationName(NameStr(chunk->fd.table_name), NULL, "layout",
+								 RelationGetNamespace(chunkrel));
+	new_relid = chunk_create_table_with_layout(chunk, htrel, chunkrel, relname);
+
+	chunk_table_copy_rows(old_relid, new_relid, RelationGetDescr(htrel));
+	chunk_table_inherit(ht, new_relid);
+	chunk_table_copy_privileges(old_relid, new_relid);
+	heap_close(chunkrel, NoLock);
+
+	/* Drop the old table, keeping the chunk's metadata */
+	ts_chunk_index_delete_by_chunk_id(chunk->fd.id, false);
+	ObjectAddressSet(objaddr, RelationRelationId, old_relid);
+	performDeletion(&objaddr, DROP_RESTRICT, PERFORM_DELETION_INTERNAL);
+
+	RenameRelationInternal(new_relid, NameStr(chunk->fd.table_name), true);
+	CommandCounterIncrement();
+
+	chunk->table_id = new_relid;
+
+	ts_chunk_constraints_create_on_table(chunk->constraints,
+										 chunk->table_id,
+										 chunk->fd.id,
+										 ht->main_table_relid,
+										 chunk->fd.hypertable_id);
+
+	ts_trigger_create_all_on_chunk(ht, chunk);
+
+	ts_chunk_index_create_all(chunk->fd.hypertable_id,
+							  ht->main_table_relid,
+							  chunk->fd.id,
+							  chunk->table_id);
+
+	/* Cached chunks refer to the old table */
+	ts_shared_chunk_cache_remove(chunk->fd.id);
+	CacheInvalidateRelcacheByRelid(ht->main_table_relid);
+}
+
 static Chunk *
 chunk_create_after_lock(Hypertable *ht, Point *p, const char *schema, const char *prefix)
 {
@@ -650,20 +1115,43 @@ Chunk *
 ts_chunk_create(Hypertable *ht, Point *p, const char *schema, const char *prefix)
 {
 	Chunk	   *chunk;
+	LOCKTAG		tag;
+	LockAcquireResult res;
 
 	/*
 	 * Serialize chunk creation around a lock on the "main table" to avoid
 	 * multiple processes trying to create the same chunk. We use a
 	 * ShareUpdateExclusiveLock, which is the weakest lock possible that
-	 * conflicts with itself. The lock needs to be held until transaction end.
+	 * conflicts with itself. This is also the lock PostgreSQL takes on the
+	 * parent when the chunk table is added as an inheritance child, so it
+	 * needs to be held until transaction end once a chunk is created.
+	 *
+	 * This is LockRelationOid() with the result exposed so that we know
+	 * whether we took the lock or already held it.
 	 */
-	LockRelationOid(ht->main_table_relid, ShareUpdateExclusiveLock);
+	SET_LOCKTAG_RELATION(tag, MyDatabaseId, ht->main_table_relid);
+	res = LockAcquire(&tag, ShareUpdateExclusiveLock, false, false);
+
+	if (res != LOCKACQUIRE_ALREADY_HELD)
+		AcceptInvalidationMessages();
 
 	/* Recheck if someone else created the chunk before we got the table lock */
 	chunk = ts_chunk_find(ht->space, p);
 
 	if (NULL == chunk)
 		chunk = chunk_create_after_lock(ht, p, schema, prefix);
+	else if (res != LOCKACQUIRE_ALREADY_HELD)
+	{
+		/*
+		 * Another backend created the chunk while we waited for the lock.
+		 * Since we did not change anything, release the lock right away
+		 * instead of holding it until commit. Otherwise, all backends that
+		 * waited for the same chunk would hold the lock in turn and
+		 * serialize chunk creation in other partitions behind each of
+		 * their transactions.
+		 */
+		LockRelease(&tag, ShareUpdateExclusiveLock, false);
+	}
 
 	Assert(chunk != NULL);
 
@@ -785,18 +1273,13 @@ chunk_scan_ctx_destroy(ChunkScanCtx *ctx)
 }
 
 static inline void
-dimension_slice_and_chunk_constraint_join(ChunkScanCtx *scanctx, DimensionVec *vec)
+dimension_slice_and_chunk_constraint_join(ChunkScanCtx *scanctx, List *dimension_vecs)
 {
-	int			i;
-
-	for (i = 0; i < vec->num_slices; i++)
-	{
-		/*
-		 * For each dimension slice, find matching constraints. These will be
-		 * saved in the scan context
-		 */
-		ts_chunk_constraint_scan_by_dimension_slice(vec->slices[i], scanctx, CurrentMemoryContext);
-	}
+	/*
+	 * Find the constraints matching the dimension slices of all dimensions.
+	 * These will be saved in the scan context
+	 */
+	ts_chunk_constraint_scan_by_dimension_slices(dimension_vecs, scanctx, CurrentMemoryContext);
 }
 
 /*
@@ -813,6 +1296,7 @@ dimension_slice_and_chunk_constraint_join(ChunkScanCtx *scanctx, DimensionVec *v
 static void
 chunk_point_scan(ChunkScanCtx *scanctx, Point *p)
 {
+	List	   *dimension_vecs = NIL;
 	int			i;
 
 	/* Scan all dimensions for slices enclosing the point */
@@ -820,11 +1304,14 @@ chunk_point_scan(ChunkScanCtx *scanctx, Point *p)
 	{
 		DimensionVec *vec;
 
-		vec = dimension_slice_scan(scanctx->space->dimensions[i].fd.id,
-								   p->coordinates[i]);
+		vec = ts_dimension_slice_index_scan_limit(&scanctx->space->dimensions[i],
+												  p->coordinates[i],
+												  0);
 
-		dimension_slice_and_chunk_constraint_join(scanctx, vec);
+		dimension_vecs = lappend(dimension_vecs, vec);
 	}
+
+	dimension_slice_and_chunk_constraint_join(scanctx, dimension_vecs);
 }
 
 /*
@@ -845,6 +1332,7 @@ chunk_point_scan(ChunkScanCtx *scanctx, Point *p)
 static void
 chunk_collision_scan(ChunkScanCtx *scanctx, Hypercube *cube)
 {
+	List	   *dimension_vecs = NIL;
 	int			i;
 
 	/* Scan all dimensions for colliding slices */
@@ -852,14 +1340,23 @@ chunk_collision_scan(ChunkScanCtx *scanctx, Hypercube *cube)
 	{
 		DimensionVec *vec;
 		DimensionSlice *slice = cube->slices[i];
+		Dimension  *dim = ts_hyperspace_get_dimension_by_id(scanctx->space, slice->fd.dimension_id);
 
-		vec = dimension_slice_collision_scan(slice->fd.dimension_id,
-											 slice->fd.range_start,
-											 slice->fd.range_end);
+		if (NULL != dim)
+			vec = ts_dimension_slice_index_collision_scan_limit(dim,
+																slice->fd.range_start,
+																slice->fd.range_end,
+																0);
+		else
+			vec = dimension_slice_collision_scan(slice->fd.dimension_id,
+												 slice->fd.range_start,
+												 slice->fd.range_end);
 
-		/* Add the slices to all the chunks they are associated with */
-		dimension_slice_and_chunk_constraint_join(scanctx, vec);
+		dimension_vecs = lappend(dimension_vecs, vec);
 	}
+
+	/* Add the slices to all the chunks they are associated with */
+	dimension_slice_and_chunk_constraint_join(scanctx, dimension_vecs);
 }
 
 /*
@@ -1053,12 +1550,12 @@ chunks_find_all_in_range_limit(Hyperspace *hs,
 	/* must have been checked earlier that this is the case */
 	Assert(time_dim != NULL);
 
-	slices = ts_dimension_slice_scan_range_limit(time_dim->fd.id,
-												 start_strategy,
-												 start_value,
-												 end_strategy,
-												 end_value,
-												 limit);
+	slices = ts_dimension_slice_index_scan_range_limit(time_dim,
+													   start_strategy,
+													   start_value,
+													   end_strategy,
+													   end_value,
+													   limit);
 
 	/* The scan context will keep the state accumulated during the scan */
 	chunk_scan_ctx_init(ctx, hs, NULL);
@@ -1067,7 +1564,7 @@ chunks_find_all_in_range_limit(Hyperspace *hs,
 	ctx->early_abort = false;
 
 	/* Scan for chunks that are in range */
-	dimension_slice_and_chunk_constraint_join(ctx, slices);
+	dimension_slice_and_chunk_constraint_join(ctx, list_make1(slices));
 
 	*num_found += hash_get_num_entries(ctx->htab);
 	return ctx;
@@ -1164,7 +1661,6 @@ ts_chunk_find_all_oids(Hyperspace *hs, List *dimension_vecs, LOCKMODE lockmode)
 {
 	List	   *oid_list = NIL;
 	ChunkScanCtx ctx;
-	ListCell   *lc;
 
 	/* The scan context will keep the state accumulated during the scan */
 	chunk_scan_ctx_init(&ctx, hs, NULL);
@@ -1173,13 +1669,8 @@ ts_chunk_find_all_oids(Hyperspace *hs, List *dimension_vecs, LOCKMODE lockmode)
 	ctx.early_abort = false;
 	ctx.lockmode = lockmode;
 
-	/* Scan all dimensions for slices enclosing the point */
-	foreach(lc, dimension_vecs)
-	{
-		DimensionVec *vec = lfirst(lc);
-
-		dimension_slice_and_chunk_constraint_join(&ctx, vec);
-	}
+	/* Scan for the chunks of the slices in all dimensions */
+	dimension_slice_and_chunk_constraint_join(&ctx, dimension_vecs);
 
 	ctx.data = NIL;
 	chunk_scan_ctx_foreach_chunk(&ctx, append_chunk_oid, 0);
@@ -1596,6 +2087,7 @@ chunk_tuple_delete(TupleInfo *ti, void *data)
 
 	ts_chunk_constraint_delete_by_chunk_id(form->id, ccs);
 	ts_chunk_index_delete_by_chunk_id(form->id, true);
+	ts_shared_chunk_cache_remove(form->id);
 
 	/* Check for dimension slices that are orphaned by the chunk deletion */
 	for (i = 0; i < ccs->num_constraints; i++)
@@ -1678,7 +2170,6 @@ ts_chunk_recreate_all_constraints_for_dimension(Hyperspace *hs, int32 dimension_
 {
 	DimensionVec *slices;
 	ChunkScanCtx chunkctx;
-	int			i;
 
 	slices = ts_dimension_slice_scan_by_dimension(dimension_id, 0);
 
@@ -1686,9 +2177,7 @@ ts_chunk_recreate_all_constraints_for_dimension(Hyperspace *hs, int32 dimension_
 		return;
 
 	chunk_scan_ctx_init(&chunkctx, hs, NULL);
-
-	for (i = 0; i < slices->num_slices; i++)
-		ts_chunk_constraint_scan_by_dimension_slice(slices->slices[i], &chunkctx, CurrentMemoryContext);
+	dimension_slice_and_chunk_constraint_join(&chunkctx, list_make1(slices));
 
 	chunk_scan_ctx_foreach_chunk(&chunkctx, chunk_recreate_constraint, 0);
 	chunk_scan_ctx_destroy(&chunkctx);
@@ -1910,3 +2399,56 @@ ts_chunk_drop_chunks(PG_FUNCTION_ARGS)
 
 	PG_RETURN_NULL();
 }
+
+/*
+ * Rewrite a chunk to the physical layout of its hypertable, if it has a
+ * different layout.
+ *
+ * A chunk that was created after a column was dropped from the hypertable
+ * lacks the dropped column, so tuples inserted into the hypertable have to be
+ * converted to the chunk's rowtype. Once the chunk is rewritten, tuples are
+ * inserted without conversion.
+ *
+ * Returns true if the chunk was rewritten.
+ */
+Datum
+ts_chunk_repair_layout(PG_FUNCTION_ARGS)
+{
+	Oid			chunk_relid = PG_GETARG_OID(0);
+	Chunk	   *chunk = ts_chunk_get_by_relid(chunk_relid, 0, false);
+	Cache	   *hcache;
+	Hypertable *ht;
+	Relation	htrel;
+	Relation	chunkrel;
+	bool		rewrite;
+
+	if (NULL == chunk)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("\"%s\" is not a chunk", get_rel_name(chunk_relid))));
+
+	hcache = ts_hypertable_cache_pin();
+	ht = ts_hypertable_cache_get_entry_by_id(hcache, chunk->fd.hypertable_id);
+	ts_hypertable_permissions_check(ht->main_table_relid, GetUserId());
+
+	/*
+	 * Lock the hypertable like chunk creation does and block all access to
+	 * the chunk. The chunk's constraints are read after it is locked.
+	 */
+	htrel = heap_open(ht->main_table_relid, ShareUpdateExclusiveLock);
+	chunkrel = heap_open(chunk_relid, AccessExclusiveLock);
+	chunk = ts_chunk_get_by_relid(chunk_relid, ht->space->num_dimensions, true);
+
+	rewrite = NULL != ts_chunk_insert_state_tuple_conversion_map(RelationGetDescr(htrel),
+																 RelationGetDescr(chunkrel));
+
+	if (rewrite)
+		chunk_rewrite_layout(ht, chunk, htrel, chunkrel);
+	else
+		heap_close(chunkrel, NoLock);
+
+	heap_close(htrel, NoLock);
+	ts_cache_release(hcache);
+
+	PG_RETURN_BOOL(rewrite);
+}
@@ -8,6 +8,7 @@
 #include <utils/hsearch.h>
 #include <utils/relcache.h>
 #include <utils/rel.h>
+#include <utils/array.h>
 #include <utils/builtins.h>
 #include <utils/lsyscache.h>
 #include <utils/syscache.h>
@@ -16,6 +17,7 @@
 #include <catalog/indexing.h>
 #include <catalog/pg_constraint.h>
 #include <catalog/pg_constraint_fn.h>
+#include <catalog/pg_type.h>
 #include <catalog/objectaddress.h>
 #include <commands/tablecmds.h>
 #include <catalog/dependency.h>
@@ -185,16 +187,25 @@ chunk_constraints_insert(ChunkConstraints *ccs)
 {
 	Catalog    *catalog = ts_catalog_get();
 	CatalogSecurityContext sec_ctx;
+	CatalogMultiInsertState state;
 	Relation	rel;
 	int			i;
 
 	rel = heap_open(catalog_get_table_id(catalog, CHUNK_CONSTRAINT), RowExclusiveLock);
 
 	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+	ts_catalog_multi_insert_begin(&state, rel);
 
 	for (i = 0; i < ccs->num_constraints; i++)
-		chunk_constraint_insert_relation(rel, &ccs->constraints[i]);
+	{
+		Datum		values[Natts_chunk_constraint];
+		bool		nulls[Natts_chunk_constraint] = {false};
+
+		chunk_constraint_fill_tuple_values(&ccs->constraints[i], values, nulls);
+		ts_catalog_multi_insert_values(&state, values, nulls);
+	}
 
+	ts_catalog_multi_insert_end(&state);
 	ts_catalog_restore_user(&sec_ctx);
 	heap_close(rel, RowExclusiveLock);
 }
@@ -335,9 +346,22 @@ ts_chunk_constraints_create(ChunkConstraints *ccs,
 							Oid hypertable_oid,
 							int32 hypertable_id)
 {
-	int			i;
-
 	chunk_constraints_insert(ccs);
+	ts_chunk_constraints_create_on_table(ccs, chunk_oid, chunk_id, hypertable_oid, hypertable_id);
+}
+
+/*
+ * Create a set of constraints that are already in the catalog on a chunk
+ * table, e.g., when the chunk's table is recreated.
+ */
+void
+ts_chunk_constraints_create_on_table(ChunkConstraints *ccs,
+									 Oid chunk_oid,
+									 int32 chunk_id,
+									 Oid hypertable_oid,
+									 int32 hypertable_id)
+{
+	int			i;
 
 	for (i = 0; i < ccs->num_constraints; i++)
 		chunk_constraint_create(&ccs->constraints[i],
@@ -483,10 +507,18 @@ ts_chunk_constraint_scan_by_chunk_id(int32 chunk_id, Size num_constraints_hint,
 	return constraints;
 }
 
+typedef struct DimensionSliceEntry
+{
+	int32		dimension_slice_id;
+	DimensionSlice *slice;
+} DimensionSliceEntry;
+
 typedef struct ChunkConstraintScanData
 {
 	ChunkScanCtx *scanctx;
 	DimensionSlice *slice;
+	/* Slices to match in a batch scan, keyed on slice ID */
+	HTAB	   *slices;
 } ChunkConstraintScanData;
 
 static ScanTupleResult
@@ -533,12 +565,12 @@ scan_by_dimension_slice_id(int32 dimension_slice_id,
 	ScanKeyData scankey[1];
 
 	ScanKeyInit(&scankey[0],
-				Anum_chunk_constraint_chunk_id_dimension_slice_id_idx_dimension_slice_id,
+				Anum_chunk_constraint_dimension_slice_id_idx_dimension_slice_id,
 				BTEqualStrategyNumber,
 				F_INT4EQ,
 				Int32GetDatum(dimension_slice_id));
 
-	return chunk_constraint_scan_internal(CHUNK_CONSTRAINT_CHUNK_ID_DIMENSION_SLICE_ID_IDX,
+	return chunk_constraint_scan_internal(CHUNK_CONSTRAINT_DIMENSION_SLICE_ID_IDX,
 										  scankey,
 										  1,
 										  tuple_found,
@@ -566,6 +598,124 @@ ts_chunk_constraint_scan_by_dimension_slice(DimensionSlice *slice, ChunkScanCtx
 									  mctx);
 }
 
+/*
+ * Scan filter function that sets the slice of a constraint found in a batch
+ * scan in the scan data.
+ */
+static ScanFilterResult
+chunk_constraint_for_dimension_slices(TupleInfo *ti, void *data)
+{
+	ChunkConstraintScanData *ccsd = data;
+	DimensionSliceEntry *entry;
+	bool		isnull;
+	int32		dimension_slice_id;
+
+	dimension_slice_id = DatumGetInt32(heap_getattr(ti->tuple,
+													Anum_chunk_constraint_dimension_slice_id,
+													ti->desc,
+													&isnull));
+
+	if (isnull)
+		return SCAN_EXCLUDE;
+
+	entry = hash_search(ccsd->slices, &dimension_slice_id, HASH_FIND, NULL);
+
+	if (NULL == entry)
+		return SCAN_EXCLUDE;
+
+	ccsd->slice = entry->slice;
+
+	return SCAN_INCLUDE;
+}
+
+/*
+ * Scan for all chunk constraints that match any of the slices in the given
+ * list of dimension vectors. The chunk constraints are saved in the chunk scan
+ * context.
+ *
+ * All slices are probed in a single scan of the dimension_slice_id index,
+ * using an array of slice IDs as scan key. The index sorts the IDs and
+ * visits them in order, so each index page is read at most once.
+ */
+int
+ts_chunk_constraint_scan_by_dimension_slices(List *dimension_vecs, ChunkScanCtx *ctx, MemoryContext mctx)
+{
+	HASHCTL		hctl = {
+		.keysize = sizeof(int32),
+		.entrysize = sizeof(DimensionSliceEntry),
+		.hcxt = CurrentMemoryContext,
+	};
+	ChunkConstraintScanData data = {
+		.scanctx = ctx,
+	};
+	ScanKeyData scankey[1];
+	ListCell   *lc;
+	Datum	   *slice_ids;
+	int			num_slices = 0;
+	int			num_slice_ids = 0;
+	int			num_found;
+	int			i;
+
+	foreach(lc, dimension_vecs)
+		num_slices += ((DimensionVec *) lfirst(lc))->num_slices;
+
+	if (num_slices == 0)
+		return 0;
+
+	data.slices = hash_create("chunk-constraint-slice-batch",
+							  num_slices,
+							  &hctl,
+							  HASH_ELEM | HASH_CONTEXT | HASH_BLOBS);
+	slice_ids = palloc(sizeof(Datum) * num_slices);
+
+	foreach(lc, dimension_vecs)
+	{
+		DimensionVec *vec = lfirst(lc);
+
+		for (i = 0; i < vec->num_slices; i++)
+		{
+			DimensionSlice *slice = vec->slices[i];
+			DimensionSliceEntry *entry;
+			bool		found;
+
+			entry = hash_search(data.slices, &slice->fd.id, HASH_ENTER, &found);
+
+			if (!found)
+				slice_ids[num_slice_ids++] = Int32GetDatum(slice->fd.id);
+
+			entry->slice = slice;
+		}
+	}
+
+	ScanKeyEntryInitialize(&scankey[0],
+						   SK_SEARCHARRAY,
+						   Anum_chunk_constraint_dimension_slice_id_idx_dimension_slice_id,
+						   BTEqualStrategyNumber,
+						   InvalidOid,
+						   InvalidOid,
+						   F_INT4EQ,
+						   PointerGetDatum(construct_array(slice_ids,
+														   num_slice_ids,
+														   INT4OID,
+														   sizeof(int32),
+														   true,
+														   'i')));
+
+	num_found = chunk_constraint_scan_internal(CHUNK_CONSTRAINT_DIMENSION_SLICE_ID_IDX,
+											   scankey,
+											   1,
+											   chunk_constraint_dimension_slice_id_tuple_found,
+											   chunk_constraint_for_dimension_slices,
+											   &data,
+											   AccessShareLock,
+											   mctx);
+
+	hash_destroy(data.slices);
+	pfree(slice_ids);
+
+	return num_found;
+}
+
 /*
  * Scan for chunk constraints given a dimension slice ID.
  *
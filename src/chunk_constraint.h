@@ -44,10 +44,12 @@ extern ChunkConstraints *ts_chunk_constraints_alloc(int size_hint, MemoryContext
 extern ChunkConstraints *ts_chunk_constraint_scan_by_chunk_id(int32 chunk_id, Size count_hint, MemoryContext mctx);
 extern ChunkConstraints *ts_chunk_constraints_copy(ChunkConstraints *constraints);
 extern int	ts_chunk_constraint_scan_by_dimension_slice(DimensionSlice *slice, ChunkScanCtx *ctx, MemoryContext mctx);
+extern int	ts_chunk_constraint_scan_by_dimension_slices(List *dimension_vecs, ChunkScanCtx *ctx, MemoryContext mctx);
 extern int	ts_chunk_constraint_scan_by_dimension_slice_id(int32 dimension_slice_id, ChunkConstraints *ccs, MemoryContext mctx);
 extern int	ts_chunk_constraints_add_dimension_constraints(ChunkConstraints *ccs, int32 chunk_id, Hypercube *cube);
 extern int	ts_chunk_constraints_add_inheritable_constraints(ChunkConstraints *ccs, int32 chunk_id, Oid hypertable_oid);
 extern void ts_chunk_constraints_create(ChunkConstraints *ccs, Oid chunk_oid, int32 chunk_id, Oid hypertable_oid, int32 hypertable_id);
+extern void ts_chunk_constraints_create_on_table(ChunkConstraints *ccs, Oid chunk_oid, int32 chunk_id, Oid hypertable_oid, int32 hypertable_id);
 extern void ts_chunk_constraint_create_on_chunk(Chunk *chunk, Oid constraint_oid);
 extern int	ts_chunk_constraint_delete_by_hypertable_constraint_name(int32 chunk_id, char *hypertable_constraint_name, bool delete_metadata, bool drop_constraint);
 extern int	ts_chunk_constraint_delete_by_chunk_id(int32 chunk_id, ChunkConstraints *ccs);
@@ -5,6 +5,7 @@
  * see LICENSE-APACHE at the top level directory.
  */
 #include <postgres.h>
+#include <miscadmin.h>
 #include <nodes/extensible.h>
 #include <nodes/makefuncs.h>
 #include <nodes/nodeFuncs.h>
@@ -13,8 +14,10 @@
 
 #include "chunk_dispatch.h"
 #include "chunk_insert_state.h"
+#include "chunk_index.h"
 #include "subspace_store.h"
 #include "dimension.h"
+#include "hypercube.h"
 #include "guc.h"
 
 ChunkDispatch *
@@ -30,19 +33,130 @@ ts_chunk_dispatch_create(Hypertable *ht, EState *estate)
 	cd->cmd_type = CMD_INSERT;
 	cd->cache = ts_subspace_store_init(ht->space, estate->es_query_cxt, ts_guc_max_open_chunks_per_insert);
 
+	/* Also bound the memory of open chunks, by default to work_mem */
+	if (ts_guc_max_open_chunks_memory != 0)
+		ts_subspace_store_set_max_size(cd->cache,
+									   (ts_guc_max_open_chunks_memory < 0 ?
+										work_mem : ts_guc_max_open_chunks_memory) * 1024L);
+	cd->bulk_load = ts_chunk_index_bulk_load_begin(false);
+	cd->last_point = ts_last_point_state_create(ht, estate->es_query_cxt);
+
 	return cd;
 }
 
 void
 ts_chunk_dispatch_destroy(ChunkDispatch *cd)
 {
+	const SubspaceStoreStats *stats = ts_subspace_store_stats(cd->cache);
+
+	elog(DEBUG1, "[chunk dispatch] hypertable \"%s\": " INT64_FORMAT " memo hits, "
+		 INT64_FORMAT " memo misses, " INT64_FORMAT " chunk opens, "
+		 INT64_FORMAT " evictions, " INT64_FORMAT " re-opens",
+		 NameStr(cd->hypertable->fd.table_name), cd->memo_hits, cd->memo_misses,
+		 stats->additions, stats->evictions, stats->readditions);
+
 	ts_subspace_store_free(cd->cache);
+
+	if (NULL != cd->last_point)
+		ts_last_point_state_flush(cd->last_point);
+
+	/* Chunk indexes are closed now, so deferred builds can run */
+	if (cd->bulk_load)
+		ts_chunk_index_bulk_load_end();
 }
 
 static void
-destroy_chunk_insert_state(void *cis)
+chunk_dispatch_memo_remove(ChunkDispatch *dispatch, ChunkInsertState *cis)
 {
-	ts_chunk_insert_state_destroy((ChunkInsertState *) cis);
+	int			i;
+
+	for (i = 0; i < CHUNK_DISPATCH_MEMO_SIZE; i++)
+	{
+		if (dispatch->memo[i] == cis)
+		{
+			memmove(&dispatch->memo[i], &dispatch->memo[i + 1],
+					sizeof(ChunkInsertState *) * (CHUNK_DISPATCH_MEMO_SIZE - i - 1));
+			dispatch->memo[CHUNK_DISPATCH_MEMO_SIZE - 1] = NULL;
+			return;
+		}
+	}
+}
+
+static void
+destroy_chunk_insert_state(void *cisptr)
+{
+	ChunkInsertState *cis = cisptr;
+	ChunkDispatch *dispatch = cis->dispatch;
+
+	chunk_dispatch_memo_remove(dispatch, cis);
+
+	/* The store is freeing the entry, so stop accounting memory to it */
+	cis->store_entry = NULL;
+
+	if (NULL != dispatch->on_chunk_insert_state_close)
+		dispatch->on_chunk_insert_state_close(cis, dispatch->on_chunk_insert_state_close_data);
+
+	ts_chunk_insert_state_destroy(cis);
+}
+
+static inline bool
+point_in_hypercube(const Hypercube *cube, const Point *point)
+{
+	int			i;
+
+	for (i = 0; i < cube->num_slices; i++)
+	{
+		const DimensionSlice *slice = cube->slices[i];
+
+		if (point->coordinates[i] < slice->fd.range_start ||
+			point->coordinates[i] >= slice->fd.range_end)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Check the recently used chunk insert states for one that matches the
+ * point. On a hit, the insert state is moved to the front of the memo.
+ */
+static inline ChunkInsertState *
+chunk_dispatch_memo_get(ChunkDispatch *dispatch, Point *point)
+{
+	int			i;
+
+	for (i = 0; i < CHUNK_DISPATCH_MEMO_SIZE && dispatch->memo[i] != NULL; i++)
+	{
+		ChunkInsertState *cis = dispatch->memo[i];
+
+		if (point_in_hypercube(cis->cube, point))
+		{
+			/*
+			 * The first insert state is always the most recently used one in
+			 * the subspace store as well, so only other hits need to update
+			 * the store's recency to keep its evictions in LRU order
+			 */
+			if (i > 0)
+			{
+				memmove(&dispatch->memo[1], &dispatch->memo[0], sizeof(ChunkInsertState *) * i);
+				dispatch->memo[0] = cis;
+				ts_subspace_store_touch(dispatch->cache, cis->store_entry);
+			}
+			dispatch->memo_hits++;
+			return cis;
+		}
+	}
+
+	dispatch->memo_misses++;
+	return NULL;
+}
+
+static inline void
+chunk_dispatch_memo_add(ChunkDispatch *dispatch, ChunkInsertState *cis)
+{
+	memmove(&dispatch->memo[1], &dispatch->memo[0],
+			sizeof(ChunkInsertState *) * (CHUNK_DISPATCH_MEMO_SIZE - 1));
+	dispatch->memo[0] = cis;
 }
 
 /*
@@ -54,6 +168,11 @@ ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *point)
 {
 	ChunkInsertState *cis;
 
+	cis = chunk_dispatch_memo_get(dispatch, point);
+
+	if (NULL != cis)
+		return cis;
+
 	cis = ts_subspace_store_get(dispatch->cache, point);
 
 	if (NULL == cis)
@@ -66,9 +185,16 @@ ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *point)
 			elog(ERROR, "no chunk found or created");
 
 		cis = ts_chunk_insert_state_create(new_chunk, dispatch);
-		ts_subspace_store_add(dispatch->cache, new_chunk->cube, cis, destroy_chunk_insert_state);
+		cis->store_entry = ts_subspace_store_add(dispatch->cache, new_chunk->cube, cis,
+												 cis->memory_size,
+												 destroy_chunk_insert_state);
+
+		if (NULL != dispatch->last_point)
+			ts_last_point_add_chunk(dispatch->last_point, new_chunk->table_id);
 	}
 
 	Assert(cis != NULL);
+	chunk_dispatch_memo_add(dispatch, cis);
+
 	return cis;
 }
@@ -15,18 +15,37 @@
 #include "cache.h"
 #include "subspace_store.h"
 #include "chunk_dispatch_state.h"
+#include "last_point.h"
 
 /*
  * ChunkDispatch keeps cached state needed to dispatch tuples to chunks. It is
  * separate from any plan and executor nodes, since it is used both for INSERT
  * and COPY.
 */
+typedef struct ChunkInsertState ChunkInsertState;
+
+/*
+ * Number of recently used chunk insert states to remember for fast lookups.
+ */
+#define CHUNK_DISPATCH_MEMO_SIZE 4
+
+typedef void (*on_chunk_insert_state_close_func) (ChunkInsertState *cis, void *data);
+
 typedef struct ChunkDispatch
 {
 	Hypertable *hypertable;
 	SubspaceStore *cache;
 	EState	   *estate;
 
+	/*
+	 * Most recently used chunk insert states, most recent first. Tuples
+	 * typically arrive in time order, so this avoids a lookup in the
+	 * subspace store for most tuples.
+	 */
+	ChunkInsertState *memo[CHUNK_DISPATCH_MEMO_SIZE];
+	int64		memo_hits;
+	int64		memo_misses;
+
 	/*
 	 * Keep a pointer to the original (hypertable's) ResultRelInfo since we
 	 * will reset the pointer in EState as we lookup new chunks.
@@ -40,10 +59,28 @@ typedef struct ChunkDispatch
 	List	   *on_conflict_where;
 	CmdType		cmd_type;
 
+	/*
+	 * Optional callback invoked before a chunk insert state is closed, e.g.,
+	 * when it is evicted from the cache. COPY uses this to flush any tuples
+	 * buffered for the chunk.
+	 */
+	on_chunk_insert_state_close_func on_chunk_insert_state_close;
+	void	   *on_chunk_insert_state_close_data;
+
+	/* Tracks the latest row per series, if the hypertable has a last-point table */
+	LastPointState *last_point;
+
+	/* Index builds of chunks created by this dispatch are deferred */
+	bool		bulk_load;
+
+	/*
+	 * COPY FREEZE: write frozen tuples to chunks created or truncated in the
+	 * current subtransaction
+	 */
+	bool		freeze;
 } ChunkDispatch;
 
 typedef struct Point Point;
-typedef struct ChunkInsertState ChunkInsertState;
 
 extern ChunkDispatch *ts_chunk_dispatch_create(Hypertable *ht, EState *estate);
 void		ts_chunk_dispatch_destroy(ChunkDispatch *dispatch);
@@ -5,10 +5,13 @@
  * see LICENSE-APACHE at the top level directory.
  */
 #include <postgres.h>
+#include <miscadmin.h>
 #include <utils/lsyscache.h>
 #include <utils/rel.h>
 #include <catalog/pg_class.h>
 #include <nodes/extensible.h>
+#include <utils/memutils.h>
+#include <commands/explain.h>
 
 #include "chunk_dispatch_state.h"
 #include "chunk_dispatch_plan.h"
@@ -19,6 +22,24 @@
 #include "hypertable_cache.h"
 #include "dimension.h"
 #include "hypertable.h"
+#include "guc.h"
+#include "subspace_store.h"
+
+/* Initial number of entries allocated for a batch, grown as needed */
+#define CHUNK_DISPATCH_BATCH_INITIAL_SIZE 1024
+
+/*
+ * An entry in a batch of tuples read from the subplan. Tuples are sorted on
+ * the chunk they route to, while the sequence number keeps the original order
+ * of tuples within a chunk.
+ */
+struct ChunkDispatchBatchEntry
+{
+	Oid			chunk_relid;
+	int			seqno;
+	HeapTuple	tuple;
+	Point	   *point;
+};
 
 static void
 chunk_dispatch_begin(CustomScanState *node, EState *estate, int eflags)
@@ -40,9 +61,250 @@ chunk_dispatch_begin(CustomScanState *node, EState *estate, int eflags)
 	ps = ExecInitNode(state->subplan, estate, eflags);
 	state->hypertable_cache = hypertable_cache;
 	state->dispatch = ts_chunk_dispatch_create(ht, estate);
+	state->batch_size = ts_guc_insert_batch_size;
+
+	/*
+	 * When grouping rows by chunk, the batch is bounded by work_mem and,
+	 * optionally, by the configured batch size
+	 */
+	if (ts_guc_group_rows_by_chunk)
+	{
+		if (state->batch_size == 0)
+			state->batch_size = MaxAllocSize / sizeof(ChunkDispatchBatchEntry);
+		state->batch_max_bytes = work_mem * 1024L;
+	}
+
+	if (state->batch_size > 0)
+	{
+		state->batch_mctx = AllocSetContextCreate(estate->es_query_cxt,
+												  "ChunkDispatch batch",
+												  ALLOCSET_DEFAULT_SIZES);
+		state->batch_capacity = Min(state->batch_size, CHUNK_DISPATCH_BATCH_INITIAL_SIZE);
+		state->batch = MemoryContextAlloc(estate->es_query_cxt,
+										  sizeof(ChunkDispatchBatchEntry) * state->batch_capacity);
+		state->batch_slot = ExecInitExtraTupleSlot(estate);
+		ExecSetSlotDescriptor(state->batch_slot, ExecGetResultType(ps));
+	}
+
 	node->custom_ps = list_make1(ps);
 }
 
+/*
+ * Switch the executor state to the chunk matching a tuple's point.
+ *
+ * Finds (or creates) the insert state of the chunk matching the point and
+ * sets up the ON CONFLICT state of ModifyTable for the chunk. Tuples routed
+ * to the same chunk in a row only need this once.
+ */
+static ChunkInsertState *
+chunk_dispatch_switch_chunk(ChunkDispatchState *state, Point *point)
+{
+	ChunkInsertState *cis;
+	ChunkDispatch *dispatch = state->dispatch;
+	EState	   *estate = state->cscan_state.ss.ps.state;
+	MemoryContext old;
+
+	/* Switch to the executor's per-tuple memory context */
+	old = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+
+	/* Save the main table's (hypertable's) ResultRelInfo */
+	if (NULL == dispatch->hypertable_result_rel_info)
+		dispatch->hypertable_result_rel_info = estate->es_result_relation_info;
+
+	/*
+	 * Copy over the index to use in the returning list.
+	 */
+	dispatch->returning_index = state->parent->mt_whichplan;
+
+
+	/* Find or create the insert state matching the point */
+	cis = ts_chunk_dispatch_get_chunk_insert_state(dispatch, point);
+
+	/*
+	 * Update the arbiter indexes for ON CONFLICT statements so that they
+	 * match the chunk. Note that this requires updating the existing List
+	 * head (not replacing it), or otherwise the ModifyTableState node won't
+	 * pick it up.
+	 */
+	if (cis->arbiter_indexes != NIL)
+		state->parent->mt_arbiterindexes = cis->arbiter_indexes;
+
+	/* slot for the "existing" tuple in ON CONFLICT UPDATE IS chunk schema */
+	if (cis->tup_conv_map != NULL && state->parent->mt_existing != NULL)
+	{
+		TupleDesc	chunk_desc = cis->tup_conv_map->outdesc;
+
+		ExecSetSlotDescriptor(state->parent->mt_existing, chunk_desc);
+	}
+
+	MemoryContextSwitchTo(old);
+
+	return cis;
+}
+
+/*
+ * Route a tuple to the chunk the executor state was switched to.
+ *
+ * Sets the result relation in the executor state to the chunk, which makes
+ * sure that ModifyTable inserts the tuple into the chunk. This is needed for
+ * every tuple since ModifyTable restores the hypertable's ResultRelInfo
+ * whenever it returns a tuple (e.g., for RETURNING). Returns the slot to pass
+ * on to ModifyTable, which holds the tuple converted to the chunk's rowtype,
+ * if necessary.
+ *
+ * The slot is not materialized here, that is left to ModifyTable.
+ */
+static TupleTableSlot *
+chunk_dispatch_route_tuple(ChunkDispatchState *state, ChunkInsertState *cis,
+						   TupleTableSlot *slot)
+{
+	EState	   *estate = state->cscan_state.ss.ps.state;
+
+	estate->es_result_relation_info = cis->result_relation_info;
+
+	/* Convert the tuple to the chunk's rowtype, if necessary */
+	return ts_chunk_insert_state_convert_slot(cis, slot);
+}
+
+static int
+batch_entry_cmp(const void *left, const void *right)
+{
+	const ChunkDispatchBatchEntry *e1 = left;
+	const ChunkDispatchBatchEntry *e2 = right;
+
+	if (e1->chunk_relid != e2->chunk_relid)
+		return e1->chunk_relid < e2->chunk_relid ? -1 : 1;
+
+	return e1->seqno - e2->seqno;
+}
+
+/*
+ * Read the next batch of tuples from the subplan.
+ *
+ * Each tuple is copied into the batch memory context. The points of the
+ * tuples in the hyperspace are then calculated for the whole batch, one
+ * dimension at a time, and each tuple is tagged with the chunk it routes to.
+ * The batch is then sorted so that tuples are returned grouped by chunk while
+ * keeping their relative order within each chunk. Thus, inserts into the same
+ * chunk are still processed in the order given by the statement, which
+ * matters for, e.g., ON CONFLICT DO NOTHING.
+ *
+ * Tuples are tagged using the hypertable's chunk lookup rather than the
+ * chunk insert states, so that filling a batch that spans more chunks than
+ * open chunks are allowed does not open and evict chunks. Each chunk is
+ * opened once, when its run of tuples is returned.
+ */
+static void
+chunk_dispatch_batch_fill(ChunkDispatchState *state)
+{
+	PlanState  *substate = linitial(state->cscan_state.custom_ps);
+	ChunkDispatch *dispatch = state->dispatch;
+	EState	   *estate = state->cscan_state.ss.ps.state;
+	MemoryContext old;
+	Size		batch_bytes = 0;
+	HeapTuple  *tuples;
+	Point	  **points;
+	int			i;
+
+	MemoryContextReset(state->batch_mctx);
+	state->batch_num_tuples = 0;
+	state->batch_next = 0;
+
+	if (state->batch_subplan_done)
+		return;
+
+	old = MemoryContextSwitchTo(state->batch_mctx);
+
+	while (state->batch_num_tuples < state->batch_size &&
+		   (state->batch_max_bytes == 0 || batch_bytes < state->batch_max_bytes))
+	{
+		TupleTableSlot *slot = ExecProcNode(substate);
+		ChunkDispatchBatchEntry *entry;
+
+		if (TupIsNull(slot))
+		{
+			state->batch_subplan_done = true;
+			break;
+		}
+
+		if (state->batch_num_tuples >= state->batch_capacity)
+		{
+			state->batch_capacity = Min((Size) state->batch_capacity * 2,
+										(Size) state->batch_size);
+			state->batch = repalloc(state->batch,
+									sizeof(ChunkDispatchBatchEntry) * state->batch_capacity);
+		}
+
+		entry = &state->batch[state->batch_num_tuples];
+		entry->seqno = state->batch_num_tuples;
+		entry->tuple = ExecCopySlotTuple(slot);
+		batch_bytes += HEAPTUPLESIZE + entry->tuple->t_len + sizeof(ChunkDispatchBatchEntry);
+		state->batch_num_tuples++;
+	}
+
+	if (state->batch_num_tuples == 0)
+	{
+		MemoryContextSwitchTo(old);
+		return;
+	}
+
+	if (NULL == dispatch->hypertable_result_rel_info)
+		dispatch->hypertable_result_rel_info = estate->es_result_relation_info;
+
+	tuples = palloc(sizeof(HeapTuple) * state->batch_num_tuples);
+	points = palloc(sizeof(Point *) * state->batch_num_tuples);
+
+	for (i = 0; i < state->batch_num_tuples; i++)
+		tuples[i] = state->batch[i].tuple;
+
+	ts_hyperspace_calculate_points(dispatch->hypertable->space,
+								   state->batch_slot->tts_tupleDescriptor,
+								   tuples,
+								   state->batch_num_tuples,
+								   points);
+
+	for (i = 0; i < state->batch_num_tuples; i++)
+	{
+		ChunkDispatchBatchEntry *entry = &state->batch[i];
+
+		entry->point = points[i];
+		entry->chunk_relid = ts_hypertable_get_chunk(dispatch->hypertable, entry->point)->table_id;
+	}
+
+	MemoryContextSwitchTo(old);
+
+	qsort(state->batch, state->batch_num_tuples,
+		  sizeof(ChunkDispatchBatchEntry), batch_entry_cmp);
+}
+
+static TupleTableSlot *
+chunk_dispatch_exec_batch(ChunkDispatchState *state)
+{
+	ChunkDispatchBatchEntry *entry;
+
+	if (state->batch_next >= state->batch_num_tuples)
+		chunk_dispatch_batch_fill(state);
+
+	if (state->batch_next >= state->batch_num_tuples)
+		return ExecClearTuple(state->batch_slot);
+
+	entry = &state->batch[state->batch_next++];
+	ExecStoreTuple(entry->tuple, state->batch_slot, InvalidBuffer, false);
+
+	/*
+	 * Only switch chunks at the start of a run of tuples for the same chunk.
+	 * No other chunk is looked up during a run, so its insert state cannot be
+	 * evicted.
+	 */
+	if (NULL == state->batch_cis || entry->chunk_relid != state->batch_chunk_relid)
+	{
+		state->batch_cis = chunk_dispatch_switch_chunk(state, entry->point);
+		state->batch_chunk_relid = entry->chunk_relid;
+	}
+
+	return chunk_dispatch_route_tuple(state, state->batch_cis, state->batch_slot);
+}
+
 static TupleTableSlot *
 chunk_dispatch_exec(CustomScanState *node)
 {
@@ -50,69 +312,30 @@ chunk_dispatch_exec(CustomScanState *node)
 	TupleTableSlot *slot;
 	PlanState  *substate = linitial(node->custom_ps);
 
+	if (state->batch_size > 0)
+		return chunk_dispatch_exec_batch(state);
+
 	/* Get the next tuple from the subplan state node */
 	slot = ExecProcNode(substate);
 
 	if (!TupIsNull(slot))
 	{
 		Point	   *point;
-		ChunkInsertState *cis;
-		ChunkDispatch *dispatch = state->dispatch;
-		Hypertable *ht = dispatch->hypertable;
-		HeapTuple	tuple;
-		TupleDesc	tupdesc = slot->tts_tupleDescriptor;
+		Hypertable *ht = state->dispatch->hypertable;
 		EState	   *estate = node->ss.ps.state;
 		MemoryContext old;
 
 		/* Switch to the executor's per-tuple memory context */
 		old = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
 
-		tuple = ExecFetchSlotTuple(slot);
-
 		/* Calculate the tuple's point in the N-dimensional hyperspace */
-		point = ts_hyperspace_calculate_point(ht->space, tuple, tupdesc);
-
-		/* Save the main table's (hypertable's) ResultRelInfo */
-		if (NULL == dispatch->hypertable_result_rel_info)
-			dispatch->hypertable_result_rel_info = estate->es_result_relation_info;
-
-		/*
-		 * Copy over the index to use in the returning list.
-		 */
-		dispatch->returning_index = state->parent->mt_whichplan;
-
-
-		/* Find or create the insert state matching the point */
-		cis = ts_chunk_dispatch_get_chunk_insert_state(dispatch, point);
-
-		/*
-		 * Update the arbiter indexes for ON CONFLICT statements so that they
-		 * match the chunk. Note that this requires updating the existing List
-		 * head (not replacing it), or otherwise the ModifyTableState node
-		 * won't pick it up.
-		 */
-		if (cis->arbiter_indexes != NIL)
-			state->parent->mt_arbiterindexes = cis->arbiter_indexes;
-
-		/* slot for the "existing" tuple in ON CONFLICT UPDATE IS chunk schema */
-		if (cis->tup_conv_map != NULL && state->parent->mt_existing != NULL)
-		{
-			TupleDesc	chunk_desc = cis->tup_conv_map->outdesc;
-
-			ExecSetSlotDescriptor(state->parent->mt_existing, chunk_desc);
-		}
-
-		/*
-		 * Set the result relation in the executor state to the target chunk.
-		 * This makes sure that the tuple gets inserted into the correct
-		 * chunk.
-		 */
-		estate->es_result_relation_info = cis->result_relation_info;
+		point = ts_hyperspace_calculate_point(ht->space, slot);
 
 		MemoryContextSwitchTo(old);
 
-		/* Convert the tuple to the chunk's rowtype, if necessary */
-		tuple = ts_chunk_insert_state_convert_tuple(cis, tuple, &slot);
+		slot = chunk_dispatch_route_tuple(state,
+										  chunk_dispatch_switch_chunk(state, point),
+										  slot);
 	}
 
 	return slot;
@@ -132,17 +355,55 @@ chunk_dispatch_end(CustomScanState *node)
 static void
 chunk_dispatch_rescan(CustomScanState *node)
 {
+	ChunkDispatchState *state = (ChunkDispatchState *) node;
 	PlanState  *substate = linitial(node->custom_ps);
 
+	if (state->batch_size > 0)
+	{
+		MemoryContextReset(state->batch_mctx);
+		state->batch_num_tuples = 0;
+		state->batch_next = 0;
+		state->batch_subplan_done = false;
+		state->batch_cis = NULL;
+	}
+
 	ExecReScan(substate);
 }
 
+/*
+ * Show how tuples were routed to chunks when running EXPLAIN ANALYZE: how
+ * often the chunk insert state was found among the most recently used ones,
+ * and how often chunks were opened, closed to make room for others, and
+ * opened again after being closed.
+ */
+static void
+chunk_dispatch_explain(CustomScanState *node,
+					   List *ancestors,
+					   ExplainState *es)
+{
+	ChunkDispatchState *state = (ChunkDispatchState *) node;
+	ChunkDispatch *dispatch = state->dispatch;
+	const SubspaceStoreStats *stats;
+
+	if (!es->analyze || NULL == dispatch)
+		return;
+
+	stats = ts_subspace_store_stats(dispatch->cache);
+
+	ExplainPropertyLong("Memo Hits", dispatch->memo_hits, es);
+	ExplainPropertyLong("Memo Misses", dispatch->memo_misses, es);
+	ExplainPropertyLong("Chunks Opened", stats->additions, es);
+	ExplainPropertyLong("Chunks Evicted", stats->evictions, es);
+	ExplainPropertyLong("Chunks Reopened", stats->readditions, es);
+}
+
 static CustomExecMethods chunk_dispatch_state_methods = {
 	.CustomName = CHUNK_DISPATCH_STATE_NAME,
 	.BeginCustomScan = chunk_dispatch_begin,
 	.EndCustomScan = chunk_dispatch_end,
 	.ExecCustomScan = chunk_dispatch_exec,
 	.ReScanCustomScan = chunk_dispatch_rescan,
+	.ExplainCustomScan = chunk_dispatch_explain,
 };
 
 ChunkDispatchState *
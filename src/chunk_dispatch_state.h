@@ -13,6 +13,7 @@
 
 typedef struct ChunkDispatch ChunkDispatch;
 typedef struct Cache Cache;
+typedef struct ChunkDispatchBatchEntry ChunkDispatchBatchEntry;
 
 /* State used for every tuple in an insert statement */
 typedef struct ChunkDispatchState
@@ -34,6 +35,27 @@ typedef struct ChunkDispatchState
 	 * for each chunk.
 	 */
 	ChunkDispatch *dispatch;
+
+	/*
+	 * Batching of tuples. When enabled (batch_size > 0), tuples are read from
+	 * the subplan in batches and returned grouped by chunk, so that
+	 * consecutive inserts hit the same chunk. A batch ends after batch_size
+	 * tuples or, if batch_max_bytes is set, once the tuples read take up that
+	 * much memory.
+	 */
+	int			batch_size;
+	Size		batch_max_bytes;
+	MemoryContext batch_mctx;
+	ChunkDispatchBatchEntry *batch;
+	int			batch_capacity;
+	int			batch_num_tuples;
+	int			batch_next;
+	bool		batch_subplan_done;
+	TupleTableSlot *batch_slot;
+
+	/* The insert state of the chunk that the current run of tuples goes to */
+	struct ChunkInsertState *batch_cis;
+	Oid			batch_chunk_relid;
 } ChunkDispatchState;
 
 #define CHUNK_DISPATCH_STATE_NAME "ChunkDispatchState"
@@ -23,6 +23,8 @@
 #include <commands/tablecmds.h>
 #include <commands/cluster.h>
 #include <access/xact.h>
+#include <utils/memutils.h>
+#include <utils/snapmgr.h>
 
 #include "chunk_index.h"
 #include "hypertable.h"
@@ -31,6 +33,7 @@
 #include "scanner.h"
 #include "chunk.h"
 #include "compat.h"
+#include "guc.h"
 
 static List *
 create_index_colnames(Relation indexrel)
@@ -232,12 +235,17 @@ chunk_index_select_tablespace(Relation htrel, Relation chunkrel)
 
 /*
  * Create a chunk index based on the configuration of the "parent" index.
+ *
+ * If skip_build is set, the index is created empty and marked as neither
+ * ready for inserts nor valid, like the first phase of CREATE INDEX
+ * CONCURRENTLY. It must later be built with reindex_index().
  */
 static Oid
 chunk_relation_index_create(Relation htrel,
 							Relation template_indexrel,
 							Relation chunkrel,
-							bool isconstraint)
+							bool isconstraint,
+							bool skip_build)
 {
 	Oid			chunk_indexrelid = InvalidOid;
 	const char *indexname;
@@ -301,8 +309,8 @@ chunk_relation_index_create(Relation htrel,
 									false,	/* deferrable */
 									false,	/* init deferred */
 									false,	/* allow system table mods */
-									false,	/* skip build */
-									false,	/* concurrent */
+									skip_build, /* skip build */
+									skip_build, /* concurrent */
 									false,	/* is internal */
 									false); /* if not exists */
 
@@ -313,13 +321,12 @@ chunk_relation_index_create(Relation htrel,
 
 
 static bool
-chunk_index_insert_relation(Relation rel,
+chunk_index_insert_relation(CatalogMultiInsertState *state,
 							int32 chunk_id,
 							const char *chunk_index,
 							int32 hypertable_id,
 							const char *parent_index)
 {
-	TupleDesc	desc = RelationGetDescr(rel);
 	Datum		values[Natts_chunk_index];
 	bool		nulls[Natts_chunk_index] = {false};
 	CatalogSecurityContext sec_ctx;
@@ -332,7 +339,7 @@ chunk_index_insert_relation(Relation rel,
 		DirectFunctionCall1(namein, CStringGetDatum(parent_index));
 
 	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
-	ts_catalog_insert_values(rel, desc, values, nulls);
+	ts_catalog_multi_insert_values(state, values, nulls);
 	ts_catalog_restore_user(&sec_ctx);
 
 	return true;
@@ -348,11 +355,14 @@ chunk_index_insert(int32 chunk_id,
 				   const char *hypertable_index)
 {
 	Catalog    *catalog = ts_catalog_get();
+	CatalogMultiInsertState state;
 	Relation	rel;
 	bool		result;
 
 	rel = heap_open(catalog_get_table_id(catalog, CHUNK_INDEX), RowExclusiveLock);
-	result = chunk_index_insert_relation(rel, chunk_id, chunk_index, hypertable_id, hypertable_index);
+	ts_catalog_multi_insert_begin(&state, rel);
+	result = chunk_index_insert_relation(&state, chunk_id, chunk_index, hypertable_id, hypertable_index);
+	ts_catalog_multi_insert_end(&state);
 	heap_close(rel, RowExclusiveLock);
 
 	return result;
@@ -373,6 +383,182 @@ ts_chunk_index_create_from_constraint(int32 hypertable_id, Oid hypertable_constr
 					   get_rel_name(hypertable_indexrelid));
 }
 
+/*
+ * Bulk-load state. While a bulk load is in progress, secondary indexes on
+ * newly created chunks are created empty and their builds are deferred until
+ * the load ends. A single sorted build of a full chunk is much cheaper than
+ * inserting every row into the index as it arrives.
+ */
+typedef struct DeferredIndexBuild
+{
+	Oid			indexrelid;
+	char		relpersistence;
+} DeferredIndexBuild;
+
+static int	bulk_load_level = 0;
+
+/*
+ * The bulk-load levels at the start of the current subtransactions, innermost
+ * first. A load that is cut short by an error never ends, so the level is
+ * restored when a subtransaction aborts. Allocated in TopTransactionContext.
+ */
+static List *subxact_bulk_load_levels = NIL;
+
+/* List of DeferredIndexBuild, allocated in TopTransactionContext */
+static List *deferred_builds = NIL;
+
+static void
+chunk_index_defer_build(Oid indexrelid, char relpersistence)
+{
+	MemoryContext old = MemoryContextSwitchTo(TopTransactionContext);
+	DeferredIndexBuild *build = palloc(sizeof(DeferredIndexBuild));
+
+	build->indexrelid = indexrelid;
+	build->relpersistence = relpersistence;
+	deferred_builds = lappend(deferred_builds, build);
+
+	MemoryContextSwitchTo(old);
+}
+
+/*
+ * Build the indexes whose builds were deferred. Indexes that are still open
+ * (e.g., by an outer statement that is also loading data) are left for a
+ * later call, since they cannot be rebuilt while in use.
+ */
+static void
+chunk_index_build_deferred(void)
+{
+	List	   *builds = deferred_builds;
+	ListCell   *lc;
+
+	deferred_builds = NIL;
+
+	foreach(lc, builds)
+	{
+		DeferredIndexBuild *build = lfirst(lc);
+		Relation	indexrel;
+		bool		in_use;
+
+		/* The chunk could have been dropped, or rolled back in a subxact */
+		if (!SearchSysCacheExists1(RELOID, ObjectIdGetDatum(build->indexrelid)))
+			continue;
+
+		indexrel = RelationIdGetRelation(build->indexrelid);
+		in_use = indexrel->rd_refcnt > 1;
+		RelationClose(indexrel);
+
+		if (in_use)
+		{
+			chunk_index_defer_build(build->indexrelid, build->relpersistence);
+			continue;
+		}
+
+		/* Builds the index and marks it ready and valid */
+		reindex_index(build->indexrelid, false, build->relpersistence, 0);
+	}
+}
+
+/*
+ * Start a bulk load. Returns true if index builds for chunks created from now
+ * on are deferred, in which case ts_chunk_index_bulk_load_end() must be
+ * called when the load is done. Unless forced, builds are only deferred if
+ * enabled by the user.
+ */
+bool
+ts_chunk_index_bulk_load_begin(bool force)
+{
+	if (!force && !ts_guc_defer_chunk_index_build)
+		return false;
+
+	bulk_load_level++;
+
+	return true;
+}
+
+/*
+ * End a bulk load, building the deferred indexes once the outermost load
+ * ends.
+ */
+void
+ts_chunk_index_bulk_load_end(void)
+{
+	Assert(bulk_load_level > 0);
+
+	if (bulk_load_level > 0)
+		bulk_load_level--;
+
+	if (bulk_load_level == 0)
+		chunk_index_build_deferred();
+}
+
+static void
+chunk_index_bulk_load_xact_end(XactEvent event, void *arg)
+{
+	switch (event)
+	{
+		case XACT_EVENT_PRE_COMMIT:
+		case XACT_EVENT_PRE_PREPARE:
+
+			/*
+			 * All loads should have ended, but make sure no index is left
+			 * unbuilt at commit.
+			 */
+			bulk_load_level = 0;
+			subxact_bulk_load_levels = NIL;
+
+			if (deferred_builds != NIL)
+			{
+				PushActiveSnapshot(GetTransactionSnapshot());
+				chunk_index_build_deferred();
+				PopActiveSnapshot();
+			}
+			break;
+		case XACT_EVENT_ABORT:
+		case XACT_EVENT_PARALLEL_ABORT:
+			/* The lists are freed along with the transaction's memory */
+			bulk_load_level = 0;
+			subxact_bulk_load_levels = NIL;
+			deferred_builds = NIL;
+			break;
+		default:
+			break;
+	}
+}
+
+static void
+chunk_index_bulk_load_subxact_end(SubXactEvent event, SubTransactionId subtxnid,
+								  SubTransactionId parent_subtxnid, void *arg)
+{
+	MemoryContext old;
+
+	switch (event)
+	{
+		case SUBXACT_EVENT_START_SUB:
+			old = MemoryContextSwitchTo(TopTransactionContext);
+			subxact_bulk_load_levels = lcons_int(bulk_load_level, subxact_bulk_load_levels);
+			MemoryContextSwitchTo(old);
+			break;
+		case SUBXACT_EVENT_COMMIT_SUB:
+		case SUBXACT_EVENT_ABORT_SUB:
+			/* The subtransaction might have started before we were loaded */
+			if (subxact_bulk_load_levels == NIL)
+				break;
+
+			/*
+			 * Loads that started in an aborted subtransaction never end.
+			 * Their deferred index builds are still done when the enclosing
+			 * load ends, or at commit, unless the chunks were rolled back.
+			 */
+			if (event == SUBXACT_EVENT_ABORT_SUB)
+				bulk_load_level = linitial_int(subxact_bulk_load_levels);
+
+			subxact_bulk_load_levels = list_delete_first(subxact_bulk_load_levels);
+			break;
+		default:
+			break;
+	}
+}
+
 /*
  * Create a new chunk index as a child of a parent hypertable index.
  *
@@ -381,7 +567,8 @@ ts_chunk_index_create_from_constraint(int32 hypertable_id, Oid hypertable_constr
  * it should, for each hypertable index, have a corresponding index of its own.
  */
 static void
-chunk_index_create(Relation hypertable_rel,
+chunk_index_create(CatalogMultiInsertState *catalog_state,
+				   Relation hypertable_rel,
 				   int32 hypertable_id,
 				   Relation hypertable_idxrel,
 				   int32 chunk_id,
@@ -389,6 +576,8 @@ chunk_index_create(Relation hypertable_rel,
 				   Oid constraint_oid)
 {
 	Oid			chunk_indexrelid;
+	Form_pg_index index = hypertable_idxrel->rd_index;
+	bool		defer_build;
 
 	if (OidIsValid(constraint_oid))
 	{
@@ -399,15 +588,29 @@ chunk_index_create(Relation hypertable_rel,
 		return;
 	}
 
+	/*
+	 * During a bulk load, postpone building indexes that do not enforce
+	 * anything. Unique indexes must be built since they can be arbiters for
+	 * ON CONFLICT and reject rows as they are inserted.
+	 */
+	defer_build = bulk_load_level > 0 &&
+		!index->indisunique &&
+		!index->indisexclusion;
+
 	chunk_indexrelid = chunk_relation_index_create(hypertable_rel,
 												   hypertable_idxrel,
 												   chunkrel,
-												   false);
+												   false,
+												   defer_build);
 
-	chunk_index_insert(chunk_id,
-					   get_rel_name(chunk_indexrelid),
-					   hypertable_id,
-					   get_rel_name(RelationGetRelid(hypertable_idxrel)));
+	if (defer_build)
+		chunk_index_defer_build(chunk_indexrelid, chunkrel->rd_rel->relpersistence);
+
+	chunk_index_insert_relation(catalog_state,
+								chunk_id,
+								get_rel_name(chunk_indexrelid),
+								hypertable_id,
+								get_rel_name(RelationGetRelid(hypertable_idxrel)));
 }
 
 /*
@@ -471,6 +674,8 @@ ts_chunk_index_create_all(int32 hypertable_id, Oid hypertable_relid, int32 chunk
 {
 	Relation	htrel;
 	Relation	chunkrel;
+	Relation	catalog_rel;
+	CatalogMultiInsertState catalog_state;
 	List	   *indexlist;
 	ListCell   *lc;
 
@@ -492,12 +697,17 @@ ts_chunk_index_create_all(int32 hypertable_id, Oid hypertable_relid, int32 chunk
 	 */
 	indexlist = RelationGetIndexList(htrel);
 
+	/* Add the catalog entries of all the chunk's indexes in one go */
+	catalog_rel = heap_open(catalog_get_table_id(ts_catalog_get(), CHUNK_INDEX), RowExclusiveLock);
+	ts_catalog_multi_insert_begin(&catalog_state, catalog_rel);
+
 	foreach(lc, indexlist)
 	{
 		Oid			hypertable_idxoid = lfirst_oid(lc);
 		Relation	hypertable_idxrel = relation_open(hypertable_idxoid, AccessShareLock);
 
-		chunk_index_create(htrel,
+		chunk_index_create(&catalog_state,
+						   htrel,
 						   hypertable_id,
 						   hypertable_idxrel,
 						   chunk_id,
@@ -507,6 +717,9 @@ ts_chunk_index_create_all(int32 hypertable_id, Oid hypertable_relid, int32 chunk
 		relation_close(hypertable_idxrel, AccessShareLock);
 	}
 
+	ts_catalog_multi_insert_end(&catalog_state);
+	heap_close(catalog_rel, RowExclusiveLock);
+
 	relation_close(chunkrel, NoLock);
 	relation_close(htrel, AccessShareLock);
 }
@@ -957,7 +1170,7 @@ ts_chunk_index_clone(PG_FUNCTION_ARGS)
 	constraint_oid = get_index_constraint(cim->parent_indexoid);
 
 	new_chunk_indexrelid = chunk_relation_index_create(hypertable_rel, chunk_index_rel,
-													   chunk_rel, OidIsValid(constraint_oid));
+													   chunk_rel, OidIsValid(constraint_oid), false);
 
 	heap_close(chunk_rel, NoLock);
 
@@ -1010,3 +1223,17 @@ ts_chunk_index_replace(PG_FUNCTION_ARGS)
 
 	PG_RETURN_VOID();
 }
+
+void
+_chunk_index_init(void)
+{
+	RegisterXactCallback(chunk_index_bulk_load_xact_end, NULL);
+	RegisterSubXactCallback(chunk_index_bulk_load_subxact_end, NULL);
+}
+
+void
+_chunk_index_fini(void)
+{
+	UnregisterXactCallback(chunk_index_bulk_load_xact_end, NULL);
+	UnregisterSubXactCallback(chunk_index_bulk_load_subxact_end, NULL);
+}
@@ -36,6 +36,8 @@ extern void ts_chunk_index_create_from_constraint(int32 hypertable_id, Oid hyper
 extern List *ts_chunk_index_get_mappings(Hypertable *ht, Oid hypertable_indexrelid);
 extern ChunkIndexMapping *ts_chunk_index_get_by_hypertable_indexrelid(Chunk *chunk, Oid hypertable_indexrelid);
 extern void ts_chunk_index_mark_clustered(Oid chunkrelid, Oid indexrelid);
+extern bool ts_chunk_index_bulk_load_begin(bool force);
+extern void ts_chunk_index_bulk_load_end(void);
 
 /* chunk_index_recreate  is a process akin to reindex
  * except that indexes are created in 2 steps
@@ -11,9 +11,14 @@
 #include <utils/lsyscache.h>
 #include <utils/builtins.h>
 #include <utils/guc.h>
+#include <utils/inval.h>
+#include <utils/memutils.h>
+#include <utils/hsearch.h>
 #include <nodes/plannodes.h>
 #include <nodes/relation.h>
+#include <access/heapam.h>
 #include <access/xact.h>
+#include <access/xlog.h>
 #include <optimizer/plancat.h>
 #include <optimizer/clauses.h>
 #include <optimizer/planner.h>
@@ -29,6 +34,14 @@
 #include "chunk_dispatch_state.h"
 #include "compat.h"
 #include "chunk_index.h"
+#include "hypercube.h"
+
+/* Prepared CHECK constraint expressions, as stored in a ResultRelInfo */
+#if PG10
+typedef ExprState **ConstraintExprs;
+#elif PG96
+typedef List **ConstraintExprs;
+#endif
 
 /*
  * Create a new RangeTblEntry for the chunk in the executor's range table and
@@ -96,40 +109,83 @@ create_chunk_range_table_entry(ChunkDispatch *dispatch, Relation rel)
  * main table has been modified, e.g., a column was dropped. The dropped column
  * will remain on existing tables (marked as dropped) but won't be created on
  * new tables (chunks). This leads to a situation where the root table and
- * chunks can have different attnums for columns.
+ * chunks can have different attnums for columns. Such chunks can be rewritten
+ * to the root table's layout with _timescaledb_internal.repair_chunk_layout(),
+ * after which no conversion is needed.
+ *
+ * Rather than forming the tuple in the hypertable's rowtype and re-forming it
+ * in the chunk's, the slot's values are moved to the chunk's attribute
+ * numbers and returned as a virtual tuple in the chunk insert state's slot.
+ * The tuple is then formed only once, when the slot is materialized. The
+ * returned slot references the values of the given slot, so that slot must
+ * not change until then.
  */
-HeapTuple
-ts_chunk_insert_state_convert_tuple(ChunkInsertState *state,
-									HeapTuple tuple,
-									TupleTableSlot **existing_slot)
+TupleTableSlot *
+ts_chunk_insert_state_convert_slot(ChunkInsertState *state, TupleTableSlot *slot)
 {
-	Relation	chunkrel = state->result_relation_info->ri_RelationDesc;
+	TupleConversionMap *map = state->tup_conv_map;
+	TupleTableSlot *chunk_slot = state->slot;
+	int			i;
 
-	if (NULL == state->tup_conv_map)
+	if (NULL == map)
 		/* No conversion needed */
-		return tuple;
+		return slot;
 
-	tuple = do_convert_tuple(tuple, state->tup_conv_map);
+	slot_getallattrs(slot);
+	ExecClearTuple(chunk_slot);
 
-	ExecSetSlotDescriptor(state->slot, RelationGetDescr(chunkrel));
-	ExecStoreTuple(tuple, state->slot, InvalidBuffer, true);
+	for (i = 0; i < map->outdesc->natts; i++)
+	{
+		AttrNumber	attno = map->attrMap[i];
 
-	if (NULL != existing_slot)
-		*existing_slot = state->slot;
+		if (attno == InvalidAttrNumber)
+		{
+			chunk_slot->tts_values[i] = (Datum) 0;
+			chunk_slot->tts_isnull[i] = true;
+		}
+		else
+		{
+			chunk_slot->tts_values[i] = slot->tts_values[attno - 1];
+			chunk_slot->tts_isnull[i] = slot->tts_isnull[attno - 1];
+		}
+	}
 
-	return tuple;
+	return ExecStoreVirtualTuple(chunk_slot);
 }
 
-/* Just like ExecPrepareExpr except that it doesn't switch to the query memory context */
-static inline ExprState *
-prepare_constr_expr(Expr *node)
+/*
+ * Plan the CHECK constraint expressions of a relation inside the current
+ * memory context, like the first part of ExecPrepareExpr. On PostgreSQL 9.6,
+ * the expressions are in the implicit-AND form that ExecQual wants.
+ *
+ * The planned expressions do not depend on the statement, so they can be
+ * shared by the inserts into a chunk during a transaction.
+ */
+static Expr **
+plan_constraint_exprs(Relation rel)
 {
-	ExprState  *result;
+	int			ncheck,
+				i;
+	ConstrCheck *check;
+	Expr	  **exprs;
 
-	node = expression_planner(node);
-	result = ExecInitExpr(node, NULL);
+	Assert(rel->rd_att->constr != NULL);
+
+	ncheck = rel->rd_att->constr->num_check;
+	check = rel->rd_att->constr->check;
+	exprs = palloc(ncheck * sizeof(Expr *));
 
-	return result;
+	for (i = 0; i < ncheck; i++)
+	{
+		Expr	   *checkconstr = stringToNode(check[i].ccbin);
+
+#if PG96
+		checkconstr = (Expr *) make_ands_implicit(checkconstr);
+#endif
+		exprs[i] = expression_planner(checkconstr);
+	}
+
+	return exprs;
 }
 
 /*
@@ -137,46 +193,334 @@ prepare_constr_expr(Expr *node)
  * is not done here, then ExecRelCheck will do it for you but put it into
  * the query memory context, which will cause a memory leak.
  *
+ * Expression states are created per chunk insert state, i.e., per statement,
+ * since their evaluation can keep state in the statement's memory (e.g., the
+ * function call caches on PostgreSQL 9.6). A NULL expression gives a NULL
+ * state, which always passes.
+ *
  * See the comment in `chunk_insert_state_destroy` for more information
  * on the implications of this.
  */
-static inline void
-create_chunk_rri_constraint_expr(ResultRelInfo *rri, Relation rel)
+static ConstraintExprs
+create_constraint_exprs(Expr **planned, int ncheck)
 {
-	int			ncheck,
-				i;
-	ConstrCheck *check;
-
-	Assert(rel->rd_att->constr != NULL &&
-		   rri->ri_ConstraintExprs == NULL);
-
-	ncheck = rel->rd_att->constr->num_check;
-	check = rel->rd_att->constr->check;
+	ConstraintExprs exprs;
+	int			i;
 
 #if PG10
-	rri->ri_ConstraintExprs =
-		(ExprState **) palloc(ncheck * sizeof(ExprState *));
+	exprs = (ExprState **) palloc(ncheck * sizeof(ExprState *));
 
 	for (i = 0; i < ncheck; i++)
+		exprs[i] = ExecInitExpr(planned[i], NULL);
+#elif PG96
+	exprs = (List **) palloc(ncheck * sizeof(List *));
+
+	for (i = 0; i < ncheck; i++)
+		exprs[i] = (List *) ExecInitExpr(planned[i], NULL);
+#endif
+
+	return exprs;
+}
+
+/*
+ * Transaction-scoped cache for the parts of chunk insert states that do not
+ * depend on the statement: the planned CHECK constraint expressions, the
+ * mapping of hypertable indexes to chunk indexes (for ON CONFLICT arbiters)
+ * and the tuple conversion maps between the hypertable and chunk rowtypes.
+ *
+ * Inserts into the same chunk in subsequent statements of a transaction reuse
+ * these instead of building them anew. Everything that is tied to the
+ * statement's locks and executor state is still set up per statement: opening
+ * the chunk and its indexes, the ResultRelInfo, the constraint expression
+ * states and adjusted RETURNING and ON CONFLICT projections. Entries are
+ * invalidated on relcache invalidation of the chunk (which DDL on the
+ * hypertable's columns recurses to) and the whole cache is dropped at the end
+ * of the transaction.
+ */
+typedef struct ChunkInsertCacheEntry
+{
+	Oid			chunk_relid;	/* Hash key */
+	bool		valid;
+
+	/*
+	 * Number of chunk insert states using the entry. The expression states
+	 * of those insert states reference the planned expressions, so an
+	 * invalid entry is only rebuilt when it is not in use.
+	 */
+	int			refcount;
+	MemoryContext mcxt;
+	Expr	  **constraint_exprs;
+	List	   *hypertable_indexes;
+	List	   *chunk_indexes;
+
+	/*
+	 * Maps converting hypertable tuples to the chunk's rowtype and
+	 * hypertable attnos to chunk attnos. The conversion map is NULL if the
+	 * chunk has the same layout as the hypertable, so whether it has been
+	 * computed is tracked separately.
+	 */
+	bool		tup_conv_map_set;
+	TupleConversionMap *tup_conv_map;
+	AttrNumber *variable_attnos_map;
+} ChunkInsertCacheEntry;
+
+/*
+ * A use of a cache entry by a chunk insert state. Insert states are not
+ * destroyed when a subtransaction aborts, so the uses of the aborted
+ * subtransaction are released by the subtransaction callback.
+ */
+typedef struct ChunkInsertCacheUse
+{
+	ChunkInsertCacheEntry *entry;
+	SubTransactionId subtxnid;
+} ChunkInsertCacheUse;
+
+static HTAB *chunk_insert_cache = NULL;
+static MemoryContext chunk_insert_cache_mcxt = NULL;
+static List *chunk_insert_cache_uses = NIL;
+
+static void
+chunk_insert_cache_init(void)
+{
+	HASHCTL		hctl = {
+		.keysize = sizeof(Oid),
+		.entrysize = sizeof(ChunkInsertCacheEntry),
+	};
+
+	chunk_insert_cache_mcxt = AllocSetContextCreate(TopTransactionContext,
+													"Chunk insert cache",
+													ALLOCSET_DEFAULT_SIZES);
+	hctl.hcxt = chunk_insert_cache_mcxt;
+	chunk_insert_cache = hash_create("Chunk insert cache", 32, &hctl,
+									 HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+}
+
+/*
+ * Get the cache entry for a chunk, (re)building it if necessary.
+ *
+ * Returns NULL if the entry is invalid but still in use, in which case the
+ * caller needs to create its own state.
+ */
+static ChunkInsertCacheEntry *
+chunk_insert_cache_acquire(Relation rel)
+{
+	Oid			relid = RelationGetRelid(rel);
+	ChunkInsertCacheEntry *entry;
+	ChunkInsertCacheUse *use;
+	MemoryContext old;
+	bool		found;
+
+	if (NULL == chunk_insert_cache)
+		chunk_insert_cache_init();
+
+	entry = hash_search(chunk_insert_cache, &relid, HASH_ENTER, &found);
+
+	if (!found)
 	{
-		Expr	   *checkconstr = stringToNode(check[i].ccbin);
+		entry->valid = false;
+		entry->refcount = 0;
+		entry->mcxt = AllocSetContextCreate(chunk_insert_cache_mcxt,
+											"Chunk insert cache entry",
+											ALLOCSET_SMALL_SIZES);
+	}
 
-		rri->ri_ConstraintExprs[i] =
-			prepare_constr_expr(checkconstr);
+	if (!entry->valid)
+	{
+		if (entry->refcount > 0)
+			return NULL;
+
+		MemoryContextReset(entry->mcxt);
+		old = MemoryContextSwitchTo(entry->mcxt);
+		entry->constraint_exprs = plan_constraint_exprs(rel);
+		entry->hypertable_indexes = NIL;
+		entry->chunk_indexes = NIL;
+		entry->tup_conv_map_set = false;
+		entry->tup_conv_map = NULL;
+		entry->variable_attnos_map = NULL;
+		entry->valid = true;
+		MemoryContextSwitchTo(old);
 	}
-#elif PG96
-	rri->ri_ConstraintExprs =
-		(List **) palloc(ncheck * sizeof(List *));
 
-	for (i = 0; i < ncheck; i++)
+	old = MemoryContextSwitchTo(chunk_insert_cache_mcxt);
+	use = palloc(sizeof(ChunkInsertCacheUse));
+	use->entry = entry;
+	use->subtxnid = GetCurrentSubTransactionId();
+	chunk_insert_cache_uses = lcons(use, chunk_insert_cache_uses);
+	MemoryContextSwitchTo(old);
+
+	entry->refcount++;
+
+	return entry;
+}
+
+static void
+chunk_insert_cache_release(ChunkInsertCacheEntry *entry)
+{
+	ListCell   *lc;
+
+	Assert(entry->refcount > 0);
+	entry->refcount--;
+
+	/* Forget the most recent use of the entry */
+	foreach(lc, chunk_insert_cache_uses)
 	{
-		/* ExecQual wants implicit-AND form */
-		List	   *qual = make_ands_implicit(stringToNode(check[i].ccbin));
+		ChunkInsertCacheUse *use = lfirst(lc);
 
-		rri->ri_ConstraintExprs[i] = (List *)
-			prepare_constr_expr((Expr *) qual);
+		if (use->entry == entry)
+		{
+			chunk_insert_cache_uses = list_delete_ptr(chunk_insert_cache_uses, use);
+			pfree(use);
+			return;
+		}
+	}
+
+	Assert(false);
+}
+
+static void
+chunk_insert_cache_invalidate_callback(Datum arg, Oid relid)
+{
+	HASH_SEQ_STATUS status;
+	ChunkInsertCacheEntry *entry;
+
+	if (NULL == chunk_insert_cache)
+		return;
+
+	if (OidIsValid(relid))
+	{
+		entry = hash_search(chunk_insert_cache, &relid, HASH_FIND, NULL);
+
+		if (NULL != entry)
+			entry->valid = false;
+		return;
+	}
+
+	hash_seq_init(&status, chunk_insert_cache);
+
+	while ((entry = hash_seq_search(&status)) != NULL)
+		entry->valid = false;
+}
+
+static void
+chunk_insert_cache_xact_end(XactEvent event, void *arg)
+{
+	switch (event)
+	{
+		case XACT_EVENT_COMMIT:
+		case XACT_EVENT_PARALLEL_COMMIT:
+		case XACT_EVENT_ABORT:
+		case XACT_EVENT_PARALLEL_ABORT:
+		case XACT_EVENT_PREPARE:
+
+			/*
+			 * The cache's memory is freed along with the transaction's
+			 * memory context
+			 */
+			chunk_insert_cache = NULL;
+			chunk_insert_cache_mcxt = NULL;
+			chunk_insert_cache_uses = NIL;
+			break;
+		default:
+			break;
 	}
-#endif
+}
+
+/*
+ * Track the cache entries used by the chunk insert states of subtransactions.
+ *
+ * The insert states of an aborted subtransaction are never destroyed, so
+ * their entries are released here since they would otherwise stay in use,
+ * and could not be rebuilt, for the rest of the transaction. Uses of a
+ * committed subtransaction are moved to its parent, so that they are released
+ * if the parent aborts.
+ */
+static void
+chunk_insert_cache_subxact_end(SubXactEvent event, SubTransactionId subtxnid,
+							   SubTransactionId parent_subtxnid, void *arg)
+{
+	ListCell   *lc;
+	ListCell   *prev = NULL;
+	ListCell   *next;
+
+	switch (event)
+	{
+		case SUBXACT_EVENT_COMMIT_SUB:
+			foreach(lc, chunk_insert_cache_uses)
+			{
+				ChunkInsertCacheUse *use = lfirst(lc);
+
+				if (use->subtxnid == subtxnid)
+					use->subtxnid = parent_subtxnid;
+			}
+			break;
+		case SUBXACT_EVENT_ABORT_SUB:
+			for (lc = list_head(chunk_insert_cache_uses); lc != NULL; lc = next)
+			{
+				ChunkInsertCacheUse *use = lfirst(lc);
+
+				next = lnext(lc);
+
+				if (use->subtxnid == subtxnid)
+				{
+					Assert(use->entry->refcount > 0);
+					use->entry->refcount--;
+					chunk_insert_cache_uses = list_delete_cell(chunk_insert_cache_uses, lc, prev);
+					pfree(use);
+				}
+				else
+					prev = lc;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/*
+ * Get the CHECK constraint expressions to evaluate for tuples routed to a
+ * chunk.
+ *
+ * A routed tuple lies within the chunk's hypercube, so the chunk's dimension
+ * constraints hold by construction and are left out. This is not the case if
+ * a BEFORE ROW trigger can change the tuple after routing or ON CONFLICT DO
+ * UPDATE can change an existing tuple, so all constraints are kept then.
+ */
+static Expr **
+chunk_routed_constraint_exprs(Expr **exprs, Relation rel, Chunk *chunk,
+							  ChunkDispatch *dispatch)
+{
+	TupleConstr *constr = rel->rd_att->constr;
+	Expr	  **routed;
+	int			i,
+				j;
+
+	if (dispatch->on_conflict == ONCONFLICT_UPDATE ||
+		(rel->trigdesc != NULL && rel->trigdesc->trig_insert_before_row) ||
+		NULL == chunk->constraints ||
+		chunk->constraints->num_dimension_constraints == 0)
+		return exprs;
+
+	routed = palloc(constr->num_check * sizeof(*routed));
+
+	for (i = 0; i < constr->num_check; i++)
+	{
+		routed[i] = exprs[i];
+
+		for (j = 0; j < chunk->constraints->num_constraints; j++)
+		{
+			ChunkConstraint *cc = &chunk->constraints->constraints[j];
+
+			if (is_dimension_constraint(cc) &&
+				namestrcmp(&cc->fd.constraint_name, constr->check[i].ccname) == 0)
+			{
+				/* An empty expression always passes */
+				routed[i] = NULL;
+				break;
+			}
+		}
+	}
+
+	return routed;
 }
 
 /*
@@ -189,8 +533,10 @@ create_chunk_rri_constraint_expr(ResultRelInfo *rri, Relation rel)
  * table's) is used as a template for the chunk's new ResultRelInfo.
  */
 static inline ResultRelInfo *
-create_chunk_result_relation_info(ChunkDispatch *dispatch, Relation rel, Index rti)
+create_chunk_result_relation_info(ChunkDispatch *dispatch, Relation rel, Index rti,
+								  Chunk *chunk, ChunkInsertCacheEntry *cache_entry)
 {
+	Expr	  **constraint_exprs;
 	ResultRelInfo *rri,
 			   *rri_orig;
 
@@ -212,7 +558,15 @@ create_chunk_result_relation_info(ChunkDispatch *dispatch, Relation rel, Index r
 	rri->ri_onConflictSetProj = rri_orig->ri_onConflictSetProj;
 	rri->ri_onConflictSetWhere = rri_orig->ri_onConflictSetWhere;
 
-	create_chunk_rri_constraint_expr(rri, rel);
+	if (NULL != cache_entry)
+		constraint_exprs = cache_entry->constraint_exprs;
+	else
+		constraint_exprs = plan_constraint_exprs(rel);
+
+	constraint_exprs = chunk_routed_constraint_exprs(constraint_exprs, rel,
+													 chunk, dispatch);
+	rri->ri_ConstraintExprs = create_constraint_exprs(constraint_exprs,
+													  rel->rd_att->constr->num_check);
 
 	return rri;
 }
@@ -364,9 +718,24 @@ adjust_projections(ChunkInsertState *cis, ChunkDispatch *dispatch, Oid rowtype)
 	 * the hypertable_desc in the out spot for map_variable_attnos to work
 	 * correctly in mapping hypertable attnos->chunk attnos
 	 */
-	variable_attnos_map = convert_tuples_by_name_map(chunk_desc,
-													 hypertable_desc,
-													 gettext_noop("could not convert row type"));
+	if (NULL != cis->cache_entry && NULL != cis->cache_entry->variable_attnos_map)
+		variable_attnos_map = cis->cache_entry->variable_attnos_map;
+	else
+	{
+		MemoryContext old = CurrentMemoryContext;
+
+		if (NULL != cis->cache_entry)
+			MemoryContextSwitchTo(cis->cache_entry->mcxt);
+
+		variable_attnos_map = convert_tuples_by_name_map(chunk_desc,
+														 hypertable_desc,
+														 gettext_noop("could not convert row type"));
+		MemoryContextSwitchTo(old);
+
+		if (NULL != cis->cache_entry)
+			cis->cache_entry->variable_attnos_map = variable_attnos_map;
+	}
+
 	variable_attnos_map_size = hypertable_desc->natts;
 
 	if (rri->ri_projectReturning != NULL)
@@ -425,9 +794,108 @@ tuple_conversion_needed(TupleDesc indesc,
 			indesc->tdhasoid != outdesc->tdhasoid);
 }
 
+/*
+ * Get the map that converts tuples in the hypertable's rowtype to the chunk's,
+ * or NULL if the chunk has the same physical layout as the hypertable.
+ */
+TupleConversionMap *
+ts_chunk_insert_state_tuple_conversion_map(TupleDesc hypertable_desc, TupleDesc chunk_desc)
+{
+	if (!tuple_conversion_needed(hypertable_desc, chunk_desc))
+		return NULL;
+
+	return convert_tuples_by_name(hypertable_desc,
+								  chunk_desc,
+								  gettext_noop("could not convert row type"));
+}
+
+/*
+ * Get the tuple conversion map for a chunk insert state, using the cached map
+ * if possible.
+ *
+ * A cached map is built from copies of the tuple descriptors, since the
+ * relcache entries of the chunk and hypertable can be rebuilt between the
+ * statements that use it.
+ */
+static TupleConversionMap *
+chunk_insert_state_get_tuple_conversion_map(ChunkInsertState *state, Relation rel)
+{
+	ChunkInsertCacheEntry *entry = state->cache_entry;
+	TupleDesc	hypertable_desc,
+				chunk_desc;
+	TupleConversionMap *map;
+	Relation	parent_rel;
+	MemoryContext old;
+
+	if (NULL != entry && entry->tup_conv_map_set)
+		return entry->tup_conv_map;
+
+	parent_rel = heap_open(state->dispatch->hypertable->main_table_relid, AccessShareLock);
+	hypertable_desc = RelationGetDescr(parent_rel);
+	chunk_desc = RelationGetDescr(rel);
+
+	if (NULL == entry)
+	{
+		map = ts_chunk_insert_state_tuple_conversion_map(hypertable_desc, chunk_desc);
+		heap_close(parent_rel, AccessShareLock);
+		return map;
+	}
+
+	old = MemoryContextSwitchTo(entry->mcxt);
+
+	if (tuple_conversion_needed(hypertable_desc, chunk_desc))
+		map = ts_chunk_insert_state_tuple_conversion_map(CreateTupleDescCopy(hypertable_desc),
+														  CreateTupleDescCopy(chunk_desc));
+	else
+		map = NULL;
+
+	MemoryContextSwitchTo(old);
+	heap_close(parent_rel, AccessShareLock);
+
+	entry->tup_conv_map = map;
+	entry->tup_conv_map_set = true;
+
+	return map;
+}
+
+/*
+ * Get the chunk index corresponding to a hypertable index, using the cached
+ * mapping if possible.
+ */
+static Oid
+chunk_insert_state_get_chunk_index(ChunkInsertState *state, Chunk *chunk, Oid hypertable_index)
+{
+	ChunkInsertCacheEntry *entry = state->cache_entry;
+	ChunkIndexMapping *cim;
+	MemoryContext old;
+	ListCell   *lc_ht,
+			   *lc_chunk;
+
+	if (NULL != entry)
+	{
+		forboth(lc_ht, entry->hypertable_indexes, lc_chunk, entry->chunk_indexes)
+		{
+			if (lfirst_oid(lc_ht) == hypertable_index)
+				return lfirst_oid(lc_chunk);
+		}
+	}
+
+	cim = ts_chunk_index_get_by_hypertable_indexrelid(chunk, hypertable_index);
+
+	if (NULL != entry)
+	{
+		old = MemoryContextSwitchTo(entry->mcxt);
+		entry->hypertable_indexes = lappend_oid(entry->hypertable_indexes, hypertable_index);
+		entry->chunk_indexes = lappend_oid(entry->chunk_indexes, cim->indexoid);
+		MemoryContextSwitchTo(old);
+	}
+
+	return cim->indexoid;
+}
+
 /* Translate hypertable indexes to chunk indexes in the arbiter clause */
 static void
-chunk_insert_state_set_arbiter_indexes(ChunkInsertState *state, ChunkDispatch *dispatch, Relation chunk_rel)
+chunk_insert_state_set_arbiter_indexes(ChunkInsertState *state, ChunkDispatch *dispatch, Chunk *chunk)
 {
 	ListCell   *lc;
 
@@ -435,13 +903,67 @@ chunk_insert_state_set_arbiter_indexes(ChunkInsertState *state, ChunkDispatch *d
 	foreach(lc, dispatch->arbiter_indexes)
 	{
 		Oid			hypertable_index = lfirst_oid(lc);
-		Chunk	   *chunk = ts_chunk_get_by_relid(RelationGetRelid(chunk_rel), 0, true);
-		ChunkIndexMapping *cim = ts_chunk_index_get_by_hypertable_indexrelid(chunk, hypertable_index);
 
-		state->arbiter_indexes = lappend_oid(state->arbiter_indexes, cim->indexoid);
+		state->arbiter_indexes = lappend_oid(state->arbiter_indexes,
+											 chunk_insert_state_get_chunk_index(state, chunk, hypertable_index));
 	}
 }
 
+/*
+ * Determine the heap_insert() options for a chunk, like PostgreSQL's CopyFrom()
+ * does for the table it copies into.
+ *
+ * A chunk created or truncated in the current transaction is discarded (or
+ * gets its old relfilenode back) if the transaction does not commit, so
+ * checking the FSM is a waste of time and WAL is not needed unless it is
+ * archived or streamed. Chunks written without WAL must be synced before
+ * commit.
+ */
+static int
+chunk_insert_state_heap_insert_options(Relation rel, bool freeze)
+{
+	int			hi_options = 0;
+
+	/* createSubid is creation check, newRelfilenodeSubid is truncation check */
+	if (rel->rd_createSubid != InvalidSubTransactionId ||
+		rel->rd_newRelfilenodeSubid != InvalidSubTransactionId)
+	{
+		hi_options |= HEAP_INSERT_SKIP_FSM;
+		if (!XLogIsNeeded())
+			hi_options |= HEAP_INSERT_SKIP_WAL;
+	}
+
+	/*
+	 * Tuples can only be frozen if no other transaction can see the chunk
+	 * before the current subtransaction commits
+	 */
+	if (freeze &&
+		(rel->rd_createSubid == GetCurrentSubTransactionId() ||
+		 rel->rd_newRelfilenodeSubid == GetCurrentSubTransactionId()))
+		hi_options |= HEAP_INSERT_FROZEN;
+
+	return hi_options;
+}
+
+/*
+ * Get the total memory allocated by a memory context and its children.
+ */
+static Size
+memory_context_total_space(MemoryContext context)
+{
+	MemoryContextCounters counters = {0};
+	MemoryContext child;
+	Size		total;
+
+	context->methods->stats(context, 0, false, &counters);
+	total = counters.totalspace;
+
+	for (child = context->firstchild; child != NULL; child = child->nextchild)
+		total += memory_context_total_space(child);
+
+	return total;
+}
+
 /*
  * Create new insert chunk state.
  *
@@ -452,8 +974,7 @@ extern ChunkInsertState *
 ts_chunk_insert_state_create(Chunk *chunk, ChunkDispatch *dispatch)
 {
 	ChunkInsertState *state;
-	Relation	rel,
-				parent_rel;
+	Relation	rel;
 	Index		rti;
 	MemoryContext old_mcxt;
 	MemoryContext cis_context = AllocSetContextCreate(dispatch->estate->es_query_cxt,
@@ -481,14 +1002,18 @@ ts_chunk_insert_state_create(Chunk *chunk, ChunkDispatch *dispatch)
 	rti = create_chunk_range_table_entry(dispatch, rel);
 
 	MemoryContextSwitchTo(cis_context);
-	resrelinfo = create_chunk_result_relation_info(dispatch, rel, rti);
+	state = palloc0(sizeof(ChunkInsertState));
+	state->cache_entry = chunk_insert_cache_acquire(rel);
+	resrelinfo = create_chunk_result_relation_info(dispatch, rel, rti, chunk, state->cache_entry);
 	CheckValidResultRelCompat(resrelinfo, dispatch->cmd_type);
 
-	state = palloc0(sizeof(ChunkInsertState));
 	state->mctx = cis_context;
+	state->cube = ts_hypercube_copy(chunk->cube);
 	state->rel = rel;
 	state->result_relation_info = resrelinfo;
+	state->dispatch = dispatch;
 	state->estate = dispatch->estate;
+	state->hi_options = chunk_insert_state_heap_insert_options(rel, dispatch->freeze);
 
 	if (resrelinfo->ri_RelationDesc->rd_rel->relhasindex &&
 		resrelinfo->ri_IndexRelationDescs == NULL)
@@ -504,27 +1029,30 @@ ts_chunk_insert_state_create(Chunk *chunk, ChunkDispatch *dispatch)
 
 	/* Set the chunk's arbiter indexes for ON CONFLICT statements */
 	if (dispatch->on_conflict != ONCONFLICT_NONE)
-		chunk_insert_state_set_arbiter_indexes(state, dispatch, rel);
+		chunk_insert_state_set_arbiter_indexes(state, dispatch, chunk);
 
 	/* Set tuple conversion map, if tuple needs conversion */
-	parent_rel = heap_open(dispatch->hypertable->main_table_relid, AccessShareLock);
+	state->tup_conv_map = chunk_insert_state_get_tuple_conversion_map(state, rel);
 
-	if (tuple_conversion_needed(RelationGetDescr(parent_rel), RelationGetDescr(rel)))
-	{
-		state->tup_conv_map = convert_tuples_by_name(RelationGetDescr(parent_rel),
-													 RelationGetDescr(rel),
-													 gettext_noop("could not convert row type"));
+	if (NULL != state->tup_conv_map)
 		adjust_projections(state, dispatch, RelationGetForm(rel)->reltype);
-	}
 
 	/* Need a tuple table slot to store converted tuples */
 	if (state->tup_conv_map)
+	{
 		state->slot = MakeTupleTableSlot();
-
-	heap_close(parent_rel, AccessShareLock);
+		ExecSetSlotDescriptor(state->slot, RelationGetDescr(rel));
+	}
 
 	MemoryContextSwitchTo(old_mcxt);
 
+	/*
+	 * Track the memory of the relation info, index info and conversion maps
+	 * so that the dispatch can bound the total memory of open chunks.
+	 */
+	state->mctx_size = memory_context_total_space(cis_context);
+	state->memory_size = state->mctx_size;
+
 	return state;
 }
 
@@ -537,6 +1065,9 @@ ts_chunk_insert_state_destroy(ChunkInsertState *state)
 	ExecCloseIndices(state->result_relation_info);
 	heap_close(state->rel, NoLock);
 
+	if (NULL != state->cache_entry)
+		chunk_insert_cache_release(state->cache_entry);
+
 	/*
 	 * Postgres stores cached row types from `get_cached_rowtype` in the
 	 * contraint expression and tries to free this type via a callback from
@@ -572,5 +1103,68 @@ ts_chunk_insert_state_destroy(ChunkInsertState *state)
 	if (NULL != state->slot)
 		ExecDropSingleTupleTableSlot(state->slot);
 
+	if (NULL != state->bistate)
+		FreeBulkInsertState(state->bistate);
+
 	MemoryContextDelete(state->mctx);
 }
+
+/*
+ * Get the chunk's bulk insert state, creating it if necessary.
+ *
+ * Every chunk gets its own bulk insert state so that the current target page
+ * of a chunk stays pinned even when tuples for different chunks are
+ * interleaved.
+ */
+BulkInsertState
+ts_chunk_insert_state_get_bistate(ChunkInsertState *state)
+{
+	if (NULL == state->bistate)
+	{
+		MemoryContext old = MemoryContextSwitchTo(state->mctx);
+
+		state->bistate = GetBulkInsertState();
+		MemoryContextSwitchTo(old);
+		ts_chunk_insert_state_update_memory_size(state, true);
+	}
+
+	return state->bistate;
+}
+
+/*
+ * Update the memory size of the state in the dispatch's store of open chunks
+ * after the state grew or shrank, e.g., when tuples are buffered for the
+ * chunk or the buffer is flushed. The store evicts chunks based on the
+ * updated size the next time it opens a chunk.
+ *
+ * Measuring the state's memory context walks its blocks, so it is only done
+ * when remeasure is set, i.e., after allocations in the context. Buffered
+ * tuples are accounted for separately, since they are allocated elsewhere.
+ */
+void
+ts_chunk_insert_state_update_memory_size(ChunkInsertState *state, bool remeasure)
+{
+	if (remeasure)
+		state->mctx_size = memory_context_total_space(state->mctx);
+
+	state->memory_size = state->mctx_size + state->buffered_tuples_bytes;
+
+	if (NULL != state->store_entry)
+		ts_subspace_store_resize(state->dispatch->cache, state->store_entry, state->memory_size);
+}
+
+void
+_chunk_insert_state_init(void)
+{
+	RegisterXactCallback(chunk_insert_cache_xact_end, NULL);
+	RegisterSubXactCallback(chunk_insert_cache_subxact_end, NULL);
+	CacheRegisterRelcacheCallback(chunk_insert_cache_invalidate_callback, PointerGetDatum(NULL));
+}
+
+void
+_chunk_insert_state_fini(void)
+{
+	UnregisterXactCallback(chunk_insert_cache_xact_end, NULL);
+	UnregisterSubXactCallback(chunk_insert_cache_subxact_end, NULL);
+	/* No way to unregister relcache callback */
+}
@@ -10,12 +10,17 @@
 #include <nodes/execnodes.h>
 #include <postgres.h>
 #include <funcapi.h>
+#include <access/heapam.h>
 #include <access/tupconvert.h>
 
 #include "hypertable.h"
 #include "chunk.h"
 #include "cache.h"
 #include "chunk_dispatch_state.h"
+#include "subspace_store.h"
+
+typedef struct ChunkDispatch ChunkDispatch;
+typedef struct ChunkInsertCacheEntry ChunkInsertCacheEntry;
 
 typedef struct ChunkInsertState
 {
@@ -25,14 +30,42 @@ typedef struct ChunkInsertState
 	TupleConversionMap *tup_conv_map;
 	TupleTableSlot *slot;
 	MemoryContext mctx;
+	/*
+	 * Memory used by the state, i.e., the size of mctx when last measured
+	 * plus the size of the tuples buffered for the chunk
+	 */
+	Size		memory_size;
+	Size		mctx_size;
+	/* Copy of the chunk's hypercube, for fast point-in-chunk tests */
+	Hypercube  *cube;
+	/* Entry of the state in the dispatch's subspace store */
+	SubspaceStoreEntry *store_entry;
+
+	/*
+	 * Tuples buffered for a multi-insert into the chunk. Only used by COPY.
+	 * The tuples themselves are owned by the COPY state.
+	 */
+	HeapTuple  *buffered_tuples;
+	int			num_buffered_tuples;
+	int			buffered_tuples_size;	/* Allocated length of the buffer */
+	Size		buffered_tuples_bytes;
+	/* Bulk insert state used when writing to the chunk, created on demand */
+	BulkInsertState bistate;
+	/* heap_insert() options for writing to the chunk directly, as COPY does */
+	int			hi_options;
 
+	/* Transaction-scoped state shared with other inserts into the chunk */
+	ChunkInsertCacheEntry *cache_entry;
+
+	ChunkDispatch *dispatch;
 	EState	   *estate;
 } ChunkInsertState;
 
-typedef struct ChunkDispatch ChunkDispatch;
-
-extern HeapTuple ts_chunk_insert_state_convert_tuple(ChunkInsertState *state, HeapTuple tuple, TupleTableSlot **existing_slot);
+extern TupleConversionMap *ts_chunk_insert_state_tuple_conversion_map(TupleDesc hypertable_desc, TupleDesc chunk_desc);
+extern TupleTableSlot *ts_chunk_insert_state_convert_slot(ChunkInsertState *state, TupleTableSlot *slot);
 extern ChunkInsertState *ts_chunk_insert_state_create(Chunk *chunk, ChunkDispatch *dispatch);
 extern void ts_chunk_insert_state_destroy(ChunkInsertState *state);
+extern BulkInsertState ts_chunk_insert_state_get_bistate(ChunkInsertState *state);
+extern void ts_chunk_insert_state_update_memory_size(ChunkInsertState *state, bool remeasure);
 
 #endif							/* TIMESCALEDB_CHUNK_INSERT_STATE_H */
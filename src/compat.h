@@ -26,6 +26,28 @@
 #define TupleDescAttrCompat(tupdesc, i) TupleDescAttr(tupdesc, i)
 #endif
 
+/*
+ * The CatalogTuple functions were added in PG10. Callers need to include
+ * catalog/indexing.h.
+ */
+#if PG96
+#define CatalogTupleInsert(relation, tuple)		\
+	do {										\
+		simple_heap_insert(relation, tuple);	\
+		CatalogUpdateIndexes(relation, tuple);	\
+	} while (0);
+
+#define CatalogTupleUpdate(relation, tid, tuple)	\
+	do {											\
+		simple_heap_update(relation, tid, tuple);	\
+		CatalogUpdateIndexes(relation, tuple);		\
+	} while (0);
+
+#define CatalogTupleDelete(relation, tid)		\
+	simple_heap_delete(relation, tid);
+
+#endif							/* PG96 */
+
 #if PG10
 
 #define ExecARInsertTriggersCompat(estate, result_rel_info, tuple, recheck_indexes) \
@@ -17,24 +17,35 @@
 #include <access/hio.h>
 #include <access/xact.h>
 #include <commands/copy.h>
+#include <commands/defrem.h>
 #include <commands/trigger.h>
 #include <commands/tablecmds.h>
 #include <executor/executor.h>
 #include <miscadmin.h>
 #include <nodes/makefuncs.h>
+#include <optimizer/clauses.h>
+#include <optimizer/planner.h>
+#include <rewrite/rewriteHandler.h>
 #include <storage/bufmgr.h>
+#include <utils/array.h>
 #include <utils/builtins.h>
 #include <utils/guc.h>
 #include <utils/lsyscache.h>
 #include <utils/rel.h>
 #include <utils/rls.h>
+#include <utils/portal.h>
+#include <utils/snapmgr.h>
 
 #include "hypertable.h"
+#include "hypertable_cache.h"
 #include "copy.h"
 #include "dimension.h"
 #include "chunk_insert_state.h"
 #include "chunk_dispatch.h"
+#include "chunk_index.h"
+#include "guc.h"
 #include "subspace_store.h"
+#include "errors.h"
 #include "compat.h"
 
 /*
@@ -47,25 +58,53 @@
  *
  */
 
+/*
+ * Limits on the number of tuples and bytes buffered for multi-inserts across
+ * all chunks. Same as in PostgreSQL's copy.c. When grouping rows by chunk,
+ * up to work_mem of tuples are buffered instead.
+ */
+#define MAX_BUFFERED_TUPLES 1000
+#define MAX_BUFFERED_BYTES 65535
+
 typedef struct CopyChunkState CopyChunkState;
 
 typedef bool (*CopyFromFunc) (CopyChunkState *ccstate, ExprContext *econtext,
 							  Datum *values, bool *nulls, Oid *tuple_oid);
 
+typedef struct ArrayIngestState ArrayIngestState;
+
 typedef struct CopyChunkState
 {
 	Relation	rel;
 	EState	   *estate;
 	ChunkDispatch *dispatch;
 	CopyFromFunc next_copy_from;
+	/* Optional error context callback, called with the from context */
+	void		(*error_callback) (void *arg);
 	union
 	{
 		CopyState	cstate;
 		HeapScanDesc scandesc;
+		ArrayIngestState *arrays;
 		void	   *data;
 	}			fromctx;
+
+	/*
+	 * State for buffering tuples per chunk so that they can be written with
+	 * heap_multi_insert().
+	 */
+	bool		use_multi_insert;
+	MemoryContext buffer_mctx;	/* Holds the buffered tuples */
+	List	   *buffered_chunks;	/* Chunk insert states with buffered tuples */
+	int			num_buffered_tuples;
+	Size		buffered_bytes;
+	int			max_buffered_tuples;
+	Size		max_buffered_bytes;
+	TupleTableSlot *buffer_slot;
+	CommandId	mycid;
 } CopyChunkState;
 
+static void copy_chunk_insert_state_close(ChunkInsertState *cis, void *data);
 
 static CopyChunkState *
 copy_chunk_state_create(Hypertable *ht, Relation rel, CopyFromFunc from_func, void *fromctx)
@@ -73,12 +112,30 @@ copy_chunk_state_create(Hypertable *ht, Relation rel, CopyFromFunc from_func, vo
 	CopyChunkState *ccstate;
 	EState	   *estate = CreateExecutorState();
 
-	ccstate = palloc(sizeof(CopyChunkState));
+	ccstate = palloc0(sizeof(CopyChunkState));
 	ccstate->rel = rel;
 	ccstate->estate = estate;
 	ccstate->dispatch = ts_chunk_dispatch_create(ht, estate);
+	ccstate->dispatch->on_chunk_insert_state_close = copy_chunk_insert_state_close;
+	ccstate->dispatch->on_chunk_insert_state_close_data = ccstate;
 	ccstate->fromctx.data = fromctx;
 	ccstate->next_copy_from = from_func;
+	ccstate->use_multi_insert = true;
+
+	if (ts_guc_group_rows_by_chunk)
+	{
+		ccstate->max_buffered_tuples = INT_MAX;
+		ccstate->max_buffered_bytes = work_mem * 1024L;
+	}
+	else
+	{
+		ccstate->max_buffered_tuples = MAX_BUFFERED_TUPLES;
+		ccstate->max_buffered_bytes = MAX_BUFFERED_BYTES;
+	}
+
+	ccstate->buffer_mctx = AllocSetContextCreate(CurrentMemoryContext,
+												 "COPY multi-insert buffer",
+												 ALLOCSET_DEFAULT_SIZES);
 
 	return ccstate;
 }
@@ -88,6 +145,203 @@ copy_chunk_state_destroy(CopyChunkState *ccstate)
 {
 	ts_chunk_dispatch_destroy(ccstate->dispatch);
 	FreeExecutorState(ccstate->estate);
+	MemoryContextDelete(ccstate->buffer_mctx);
+}
+
+/*
+ * Write the tuples buffered for a chunk using heap_multi_insert() and then
+ * insert the corresponding index entries and fire AFTER ROW triggers. This is
+ * what PostgreSQL's CopyFromInsertBatch() does for plain tables.
+ */
+static void
+copy_flush_chunk_buffer(CopyChunkState *ccstate, ChunkInsertState *cis)
+{
+	EState	   *estate = ccstate->estate;
+	ResultRelInfo *saved_resultRelInfo = estate->es_result_relation_info;
+	ResultRelInfo *resultRelInfo = cis->result_relation_info;
+	MemoryContext oldcontext;
+	int			i;
+
+	if (cis->num_buffered_tuples == 0)
+		return;
+
+	estate->es_result_relation_info = resultRelInfo;
+
+	/*
+	 * heap_multi_insert leaks memory, so switch to short-lived memory context
+	 * before calling it.
+	 */
+	oldcontext = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+	heap_multi_insert(resultRelInfo->ri_RelationDesc,
+					  cis->buffered_tuples,
+					  cis->num_buffered_tuples,
+					  ccstate->mycid,
+					  cis->hi_options,
+					  ts_chunk_insert_state_get_bistate(cis));
+	MemoryContextSwitchTo(oldcontext);
+
+	/*
+	 * Insert index entries for the whole batch and fire AFTER ROW triggers.
+	 */
+	if (resultRelInfo->ri_NumIndices > 0 || resultRelInfo->ri_TrigDesc != NULL)
+	{
+		TupleTableSlot *slot = ccstate->buffer_slot;
+
+		ExecSetSlotDescriptor(slot, RelationGetDescr(resultRelInfo->ri_RelationDesc));
+
+		for (i = 0; i < cis->num_buffered_tuples; i++)
+		{
+			HeapTuple	tuple = cis->buffered_tuples[i];
+			List	   *recheckIndexes = NIL;
+
+			if (resultRelInfo->ri_NumIndices > 0)
+			{
+				ExecStoreTuple(tuple, slot, InvalidBuffer, false);
+				recheckIndexes = ExecInsertIndexTuples(slot, &(tuple->t_self),
+													   estate, false, NULL,
+													   NIL);
+			}
+
+			ExecARInsertTriggersCompat(estate, resultRelInfo, tuple, recheckIndexes);
+			list_free(recheckIndexes);
+		}
+
+		ExecClearTuple(slot);
+	}
+
+	cis->num_buffered_tuples = 0;
+	cis->buffered_tuples_bytes = 0;
+	ts_chunk_insert_state_update_memory_size(cis, false);
+	estate->es_result_relation_info = saved_resultRelInfo;
+}
+
+/*
+ * Flush the buffers of all chunks and release the memory of the buffered
+ * tuples.
+ */
+static void
+copy_flush_buffers(CopyChunkState *ccstate)
+{
+	ListCell   *lc;
+
+	if (ccstate->num_buffered_tuples == 0)
+		return;
+
+	foreach(lc, ccstate->buffered_chunks)
+		copy_flush_chunk_buffer(ccstate, lfirst(lc));
+
+	/* The list is allocated on the buffer memory context */
+	ccstate->buffered_chunks = NIL;
+	ccstate->num_buffered_tuples = 0;
+	ccstate->buffered_bytes = 0;
+	MemoryContextReset(ccstate->buffer_mctx);
+}
+
+/*
+ * Add a tuple to the chunk's multi-insert buffer. All buffers are flushed when
+ * the total number of buffered tuples or bytes exceeds the limits.
+ */
+static void
+copy_buffer_tuple(CopyChunkState *ccstate, ChunkInsertState *cis, HeapTuple tuple)
+{
+	MemoryContext oldcontext;
+	bool		remeasure = false;
+
+	if (NULL == cis->buffered_tuples)
+	{
+		cis->buffered_tuples_size = MAX_BUFFERED_TUPLES;
+		cis->buffered_tuples = MemoryContextAlloc(cis->mctx, sizeof(HeapTuple) * cis->buffered_tuples_size);
+		remeasure = true;
+	}
+	else if (cis->num_buffered_tuples >= cis->buffered_tuples_size)
+	{
+		cis->buffered_tuples_size *= 2;
+		cis->buffered_tuples = repalloc_huge(cis->buffered_tuples, sizeof(HeapTuple) * cis->buffered_tuples_size);
+		remeasure = true;
+	}
+
+	oldcontext = MemoryContextSwitchTo(ccstate->buffer_mctx);
+
+	if (cis->num_buffered_tuples == 0)
+		ccstate->buffered_chunks = lappend(ccstate->buffered_chunks, cis);
+
+	cis->buffered_tuples[cis->num_buffered_tuples++] = heap_copytuple(tuple);
+	MemoryContextSwitchTo(oldcontext);
+
+	ccstate->num_buffered_tuples++;
+	ccstate->buffered_bytes += tuple->t_len;
+
+	/* Count the buffered tuples towards the chunk's memory when open */
+	cis->buffered_tuples_bytes += HEAPTUPLESIZE + tuple->t_len;
+	ts_chunk_insert_state_update_memory_size(cis, remeasure);
+
+	if (ccstate->num_buffered_tuples >= ccstate->max_buffered_tuples ||
+		ccstate->buffered_bytes >= ccstate->max_buffered_bytes)
+		copy_flush_buffers(ccstate);
+}
+
+/*
+ * Called when a chunk insert state is about to be closed (e.g., evicted from
+ * the chunk dispatch cache). Any buffered tuples need to be written before the
+ * chunk's relation and indexes are closed.
+ */
+static void
+copy_chunk_insert_state_close(ChunkInsertState *cis, void *data)
+{
+	CopyChunkState *ccstate = data;
+
+	if (cis->num_buffered_tuples > 0)
+		copy_flush_buffers(ccstate);
+
+	/*
+	 * If we skipped writing WAL, then we need to sync the chunk (but not
+	 * indexes since those use WAL anyway)
+	 */
+	if (cis->hi_options & HEAP_INSERT_SKIP_WAL)
+		heap_sync(cis->rel);
+}
+
+/*
+ * Check whether tuples for the given chunk can be buffered for a
+ * multi-insert. Like PostgreSQL's COPY, we cannot buffer tuples if the chunk has
+ * BEFORE or INSTEAD OF ROW triggers since they might query the table.
+ */
+static inline bool
+copy_use_multi_insert(CopyChunkState *ccstate, ResultRelInfo *resultRelInfo)
+{
+	return ccstate->use_multi_insert &&
+		!(resultRelInfo->ri_TrigDesc != NULL &&
+		  (resultRelInfo->ri_TrigDesc->trig_insert_before_row ||
+		   resultRelInfo->ri_TrigDesc->trig_insert_instead_row));
+}
+
+/*
+ * Check if any of the columns not given in the COPY have volatile default
+ * expressions. Such expressions might query the table, so multi-inserts
+ * cannot be used (they'd see an inconsistent state).
+ */
+static bool
+copy_has_volatile_defaults(Relation rel, List *attnums)
+{
+	TupleDesc	tupDesc = RelationGetDescr(rel);
+	int			i;
+
+	for (i = 0; i < tupDesc->natts; i++)
+	{
+		Expr	   *defexpr;
+
+		if (tupDesc->attrs[i]->attisdropped ||
+			list_member_int(attnums, tupDesc->attrs[i]->attnum))
+			continue;
+
+		defexpr = (Expr *) build_column_default(rel, tupDesc->attrs[i]->attnum);
+
+		if (defexpr != NULL &&
+			contain_volatile_functions_not_nextval((Node *) expression_planner(defexpr)))
+			return true;
+	}
+
+	return false;
 }
 
 static bool
@@ -108,17 +362,13 @@ timescaledb_CopyFrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht)
 	Datum	   *values;
 	bool	   *nulls;
 	ResultRelInfo *resultRelInfo;
-	ResultRelInfo *saved_resultRelInfo = NULL;
 	EState	   *estate = ccstate->estate;	/* for ExecConstraints() */
 	ExprContext *econtext;
 	TupleTableSlot *myslot;
 	MemoryContext oldcontext = CurrentMemoryContext;
-	ChunkInsertState *prev_cis = NULL;
 
 	ErrorContextCallback errcallback;
 	CommandId	mycid = GetCurrentCommandId(true);
-	int			hi_options = 0; /* start with default heap_insert options */
-	BulkInsertState bistate;
 	uint64		processed = 0;
 
 	if (ccstate->rel->rd_rel->relkind != RELKIND_RELATION)
@@ -152,49 +402,20 @@ timescaledb_CopyFrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht)
 
 	tupDesc = RelationGetDescr(ccstate->rel);
 
-	/*----------
-	 * Check to see if we can avoid writing WAL
-	 *
-	 * If archive logging/streaming is not enabled *and* either
-	 *	- table was created in same transaction as this COPY
-	 *	- data is being written to relfilenode created in this transaction
-	 * then we can skip writing WAL.  It's safe because if the transaction
-	 * doesn't commit, we'll discard the table (or the new relfilenode file).
-	 * If it does commit, we'll have done the heap_sync at the bottom of this
-	 * routine first.
-	 *
-	 * As mentioned in comments in utils/rel.h, the in-same-transaction test
-	 * is not always set correctly, since in rare cases rd_newRelfilenodeSubid
-	 * can be cleared before the end of the transaction. The exact case is
-	 * when a relation sets a new relfilenode twice in same transaction, yet
-	 * the second one fails in an aborted subtransaction, e.g.
-	 *
-	 * BEGIN;
-	 * TRUNCATE t;
-	 * SAVEPOINT save;
-	 * TRUNCATE t;
-	 * ROLLBACK TO save;
-	 * COPY ...
-	 *
-	 * Also, if the target file is new-in-transaction, we assume that checking
-	 * FSM for free space is a waste of time, even if we must use WAL because
-	 * of archiving.  This could possibly be wrong, but it's unlikely.
-	 *
-	 * The comments for heap_insert and RelationGetBufferForTuple specify that
-	 * skipping WAL logging is only safe if we ensure that our tuples do not
-	 * go into pages containing tuples from any other transactions --- but this
-	 * must be the case if we have a new table or new relfilenode, so we need
-	 * no additional work to enforce that.
-	 *----------
+	/*
+	 * We never write to the hypertable's root table, so whether WAL and FSM
+	 * lookups can be skipped, or tuples frozen, is decided per chunk (see
+	 * ChunkInsertState). Like PostgreSQL, refuse FREEZE if the transaction
+	 * has done something that could let it see the frozen tuples too early.
+	 * Unlike for a plain table, chunks that were not created or truncated in
+	 * the current subtransaction are just not frozen, since a COPY usually
+	 * touches both new and existing chunks.
 	 */
-	/* createSubid is creation check, newRelfilenodeSubid is truncation check */
-	if (ccstate->rel->rd_createSubid != InvalidSubTransactionId ||
-		ccstate->rel->rd_newRelfilenodeSubid != InvalidSubTransactionId)
-	{
-		hi_options |= HEAP_INSERT_SKIP_FSM;
-		if (!XLogIsNeeded())
-			hi_options |= HEAP_INSERT_SKIP_WAL;
-	}
+	if (ccstate->dispatch->freeze &&
+		(!ThereAreNoPriorRegisteredSnapshots() || !ThereAreNoReadyPortals()))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_TRANSACTION_STATE),
+				 errmsg("cannot perform FREEZE because of prior transaction activity")));
 
 	/*
 	 * We need a ResultRelInfo so we can use the regular executor's
@@ -220,6 +441,9 @@ timescaledb_CopyFrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht)
 	ExecSetSlotDescriptor(myslot, tupDesc);
 	/* Triggers might need a slot as well */
 	estate->es_trig_tuple_slot = ExecInitExtraTupleSlot(estate);
+	/* Slot used when inserting index entries for buffered tuples */
+	ccstate->buffer_slot = ExecInitExtraTupleSlot(estate);
+	ccstate->mycid = mycid;
 
 	/* Prepare to catch AFTER triggers. */
 	AfterTriggerBeginQuery();
@@ -232,17 +456,18 @@ timescaledb_CopyFrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht)
 	 */
 	ExecBSInsertTriggers(estate, resultRelInfo);
 
-	values = (Datum *) palloc(tupDesc->natts * sizeof(Datum));
-	nulls = (bool *) palloc(tupDesc->natts * sizeof(bool));
-
-	bistate = GetBulkInsertState();
-	econtext = GetPerTupleExprContext(estate);
+	/* Values are read directly into the slot */
+	values = myslot->tts_values;
+	nulls = myslot->tts_isnull;
 
 	/* Set up callback to identify error line number */
-	errcallback.callback = CopyFromErrorCallback;
-	errcallback.arg = (void *) ccstate->fromctx.cstate;
-	errcallback.previous = error_context_stack;
-	error_context_stack = &errcallback;
+	if (NULL != ccstate->error_callback)
+	{
+		errcallback.callback = ccstate->error_callback;
+		errcallback.arg = ccstate->fromctx.data;
+		errcallback.previous = error_context_stack;
+		error_context_stack = &errcallback;
+	}
 
 	for (;;)
 	{
@@ -255,23 +480,31 @@ timescaledb_CopyFrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht)
 
 		CHECK_FOR_INTERRUPTS();
 
+		ExecClearTuple(myslot);
+
 		/* Reset the per-tuple exprcontext */
 		ResetPerTupleExprContext(estate);
 
+		/*
+		 * Get the per-tuple exprcontext anew for every tuple since closing a
+		 * chunk insert state frees it
+		 */
+		econtext = GetPerTupleExprContext(estate);
+
 		/* Switch into its memory context */
 		MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
 
 		if (!ccstate->next_copy_from(ccstate, econtext, values, nulls, &loaded_oid))
 			break;
 
-		/* And now we can form the input tuple. */
-		tuple = heap_form_tuple(tupDesc, values, nulls);
-
-		if (loaded_oid != InvalidOid)
-			HeapTupleSetOid(tuple, loaded_oid);
+		/*
+		 * Store the values as a virtual tuple. The tuple is only formed once
+		 * it is routed, in the rowtype of its chunk.
+		 */
+		slot = ExecStoreVirtualTuple(myslot);
 
 		/* Calculate the tuple's point in the N-dimensional hyperspace */
-		point = ts_hyperspace_calculate_point(ht->space, tuple, tupDesc);
+		point = ts_hyperspace_calculate_point(ht->space, slot);
 
 		/* Save the main table's (hypertable's) ResultRelInfo */
 		if (NULL == dispatch->hypertable_result_rel_info)
@@ -282,33 +515,23 @@ timescaledb_CopyFrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht)
 
 		Assert(cis != NULL);
 
-		if (cis != prev_cis)
-		{
-			/* Different chunk so must release BulkInsertState */
-			if (bistate->current_buf != InvalidBuffer)
-				ReleaseBuffer(bistate->current_buf);
-			bistate->current_buf = InvalidBuffer;
-		}
-
 		/* Triggers and stuff need to be invoked in query context. */
 		MemoryContextSwitchTo(oldcontext);
 
-		/* Place tuple in tuple slot --- but slot shouldn't free it */
-		slot = myslot;
-		ExecStoreTuple(tuple, slot, InvalidBuffer, false);
+		/* Form the tuple in the chunk's rowtype */
+		slot = ts_chunk_insert_state_convert_slot(cis, slot);
+		tuple = ExecMaterializeSlot(slot);
 
-		/* Convert the tuple to match the chunk's rowtype */
-		tuple = ts_chunk_insert_state_convert_tuple(cis, tuple, &slot);
+		if (loaded_oid != InvalidOid)
+			HeapTupleSetOid(tuple, loaded_oid);
 
 		/*
 		 * Set the result relation in the executor state to the target chunk.
 		 * This makes sure that the tuple gets inserted into the correct
 		 * chunk.
 		 */
-		saved_resultRelInfo = resultRelInfo;
 		resultRelInfo = cis->result_relation_info;
 		estate->es_result_relation_info = resultRelInfo;
-		prev_cis = cis;
 
 		/*
 		 * Constraints might reference the tableoid column, so initialize
@@ -336,12 +559,22 @@ timescaledb_CopyFrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht)
 			if (ccstate->rel->rd_att->constr)
 				ExecConstraints(resultRelInfo, slot, estate);
 
+			if (copy_use_multi_insert(ccstate, resultRelInfo))
+			{
+				/*
+				 * Add this tuple to the chunk's buffer. Index entries are
+				 * created and AFTER ROW triggers fired when the buffer is
+				 * flushed.
+				 */
+				copy_buffer_tuple(ccstate, cis, tuple);
+			}
+			else
 			{
 				List	   *recheckIndexes = NIL;
 
 				/* OK, store the tuple and create index entries for it */
 				heap_insert(resultRelInfo->ri_RelationDesc, tuple, mycid,
-							hi_options, bistate);
+							cis->hi_options, ts_chunk_insert_state_get_bistate(cis));
 
 				if (resultRelInfo->ri_NumIndices > 0)
 					recheckIndexes = ExecInsertIndexTuples(slot, &(tuple->t_self),
@@ -360,18 +593,19 @@ timescaledb_CopyFrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht)
 			 * tuples inserted by an INSERT command.
 			 */
 			processed++;
-
-			if (saved_resultRelInfo)
-			{
-				resultRelInfo = saved_resultRelInfo;
-				estate->es_result_relation_info = resultRelInfo;
-			}
 		}
+
+		/* Restore the main table's (hypertable's) ResultRelInfo */
+		resultRelInfo = dispatch->hypertable_result_rel_info;
+		estate->es_result_relation_info = resultRelInfo;
 	}
-	/* Done, clean up */
-	error_context_stack = errcallback.previous;
 
-	FreeBulkInsertState(bistate);
+	/* Write any remaining buffered tuples */
+	copy_flush_buffers(ccstate);
+
+	/* Done, clean up */
+	if (NULL != ccstate->error_callback)
+		error_context_stack = errcallback.previous;
 
 	MemoryContextSwitchTo(oldcontext);
 
@@ -384,9 +618,6 @@ timescaledb_CopyFrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht)
 	/* Handle queued AFTER triggers */
 	AfterTriggerEndQuery(estate);
 
-	pfree(values);
-	pfree(nulls);
-
 	ExecResetTupleTable(estate->es_tupleTable, false);
 
 	ExecCloseIndices(resultRelInfo);
@@ -417,13 +648,6 @@ timescaledb_CopyFrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht)
 
 	copy_chunk_state_destroy(ccstate);
 
-	/*
-	 * If we skipped writing WAL, then we need to sync the heap (but not
-	 * indexes since those use WAL anyway)
-	 */
-	if (hi_options & HEAP_INSERT_SKIP_WAL)
-		heap_sync(ccstate->rel);
-
 	return processed;
 }
 
@@ -559,6 +783,26 @@ copy_security_check(Relation rel, List *attnums)
 	PreventCommandIfParallelMode("COPY FROM");
 }
 
+/*
+ * Check for the FREEZE option. The option list is validated by
+ * BeginCopyFrom(), but the resulting state is private to PostgreSQL.
+ */
+static bool
+copy_freeze_requested(List *options)
+{
+	ListCell   *lc;
+
+	foreach(lc, options)
+	{
+		DefElem    *defel = lfirst(lc);
+
+		if (strcmp(defel->defname, "freeze") == 0)
+			return defGetBoolean(defel);
+	}
+
+	return false;
+}
+
 void
 timescaledb_DoCopy(const CopyStmt *stmt, const char *queryString, uint64 *processed, Hypertable *ht)
 {
@@ -616,6 +860,9 @@ timescaledb_DoCopy(const CopyStmt *stmt, const char *queryString, uint64 *proces
 
 #endif
 	ccstate = copy_chunk_state_create(ht, rel, next_copy_from, cstate);
+	ccstate->error_callback = CopyFromErrorCallback;
+	ccstate->use_multi_insert = !copy_has_volatile_defaults(rel, attnums);
+	ccstate->dispatch->freeze = copy_freeze_requested(stmt->options);
 
 	*processed = timescaledb_CopyFrom(ccstate, range_table, ht);
 	EndCopyFrom(cstate);
@@ -680,6 +927,14 @@ timescaledb_move_from_table_to_chunks(Hypertable *ht, LOCKMODE lockmode)
 	snapshot = RegisterSnapshot(GetLatestSnapshot());
 	scandesc = heap_beginscan(rel, snapshot, 0, NULL);
 	ccstate = copy_chunk_state_create(ht, rel, next_copy_from_table_to_chunks, scandesc);
+
+	/*
+	 * Every chunk is created by the move, so build their indexes once all
+	 * data is in place instead of inserting into them row by row
+	 */
+	if (!ccstate->dispatch->bulk_load)
+		ccstate->dispatch->bulk_load = ts_chunk_index_bulk_load_begin(true);
+
 	timescaledb_CopyFrom(ccstate, range_table, ht);
 	heap_endscan(scandesc);
 	UnregisterSnapshot(snapshot);
@@ -687,3 +942,177 @@ timescaledb_move_from_table_to_chunks(Hypertable *ht, LOCKMODE lockmode)
 
 	ExecuteTruncate(&stmt);
 }
+
+/*
+ * Rows given as one array per column, as taken by ingest().
+ */
+typedef struct ArrayIngestState
+{
+	int			num_columns;
+	int			num_rows;
+	int			row;
+	/* Array elements per column, NULL for dropped columns */
+	Datum	  **values;
+	bool	  **nulls;
+} ArrayIngestState;
+
+static bool
+next_copy_from_arrays(CopyChunkState *ccstate, ExprContext *econtext,
+					  Datum *values, bool *nulls, Oid *tuple_oid)
+{
+	ArrayIngestState *ais = ccstate->fromctx.arrays;
+	int			i;
+
+	if (ais->row >= ais->num_rows)
+		return false;
+
+	for (i = 0; i < ais->num_columns; i++)
+	{
+		if (NULL == ais->values[i])
+		{
+			values[i] = (Datum) 0;
+			nulls[i] = true;
+		}
+		else
+		{
+			values[i] = ais->values[i][ais->row];
+			nulls[i] = ais->nulls[i][ais->row];
+		}
+	}
+
+	ais->row++;
+
+	return true;
+}
+
+static void
+ingest_error_callback(void *arg)
+{
+	ArrayIngestState *ais = arg;
+
+	errcontext("ingest, row %d", ais->row);
+}
+
+TS_FUNCTION_INFO_V1(ts_copy_ingest_arrays);
+
+/*
+ * Insert rows given as one array per column into a hypertable.
+ *
+ * The arrays are taken in the order of the hypertable's columns and are
+ * routed to chunks like the rows of a COPY, so that tuples are buffered and
+ * written with a multi-insert per chunk instead of going through the
+ * executor one row at a time.
+ */
+Datum
+ts_copy_ingest_arrays(PG_FUNCTION_ARGS)
+{
+	Oid			table_relid = PG_ARGISNULL(0) ? InvalidOid : PG_GETARG_OID(0);
+	int			num_arrays = PG_NARGS() - 1;
+	Cache	   *hcache;
+	Hypertable *ht;
+	Relation	rel;
+	TupleDesc	tupdesc;
+	List	   *attnums;
+	ListCell   *lc;
+	ArrayIngestState *ais;
+	CopyChunkState *ccstate;
+	uint64		processed;
+	int			argno = 1;
+
+	if (!OidIsValid(table_relid))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid hypertable")));
+
+	if (get_fn_expr_variadic(fcinfo->flinfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("column arrays must be given as separate arguments")));
+
+	hcache = ts_hypertable_cache_pin();
+	ht = ts_hypertable_cache_get_entry(hcache, table_relid);
+
+	if (NULL == ht)
+		ereport(ERROR,
+				(errcode(ERRCODE_TS_HYPERTABLE_NOT_EXIST),
+				 errmsg("table \"%s\" is not a hypertable",
+						get_rel_name(table_relid))));
+
+	/*
+	 * We never actually write to the main table, but we need RowExclusiveLock
+	 * to ensure no one else is
+	 */
+	rel = heap_open(table_relid, RowExclusiveLock);
+	tupdesc = RelationGetDescr(rel);
+	attnums = timescaledb_CopyGetAttnums(tupdesc, rel, NIL);
+
+	if (list_length(attnums) != num_arrays)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("expected %d arrays for the columns of \"%s\", got %d",
+						list_length(attnums), RelationGetRelationName(rel),
+						num_arrays)));
+
+	copy_security_check(rel, attnums);
+
+	ais = palloc0(sizeof(ArrayIngestState));
+	ais->num_columns = tupdesc->natts;
+	ais->values = palloc0(sizeof(Datum *) * tupdesc->natts);
+	ais->nulls = palloc0(sizeof(bool *) * tupdesc->natts);
+
+	foreach(lc, attnums)
+	{
+		Form_pg_attribute attr = tupdesc->attrs[lfirst_int(lc) - 1];
+		Oid			argtype = get_fn_expr_argtype(fcinfo->flinfo, argno);
+		ArrayType  *arr;
+		int16		typlen;
+		bool		typbyval;
+		char		typalign;
+		int			num_elems;
+
+		if (PG_ARGISNULL(argno))
+			ereport(ERROR,
+					(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+					 errmsg("array for column \"%s\" cannot be NULL",
+							NameStr(attr->attname))));
+
+		if (get_element_type(argtype) != attr->atttypid)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATATYPE_MISMATCH),
+					 errmsg("array for column \"%s\" must be of type %s",
+							NameStr(attr->attname),
+							format_type_be(get_array_type(attr->atttypid)))));
+
+		arr = PG_GETARG_ARRAYTYPE_P(argno);
+
+		if (ARR_NDIM(arr) > 1)
+			ereport(ERROR,
+					(errcode(ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+					 errmsg("array for column \"%s\" must be one-dimensional",
+							NameStr(attr->attname))));
+
+		get_typlenbyvalalign(attr->atttypid, &typlen, &typbyval, &typalign);
+		deconstruct_array(arr, attr->atttypid, typlen, typbyval, typalign,
+						  &ais->values[attr->attnum - 1],
+						  &ais->nulls[attr->attnum - 1],
+						  &num_elems);
+
+		if (argno == 1)
+			ais->num_rows = num_elems;
+		else if (num_elems != ais->num_rows)
+			ereport(ERROR,
+					(errcode(ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+					 errmsg("arrays must all have the same length")));
+
+		argno++;
+	}
+
+	ccstate = copy_chunk_state_create(ht, rel, next_copy_from_arrays, ais);
+	ccstate->error_callback = ingest_error_callback;
+	processed = timescaledb_CopyFrom(ccstate, NIL, ht);
+
+	heap_close(rel, NoLock);
+	ts_cache_release(hcache);
+
+	PG_RETURN_INT64(processed);
+}
@@ -12,6 +12,7 @@
 #include <utils/syscache.h>
 #include <utils/builtins.h>
 #include <utils/timestamp.h>
+#include <utils/date.h>
 #include <funcapi.h>
 #include <miscadmin.h>
 
@@ -19,6 +20,7 @@
 #include "compat.h"
 #include "dimension.h"
 #include "dimension_slice.h"
+#include "dimension_slice_index.h"
 #include "hypertable.h"
 #include "indexing.h"
 #include "hypertable_cache.h"
@@ -112,6 +114,101 @@ dimension_type(HeapTuple tuple)
 	return DIMENSION_TYPE_CLOSED;
 }
 
+static int64
+coordinate_from_int2(Dimension *dim, Datum value)
+{
+	return (int64) DatumGetInt16(value);
+}
+
+static int64
+coordinate_from_int4(Dimension *dim, Datum value)
+{
+	return (int64) DatumGetInt32(value);
+}
+
+static int64
+coordinate_from_int8(Dimension *dim, Datum value)
+{
+	return DatumGetInt64(value);
+}
+
+static int64
+coordinate_from_timestamp(Dimension *dim, Datum value)
+{
+	/* Timestamps without time zone are treated as if they were at UTC */
+	return ts_timestamp_to_unix_microseconds(DatumGetTimestampTz(value));
+}
+
+static int64
+coordinate_from_date(Dimension *dim, Datum value)
+{
+	Datum		ts = DirectFunctionCall1(date_timestamp, value);
+
+	return ts_timestamp_to_unix_microseconds(DatumGetTimestamp(ts));
+}
+
+static int64
+coordinate_from_time_value(Dimension *dim, Datum value)
+{
+	return ts_time_value_to_internal(value, dim->fd.column_type, false);
+}
+
+static int64
+coordinate_from_partition_hash(Dimension *dim, Datum value)
+{
+	return ts_partitioning_func_apply_hash(dim->partitioning, value);
+}
+
+static int64
+coordinate_from_partitioning_func(Dimension *dim, Datum value)
+{
+	return ts_partitioning_func_apply(dim->partitioning, value);
+}
+
+/*
+ * Set the function that maps column values to coordinates. It is specialized
+ * on the column type, or the partitioning function, so that calculating a
+ * tuple's point needs no type dispatch.
+ */
+static void
+dimension_set_coordinate_func(Dimension *d)
+{
+	if (IS_CLOSED_DIMENSION(d))
+	{
+		if (NULL != d->partitioning && NULL != d->partitioning->partfunc.hash_fmgr)
+			d->coordinate_func = coordinate_from_partition_hash;
+		else
+			d->coordinate_func = coordinate_from_partitioning_func;
+		return;
+	}
+
+	switch (d->fd.column_type)
+	{
+		case INT2OID:
+			d->coordinate_func = coordinate_from_int2;
+			break;
+		case INT4OID:
+			d->coordinate_func = coordinate_from_int4;
+			break;
+		case INT8OID:
+			d->coordinate_func = coordinate_from_int8;
+			break;
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			d->coordinate_func = coordinate_from_timestamp;
+			break;
+		case DATEOID:
+			d->coordinate_func = coordinate_from_date;
+			break;
+		default:
+			if (ts_type_is_int8_binary_compatible(d->fd.column_type))
+				d->coordinate_func = coordinate_from_int8;
+			else
+				d->coordinate_func = coordinate_from_time_value;
+			break;
+	}
+}
+
 static void
 dimension_fill_in_from_tuple(Dimension *d, TupleInfo *ti, Oid main_table_relid)
 {
@@ -156,6 +253,7 @@ dimension_fill_in_from_tuple(Dimension *d, TupleInfo *ti, Oid main_table_relid)
 		d->fd.interval_length = DatumGetInt64(values[AttrNumberGetAttrOffset(Anum_dimension_interval_length)]);
 
 	d->column_attno = get_attnum(main_table_relid, NameStr(d->fd.column_name));
+	dimension_set_coordinate_func(d);
 }
 
 static Datum
@@ -349,6 +447,7 @@ ts_dimension_scan(int32 hypertable_id, Oid main_table_relid, int16 num_dimension
 {
 	Hyperspace *space = hyperspace_create(hypertable_id, main_table_relid, num_dimensions, mctx);
 	ScanKeyData scankey[1];
+	int			i;
 
 	/* Perform an index scan on hypertable_id. */
 	ScanKeyInit(&scankey[0], Anum_dimension_hypertable_id_column_name_idx_hypertable_id,
@@ -366,6 +465,9 @@ ts_dimension_scan(int32 hypertable_id, Oid main_table_relid, int16 num_dimension
 	/* Sort dimensions in ascending order to allow binary search lookups */
 	qsort(space->dimensions, space->num_dimensions, sizeof(Dimension), cmp_dimension_id);
 
+	for (i = 0; i < space->num_dimensions; i++)
+		space->dimensions[i].slice_index = ts_dimension_slice_index_create(mctx);
+
 	return space;
 }
 
@@ -588,6 +690,7 @@ ts_dimension_set_type(Dimension *dim, Oid newtype)
 			);
 
 	dim->fd.column_type = newtype;
+	dimension_set_coordinate_func(dim);
 
 	return dimension_scan_update(dim->fd.id, dimension_tuple_update, dim, RowExclusiveLock);
 }
@@ -619,8 +722,16 @@ point_create(int16 num_dimensions)
 	return p;
 }
 
+/*
+ * Calculate the point of a tuple in the hyperspace.
+ *
+ * The values are read directly from the slot, so a virtual slot need not be
+ * materialized into a heap tuple first, and the slot is only deformed up to
+ * the highest partitioning column. Values are mapped to coordinates using
+ * each dimension's specialized coordinate function.
+ */
 Point *
-ts_hyperspace_calculate_point(Hyperspace *hs, HeapTuple tuple, TupleDesc tupdesc)
+ts_hyperspace_calculate_point(Hyperspace *hs, TupleTableSlot *slot)
 {
 	Point	   *p = point_create(hs->num_dimensions);
 	int			i;
@@ -628,31 +739,89 @@ ts_hyperspace_calculate_point(Hyperspace *hs, HeapTuple tuple, TupleDesc tupdesc
 	for (i = 0; i < hs->num_dimensions; i++)
 	{
 		Dimension  *d = &hs->dimensions[i];
+		Datum		datum;
+		bool		isnull;
 
-		if (IS_OPEN_DIMENSION(d))
-		{
-			Datum		datum;
-			bool		isnull;
-
-			datum = heap_getattr(tuple, d->column_attno, tupdesc, &isnull);
+		datum = slot_getattr(slot, d->column_attno, &isnull);
 
-			if (isnull)
+		if (isnull)
+		{
+			if (IS_OPEN_DIMENSION(d))
 				ereport(ERROR,
 						(errcode(ERRCODE_NOT_NULL_VIOLATION),
 						 errmsg("NULL value in column \"%s\" violates not-null constraint",
 								NameStr(d->fd.column_name)),
 						 errhint("Columns used for time partitioning cannot be NULL")));
 
-			p->coordinates[p->num_coords++] = ts_time_value_to_internal(datum, d->fd.column_type, false);
+			/* NULL values in closed dimensions map to the first partition */
+			p->coordinates[p->num_coords++] = 0;
 		}
 		else
+			p->coordinates[p->num_coords++] = d->coordinate_func(d, datum);
+	}
+
+	return p;
+}
+
+/*
+ * Calculate the points of a batch of tuples in the hyperspace.
+ *
+ * Gives the same points as ts_hyperspace_calculate_point() for each tuple, but
+ * goes through the batch one dimension at a time, so that the values of a
+ * closed dimension are partitioned with a single call.
+ */
+void
+ts_hyperspace_calculate_points(Hyperspace *hs, TupleDesc desc, HeapTuple *tuples,
+							   int ntuples, Point **points)
+{
+	Datum	   *values = palloc(sizeof(Datum) * ntuples);
+	bool	   *isnull = palloc(sizeof(bool) * ntuples);
+	int32	   *partitions = NULL;
+	int			i,
+				j;
+
+	for (j = 0; j < ntuples; j++)
+		points[j] = point_create(hs->num_dimensions);
+
+	for (i = 0; i < hs->num_dimensions; i++)
+	{
+		Dimension  *d = &hs->dimensions[i];
+
+		for (j = 0; j < ntuples; j++)
+			values[j] = heap_getattr(tuples[j], d->column_attno, desc, &isnull[j]);
+
+		if (IS_CLOSED_DIMENSION(d))
 		{
-			p->coordinates[p->num_coords++] =
-				ts_partitioning_func_apply_tuple(d->partitioning, tuple, tupdesc);
+			/* NULL values in closed dimensions map to the first partition */
+			if (NULL == partitions)
+				partitions = palloc(sizeof(int32) * ntuples);
+
+			ts_partitioning_func_apply_batch(d->partitioning, values, isnull, ntuples, partitions);
+
+			for (j = 0; j < ntuples; j++)
+				points[j]->coordinates[points[j]->num_coords++] = partitions[j];
+
+			continue;
+		}
+
+		for (j = 0; j < ntuples; j++)
+		{
+			if (isnull[j])
+				ereport(ERROR,
+						(errcode(ERRCODE_NOT_NULL_VIOLATION),
+						 errmsg("NULL value in column \"%s\" violates not-null constraint",
+								NameStr(d->fd.column_name)),
+						 errhint("Columns used for time partitioning cannot be NULL")));
+
+			points[j]->coordinates[points[j]->num_coords++] = d->coordinate_func(d, values[j]);
 		}
 	}
 
-	return p;
+	if (NULL != partitions)
+		pfree(partitions);
+
+	pfree(values);
+	pfree(isnull);
 }
 
 static inline int64
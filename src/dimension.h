@@ -10,6 +10,7 @@
 #include <postgres.h>
 #include <access/attnum.h>
 #include <access/htup_details.h>
+#include <executor/tuptable.h>
 
 #include "catalog.h"
 #include "utils.h"
@@ -17,6 +18,7 @@
 typedef struct PartitioningInfo PartitioningInfo;
 typedef struct DimensionSlice DimensionSlice;
 typedef struct DimensionVec DimensionVec;
+typedef struct DimensionSliceIndex DimensionSliceIndex;
 
 typedef enum DimensionType
 {
@@ -25,14 +27,26 @@ typedef enum DimensionType
 	DIMENSION_TYPE_ANY,
 } DimensionType;
 
-typedef struct Dimension
+typedef struct Dimension Dimension;
+
+/*
+ * Maps a (non-NULL) value of a dimension's column to a coordinate in the
+ * dimension.
+ */
+typedef int64 (*dimension_coordinate_func) (Dimension *dim, Datum value);
+
+struct Dimension
 {
 	FormData_dimension fd;
 	DimensionType type;
 	AttrNumber	column_attno;
 	Oid			main_table_relid;
 	PartitioningInfo *partitioning;
-} Dimension;
+	/* Specialized on the column type and partitioning function */
+	dimension_coordinate_func coordinate_func;
+	/* In-memory index of the dimension's slices. NULL if not indexed */
+	DimensionSliceIndex *slice_index;
+};
 
 
 #define IS_OPEN_DIMENSION(d)					\
@@ -130,7 +144,8 @@ enum Anum_add_dimension
 
 extern Hyperspace *ts_dimension_scan(int32 hypertable_id, Oid main_table_relid, int16 num_dimension, MemoryContext mctx);
 extern DimensionSlice *ts_dimension_calculate_default_slice(Dimension *dim, int64 value);
-extern Point *ts_hyperspace_calculate_point(Hyperspace *h, HeapTuple tuple, TupleDesc tupdesc);
+extern Point *ts_hyperspace_calculate_point(Hyperspace *h, TupleTableSlot *slot);
+extern void ts_hyperspace_calculate_points(Hyperspace *hs, TupleDesc desc, HeapTuple *tuples, int ntuples, Point **points);
 extern Dimension *ts_hyperspace_get_dimension_by_id(Hyperspace *hs, int32 id);
 extern Dimension *ts_hyperspace_get_dimension(Hyperspace *hs, DimensionType type, Index n);
 extern Dimension *ts_hyperspace_get_dimension_by_name(Hyperspace *hs, DimensionType type, const char *name);
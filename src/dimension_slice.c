@@ -23,12 +23,9 @@
 #include "dimension.h"
 #include "chunk_constraint.h"
 #include "dimension_vector.h"
+#include "dimension_slice_index.h"
 
 
-/* Put DIMENSION_SLICE_MAXVALUE point in same slice as DIMENSION_SLICE_MAXVALUE-1, always */
-/* This avoids the problem with coord < range_end where coord and range_end is an int64 */
-#define REMAP_LAST_COORDINATE(coord) (((coord)==DIMENSION_SLICE_MAXVALUE) ? DIMENSION_SLICE_MAXVALUE-1 : (coord))
-
 static inline DimensionSlice *
 dimension_slice_alloc(void)
 {
@@ -201,6 +198,35 @@ ts_dimension_slice_scan_limit(int32 dimension_id, int64 coordinate, int limit)
 	return ts_dimension_vec_sort(&slices);
 }
 
+/*
+ * Get the value to compare range ends with when searching for slices whose
+ * range ends relative to the given value.
+ */
+int64
+ts_dimension_slice_range_end_key(int64 end_value)
+{
+	/*
+	 * range_end is stored as exclusive, so add 1 to the value being searched.
+	 * Also avoid overflow
+	 */
+	if (end_value != PG_INT64_MAX)
+	{
+		end_value++;
+
+		/*
+		 * If getting as input INT64_MAX-1, need to remap the incremented value
+		 * back to INT64_MAX-1
+		 */
+		return REMAP_LAST_COORDINATE(end_value);
+	}
+
+	/*
+	 * The point with INT64_MAX gets mapped to INT64_MAX-1 so incrementing that
+	 * gets you to INT_64MAX
+	 */
+	return PG_INT64_MAX;
+}
+
 /*
  * Look for all dimension slices where (lower_bound, upper_bound) of the dimension_slice contains the given (start_value, end_value) range
  *
@@ -238,34 +264,11 @@ ts_dimension_slice_scan_range_limit(int32 dimension_id, StrategyNumber start_str
 
 		Assert(OidIsValid(proc));
 
-		/*
-		 * range_end is stored as exclusive, so add 1 to the value being
-		 * searched. Also avoid overflow
-		 */
-		if (end_value != PG_INT64_MAX)
-		{
-			end_value++;
-
-			/*
-			 * If getting as input INT64_MAX-1, need to remap the incremented
-			 * value back to INT64_MAX-1
-			 */
-			end_value = REMAP_LAST_COORDINATE(end_value);
-		}
-		else
-		{
-			/*
-			 * The point with INT64_MAX gets mapped to INT64_MAX-1 so
-			 * incrementing that gets you to INT_64MAX
-			 */
-			end_value = PG_INT64_MAX;
-		}
-
 		ScanKeyInit(&scankey[nkeys++],
 					Anum_dimension_slice_dimension_id_range_start_range_end_idx_range_end,
 					end_strategy,
 					proc,
-					Int64GetDatum(end_value));
+					Int64GetDatum(ts_dimension_slice_range_end_key(end_value)));
 	}
 
 	dimension_slice_scan_limit_internal(DIMENSION_SLICE_DIMENSION_ID_RANGE_START_RANGE_END_IDX,
@@ -586,9 +589,8 @@ ts_dimension_slice_free(DimensionSlice *slice)
 }
 
 static bool
-dimension_slice_insert_relation(Relation rel, DimensionSlice *slice)
+dimension_slice_insert_relation(CatalogMultiInsertState *state, DimensionSlice *slice)
 {
-	TupleDesc	desc = RelationGetDescr(rel);
 	Datum		values[Natts_dimension_slice];
 	bool		nulls[Natts_dimension_slice] = {false};
 	CatalogSecurityContext sec_ctx;
@@ -605,7 +607,7 @@ dimension_slice_insert_relation(Relation rel, DimensionSlice *slice)
 	values[AttrNumberGetAttrOffset(Anum_dimension_slice_range_start)] = Int64GetDatum(slice->fd.range_start);
 	values[AttrNumberGetAttrOffset(Anum_dimension_slice_range_end)] = Int64GetDatum(slice->fd.range_end);
 
-	ts_catalog_insert_values(rel, desc, values, nulls);
+	ts_catalog_multi_insert_values(state, values, nulls);
 	ts_catalog_restore_user(&sec_ctx);
 
 	return true;
@@ -618,13 +620,21 @@ void
 ts_dimension_slice_insert_multi(DimensionSlice **slices, Size num_slices)
 {
 	Catalog    *catalog = ts_catalog_get();
+	CatalogMultiInsertState state;
 	Relation	rel;
 	Size		i;
 
+	/* Slice indexes must not be trusted until the new slices are visible */
+	for (i = 0; i < num_slices; i++)
+		if (slices[i]->fd.id <= 0)
+			ts_dimension_slice_index_slices_created(slices[i]->fd.dimension_id);
+
 	rel = heap_open(catalog_get_table_id(catalog, DIMENSION_SLICE), RowExclusiveLock);
+	ts_catalog_multi_insert_begin(&state, rel);
 
 	for (i = 0; i < num_slices; i++)
-		dimension_slice_insert_relation(rel, slices[i]);
+		dimension_slice_insert_relation(&state, slices[i]);
 
+	ts_catalog_multi_insert_end(&state);
 	heap_close(rel, RowExclusiveLock);
 }
@@ -20,6 +20,10 @@
 /* partition functions return int32 */
 #define DIMENSION_SLICE_CLOSED_MAX ((int64)PG_INT32_MAX)
 
+/* Put DIMENSION_SLICE_MAXVALUE point in same slice as DIMENSION_SLICE_MAXVALUE-1, always */
+/* This avoids the problem with coord < range_end where coord and range_end is an int64 */
+#define REMAP_LAST_COORDINATE(coord) (((coord)==DIMENSION_SLICE_MAXVALUE) ? DIMENSION_SLICE_MAXVALUE-1 : (coord))
+
 typedef struct DimensionSlice
 {
 	FormData_dimension_slice fd;
@@ -48,6 +52,7 @@ extern void ts_dimension_slice_free(DimensionSlice *slice);
 extern void ts_dimension_slice_insert_multi(DimensionSlice **slice, Size num_slices);
 extern int	ts_dimension_slice_cmp(const DimensionSlice *left, const DimensionSlice *right);
 extern int	ts_dimension_slice_cmp_coordinate(const DimensionSlice *slice, int64 coord);
+extern int64 ts_dimension_slice_range_end_key(int64 end_value);
 
 #define dimension_slice_insert(slice) \
 	ts_dimension_slice_insert_multi(&(slice), 1)
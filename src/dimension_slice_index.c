@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+ *
+ * This file is licensed under the Apache License,
+ * see LICENSE-APACHE at the top level directory.
+ */
+#include <postgres.h>
+#include <access/transam.h>
+#include <access/xact.h>
+#include <utils/memutils.h>
+
+#include "dimension_slice_index.h"
+#include "dimension_slice.h"
+#include "shared_chunk_cache.h"
+
+/*
+ * The slice index of a dimension is an interval tree over the dimension's
+ * slices. It is built from the catalog the first time the dimension is
+ * searched and lives as long as the dimension, which is normally part of a
+ * hypertable in the hypertable cache.
+ *
+ * The slices are kept in an array sorted on range start and end, and the tree
+ * is implicit in the array: the root of the subtree spanning [lo, hi) is the
+ * slice in the middle, and each slice also stores the largest range end in its
+ * subtree. A search only descends into subtrees whose slices might overlap
+ * the searched range, so it runs in O(log n + k) for the non-overlapping
+ * slices of aligned dimensions. Since the search is in-order, slices are
+ * found in the same order as in the catalog index.
+ *
+ * Slices are not invalidated when they are created, so an index can be
+ * missing slices created after it was built, also by other backends. Every
+ * transaction that creates slices in a dimension is therefore counted in
+ * shared memory, per dimension, when it starts creating slices and when it
+ * ends. An index is only used if no slices are being created in its dimension
+ * and no transaction has finished creating slices in the dimension since the
+ * index was built. Otherwise, it is rebuilt or the catalog is scanned. Slices
+ * that are deleted also invalidate the hypertable, and an index with a stale
+ * slice would only find a slice without chunks.
+ */
+struct DimensionSliceIndex
+{
+	MemoryContext parent_mcxt;	/* Context of the dimension */
+	MemoryContext mcxt;			/* Holds the slices. NULL if not built */
+	uint64		generation;		/* Slice creations finished when built */
+	int32		num_slices;
+	FormData_dimension_slice *slices;
+	int64	   *max_end;		/* Largest range end in each subtree */
+};
+
+/* Dimensions that the current transaction was counted as creating slices in */
+static List *creating_slices_dimensions = NIL;
+
+DimensionSliceIndex *
+ts_dimension_slice_index_create(MemoryContext mcxt)
+{
+	DimensionSliceIndex *index = MemoryContextAllocZero(mcxt, sizeof(DimensionSliceIndex));
+
+	index->parent_mcxt = mcxt;
+
+	return index;
+}
+
+static int64
+slice_index_build_subtree(DimensionSliceIndex *index, int lo, int hi)
+{
+	int			mid;
+	int64		max_end;
+
+	if (lo >= hi)
+		return DIMENSION_SLICE_MINVALUE;
+
+	mid = lo + (hi - lo) / 2;
+	max_end = index->slices[mid].range_end;
+	max_end = Max(max_end, slice_index_build_subtree(index, lo, mid));
+	max_end = Max(max_end, slice_index_build_subtree(index, mid + 1, hi));
+	index->max_end[mid] = max_end;
+
+	return max_end;
+}
+
+static void
+slice_index_build(DimensionSliceIndex *index, int32 dimension_id, uint64 generation)
+{
+	DimensionVec *vec;
+	MemoryContext old;
+	int			i;
+
+	if (NULL != index->mcxt)
+		MemoryContextDelete(index->mcxt);
+
+	index->mcxt = NULL;
+
+	/* Slices are returned sorted on range start and end */
+	vec = ts_dimension_slice_scan_by_dimension(dimension_id, 0);
+
+	index->mcxt = AllocSetContextCreate(index->parent_mcxt,
+										"Dimension slice index",
+										ALLOCSET_SMALL_SIZES);
+	old = MemoryContextSwitchTo(index->mcxt);
+	index->num_slices = vec->num_slices;
+	index->slices = palloc(sizeof(FormData_dimension_slice) * Max(vec->num_slices, 1));
+	index->max_end = palloc(sizeof(int64) * Max(vec->num_slices, 1));
+	MemoryContextSwitchTo(old);
+
+	for (i = 0; i < vec->num_slices; i++)
+		index->slices[i] = vec->slices[i]->fd;
+
+	slice_index_build_subtree(index, 0, index->num_slices);
+	index->generation = generation;
+
+	ts_dimension_vec_free(vec);
+}
+
+/*
+ * Get the slice index of a dimension, building it if necessary. Returns NULL
+ * if the index cannot be used, in which case the catalog should be scanned.
+ */
+static DimensionSliceIndex *
+slice_index_get(Dimension *dim)
+{
+	DimensionSliceIndex *index = dim->slice_index;
+	uint64		generation;
+
+	if (NULL == index || !ts_shared_chunk_cache_slice_generation(dim->fd.id, &generation))
+		return NULL;
+
+	/*
+	 * The generation is read before the catalog scan, so slices created
+	 * during the scan make the next lookup rebuild the index
+	 */
+	if (NULL == index->mcxt || index->generation != generation)
+		slice_index_build(index, dim->fd.id, generation);
+
+	return index;
+}
+
+static inline bool
+int64_matches_strategy(int64 value, StrategyNumber strategy, int64 key)
+{
+	switch (strategy)
+	{
+		case BTLessStrategyNumber:
+			return value < key;
+		case BTLessEqualStrategyNumber:
+			return value <= key;
+		case BTEqualStrategyNumber:
+			return value == key;
+		case BTGreaterEqualStrategyNumber:
+			return value >= key;
+		case BTGreaterStrategyNumber:
+			return value > key;
+		default:
+			return true;
+	}
+}
+
+typedef struct SliceIndexSearch
+{
+	/* Only slices with range_start < start_below can match */
+	int64		start_below;
+	/* Only slices with range_end > end_above can match */
+	int64		end_above;
+	/* Exact conditions on the range start and end */
+	StrategyNumber start_strategy;
+	int64		start_value;
+	StrategyNumber end_strategy;
+	int64		end_value;
+	int			limit;
+	DimensionVec *slices;
+} SliceIndexSearch;
+
+static void
+slice_index_search_subtree(DimensionSliceIndex *index, int lo, int hi, SliceIndexSearch *search)
+{
+	while (lo < hi)
+	{
+		int			mid = lo + (hi - lo) / 2;
+		FormData_dimension_slice *fd = &index->slices[mid];
+
+		/* No slice in this subtree ends late enough */
+		if (index->max_end[mid] <= search->end_above)
+			return;
+
+		slice_index_search_subtree(index, lo, mid, search);
+
+		if (search->limit > 0 && search->slices->num_slices >= search->limit)
+			return;
+
+		/* This slice and all slices after it start too late */
+		if (fd->range_start >= search->start_below)
+			return;
+
+		if (fd->range_end > search->end_above &&
+			int64_matches_strategy(fd->range_start, search->start_strategy, search->start_value) &&
+			int64_matches_strategy(fd->range_end, search->end_strategy, search->end_value))
+		{
+			DimensionSlice *slice = ts_dimension_slice_create(fd->dimension_id, fd->range_start, fd->range_end);
+
+			slice->fd.id = fd->id;
+			search->slices = ts_dimension_vec_add_slice(&search->slices, slice);
+		}
+
+		lo = mid + 1;
+	}
+}
+
+/*
+ * Find the slices whose range start and end match the given strategies.
+ */
+static DimensionVec *
+slice_index_search(DimensionSliceIndex *index, StrategyNumber start_strategy, int64 start_value, StrategyNumber end_strategy, int64 end_value, int limit)
+{
+	SliceIndexSearch search = {
+		.start_below = DIMENSION_SLICE_MAXVALUE,
+		.end_above = DIMENSION_SLICE_MINVALUE,
+		.start_strategy = start_strategy,
+		.start_value = start_value,
+		.end_strategy = end_strategy,
+		.end_value = end_value,
+		.limit = limit,
+		.slices = ts_dimension_vec_create(limit > 0 ? limit : DIMENSION_VEC_DEFAULT_SIZE),
+	};
+
+	switch (start_strategy)
+	{
+		case BTLessStrategyNumber:
+			search.start_below = start_value;
+			break;
+		case BTLessEqualStrategyNumber:
+		case BTEqualStrategyNumber:
+			if (start_value < DIMENSION_SLICE_MAXVALUE)
+				search.start_below = start_value + 1;
+			break;
+		default:
+			break;
+	}
+
+	switch (end_strategy)
+	{
+		case BTGreaterStrategyNumber:
+			search.end_above = end_value;
+			break;
+		case BTGreaterEqualStrategyNumber:
+		case BTEqualStrategyNumber:
+			if (end_value > DIMENSION_SLICE_MINVALUE)
+				search.end_above = end_value - 1;
+			break;
+		default:
+			break;
+	}
+
+	slice_index_search_subtree(index, 0, index->num_slices, &search);
+
+	return search.slices;
+}
+
+/*
+ * Find the slices that enclose the coordinate in the given dimension.
+ */
+DimensionVec *
+ts_dimension_slice_index_scan_limit(Dimension *dim, int64 coordinate, int limit)
+{
+	DimensionSliceIndex *index = slice_index_get(dim);
+
+	if (NULL == index)
+		return ts_dimension_slice_scan_limit(dim->fd.id, coordinate, limit);
+
+	coordinate = REMAP_LAST_COORDINATE(coordinate);
+
+	return slice_index_search(index,
+							  BTLessEqualStrategyNumber,
+							  coordinate,
+							  BTGreaterStrategyNumber,
+							  coordinate,
+							  limit);
+}
+
+/*
+ * Find the slices whose range start and end match the given strategies. See
+ * ts_dimension_slice_scan_range_limit().
+ */
+DimensionVec *
+ts_dimension_slice_index_scan_range_limit(Dimension *dim, StrategyNumber start_strategy, int64 start_value, StrategyNumber end_strategy, int64 end_value, int limit)
+{
+	DimensionSliceIndex *index = slice_index_get(dim);
+
+	if (NULL == index)
+		return ts_dimension_slice_scan_range_limit(dim->fd.id,
+												   start_strategy,
+												   start_value,
+												   end_strategy,
+												   end_value,
+												   limit);
+
+	if (end_strategy != InvalidStrategy)
+		end_value = ts_dimension_slice_range_end_key(end_value);
+
+	return slice_index_search(index,
+							  start_strategy,
+							  start_value,
+							  end_strategy,
+							  end_value,
+							  limit);
+}
+
+/*
+ * Find the slices that collide/overlap with the given range.
+ */
+DimensionVec *
+ts_dimension_slice_index_collision_scan_limit(Dimension *dim, int64 range_start, int64 range_end, int limit)
+{
+	DimensionSliceIndex *index = slice_index_get(dim);
+
+	if (NULL == index)
+		return ts_dimension_slice_collision_scan_limit(dim->fd.id, range_start, range_end, limit);
+
+	return slice_index_search(index,
+							  BTLessStrategyNumber,
+							  range_end,
+							  BTGreaterStrategyNumber,
+							  range_start,
+							  limit);
+}
+
+/*
+ * Note that the current transaction creates slices in a dimension. Must be
+ * called before the slices are inserted into the catalog.
+ */
+void
+ts_dimension_slice_index_slices_created(int32 dimension_id)
+{
+	MemoryContext old;
+
+	if (list_member_int(creating_slices_dimensions, dimension_id) ||
+		!ts_shared_chunk_cache_slice_creation_start(dimension_id))
+		return;
+
+	old = MemoryContextSwitchTo(TopTransactionContext);
+	creating_slices_dimensions = lappend_int(creating_slices_dimensions, dimension_id);
+	MemoryContextSwitchTo(old);
+}
+
+static void
+dimension_slice_index_xact_end(XactEvent event, void *arg)
+{
+	ListCell   *lc;
+
+	switch (event)
+	{
+		case XACT_EVENT_COMMIT:
+		case XACT_EVENT_PARALLEL_COMMIT:
+		case XACT_EVENT_ABORT:
+		case XACT_EVENT_PARALLEL_ABORT:
+			/* The created slices are now visible to everyone, or gone */
+			foreach(lc, creating_slices_dimensions)
+				ts_shared_chunk_cache_slice_creation_finish(lfirst_int(lc));
+			creating_slices_dimensions = NIL;
+			break;
+		case XACT_EVENT_PREPARE:
+
+			/*
+			 * The slices of a prepared transaction only become visible when
+			 * it is committed, which might happen in another backend. The
+			 * slice creations are finished once the transaction is no longer
+			 * running.
+			 */
+			foreach(lc, creating_slices_dimensions)
+			{
+				TransactionId xid = GetCurrentTransactionIdIfAny();
+
+				/* Without an XID, the transaction did not insert any slices */
+				if (TransactionIdIsValid(xid))
+					ts_shared_chunk_cache_slice_creation_prepare(lfirst_int(lc), xid);
+				else
+					ts_shared_chunk_cache_slice_creation_finish(lfirst_int(lc));
+			}
+			creating_slices_dimensions = NIL;
+			break;
+		default:
+			break;
+	}
+}
+
+void
+_dimension_slice_index_init(void)
+{
+	RegisterXactCallback(dimension_slice_index_xact_end, NULL);
+}
+
+void
+_dimension_slice_index_fini(void)
+{
+	UnregisterXactCallback(dimension_slice_index_xact_end, NULL);
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+ *
+ * This file is licensed under the Apache License,
+ * see LICENSE-APACHE at the top level directory.
+ */
+#ifndef TIMESCALEDB_DIMENSION_SLICE_INDEX_H
+#define TIMESCALEDB_DIMENSION_SLICE_INDEX_H
+
+#include <postgres.h>
+
+#include "dimension.h"
+#include "dimension_vector.h"
+
+/*
+ * In-memory index of the slices in a dimension, used to find slices by point,
+ * range or collision without scanning the dimension slice catalog table.
+ *
+ * The functions below have the same semantics as the corresponding catalog
+ * scans in dimension_slice.c and fall back to those scans when the dimension
+ * has no index or the index might be incomplete.
+ */
+typedef struct DimensionSliceIndex DimensionSliceIndex;
+
+extern DimensionSliceIndex *ts_dimension_slice_index_create(MemoryContext mcxt);
+extern DimensionVec *ts_dimension_slice_index_scan_limit(Dimension *dim, int64 coordinate, int limit);
+extern DimensionVec *ts_dimension_slice_index_scan_range_limit(Dimension *dim, StrategyNumber start_strategy, int64 start_value, StrategyNumber end_strategy, int64 end_value, int limit);
+extern DimensionVec *ts_dimension_slice_index_collision_scan_limit(Dimension *dim, int64 range_start, int64 range_end, int limit);
+extern void ts_dimension_slice_index_slices_created(int32 dimension_id);
+
+extern void _dimension_slice_index_init(void);
+extern void _dimension_slice_index_fini(void);
+
+#endif							/* TIMESCALEDB_DIMENSION_SLICE_INDEX_H */
@@ -41,7 +41,12 @@ bool		ts_guc_optimize_non_hypertables = false;
 bool		ts_guc_restoring = false;
 bool		ts_guc_constraint_aware_append = true;
 int			ts_guc_max_open_chunks_per_insert = 10;
+int			ts_guc_max_open_chunks_memory = -1;
 int			ts_guc_max_cached_chunks_per_hypertable = 10;
+int			ts_guc_insert_batch_size = 0;
+bool		ts_guc_group_rows_by_chunk = false;
+bool		ts_guc_precreate_chunks = false;
+bool		ts_guc_defer_chunk_index_build = false;
 int			ts_guc_telemetry_level = TELEMETRY_BASIC;
 
 static void
@@ -114,6 +119,21 @@ _guc_init(void)
 							NULL,
 							NULL);
 
+	DefineCustomIntVariable("timescaledb.max_open_chunks_memory",
+							"Maximum memory of open chunks per insert",
+							"Maximum memory used by open chunk tables per insert before the "
+							"least recently used ones are closed. Set to -1 to use work_mem "
+							"and to 0 for no limit",
+							&ts_guc_max_open_chunks_memory,
+							-1,
+							-1,
+							MAX_KILOBYTES,
+							PGC_USERSET,
+							GUC_UNIT_KB,
+							NULL,
+							NULL,
+							NULL);
+
 	DefineCustomIntVariable("timescaledb.max_cached_chunks_per_hypertable",
 							"Maximum cached chunks",
 							"Maximum number of chunks stored in the cache",
@@ -126,6 +146,54 @@ _guc_init(void)
 							NULL,
 							assign_max_cached_chunks_per_hypertable_hook,
 							NULL);
+
+	DefineCustomIntVariable("timescaledb.insert_batch_size",
+							"Number of tuples to batch per insert",
+							"Maximum number of tuples an INSERT reads ahead and groups by "
+							"chunk before inserting them. Zero disables batching",
+							&ts_guc_insert_batch_size,
+							0,
+							0,
+							1000000,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+	DefineCustomBoolVariable("timescaledb.group_rows_by_chunk",
+							 "Group inserted rows by chunk within work_mem",
+							 "Let COPY and INSERT buffer up to work_mem of rows and write "
+							 "them chunk by chunk instead of in arrival order",
+							 &ts_guc_group_rows_by_chunk,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+	DefineCustomBoolVariable("timescaledb.defer_chunk_index_build",
+							 "Build indexes on new chunks when a load ends",
+							 "Create the non-unique indexes of chunks created by an INSERT or "
+							 "COPY empty and build them once the statement ends",
+							 &ts_guc_defer_chunk_index_build,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+	DefineCustomBoolVariable("timescaledb.precreate_chunks",
+							 "Pre-create upcoming chunks in the background",
+							 "Let the chunk pre-creation job create the chunks of the next "
+							 "time interval before data arrives for them. Off by default, "
+							 "since the job creates chunks for every hypertable",
+							 &ts_guc_precreate_chunks,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
 	DefineCustomEnumVariable("timescaledb.telemetry_level",
 							 "Telemetry settings level",
 							 "Level used to determine which telemetry to send",
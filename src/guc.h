@@ -16,7 +16,12 @@ extern bool ts_guc_optimize_non_hypertables;
 extern bool ts_guc_constraint_aware_append;
 extern bool ts_guc_restoring;
 extern int	ts_guc_max_open_chunks_per_insert;
+extern int	ts_guc_max_open_chunks_memory;
 extern int	ts_guc_max_cached_chunks_per_hypertable;
+extern int	ts_guc_insert_batch_size;
+extern bool ts_guc_group_rows_by_chunk;
+extern bool ts_guc_precreate_chunks;
+extern bool ts_guc_defer_chunk_index_build;
 extern int	ts_guc_telemetry_level;
 
 void		_guc_init(void);
@@ -6,6 +6,7 @@
  */
 #include "hypercube.h"
 #include "dimension_vector.h"
+#include "dimension_slice_index.h"
 
 /*
  * A hypercube represents the partition bounds of a hypertable chunk.
@@ -214,7 +215,7 @@ ts_hypercube_calculate_from_point(Hyperspace *hs, Point *p)
 		{
 			DimensionVec *vec;
 
-			vec = ts_dimension_slice_scan_limit(dim->fd.id, value, 1);
+			vec = ts_dimension_slice_index_scan_limit(dim, value, 1);
 
 			if (vec->num_slices > 0)
 			{
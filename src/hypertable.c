@@ -8,12 +8,14 @@
 #include <access/htup_details.h>
 #include <access/heapam.h>
 #include <access/relscan.h>
+#include <access/xact.h>
 #include <utils/lsyscache.h>
 #include <utils/syscache.h>
 #include <utils/memutils.h>
 #include <utils/builtins.h>
 #include <utils/acl.h>
 #include <utils/snapmgr.h>
+#include <utils/resowner.h>
 #include <nodes/memnodes.h>
 #include <nodes/makefuncs.h>
 #include <nodes/value.h>
@@ -44,10 +46,12 @@
 #include "dimension_slice.h"
 #include "dimension_vector.h"
 #include "hypercube.h"
+#include "shared_chunk_cache.h"
 #include "indexing.h"
 #include "guc.h"
 #include "errors.h"
 #include "copy.h"
+#include "last_point.h"
 #include "utils.h"
 #include "funcapi.h"
 #include "utils.h"
@@ -374,6 +378,7 @@ hypertable_tuple_delete(TupleInfo *ti, void *data)
 	int			hypertable_id = heap_getattr(ti->tuple, Anum_hypertable_id, ti->desc, &isnull);
 
 	ts_tablespace_delete(hypertable_id, NULL);
+	ts_last_point_delete_by_hypertable_id(hypertable_id);
 	ts_chunk_delete_by_hypertable_id(hypertable_id);
 	ts_dimension_delete_by_hypertable_id(hypertable_id, true);
 
@@ -693,7 +698,7 @@ hypertable_chunk_store_add(Hypertable *h, Chunk *chunk)
 	cse = palloc(sizeof(ChunkStoreEntry));
 	cse->mcxt = chunk_mcxt;
 	cse->chunk = ts_chunk_copy(chunk);
-	ts_subspace_store_add(h->chunk_cache, chunk->cube, cse, chunk_store_entry_free);
+	ts_subspace_store_add(h->chunk_cache, chunk->cube, cse, 0, chunk_store_entry_free);
 	MemoryContextSwitchTo(old_mcxt);
 
 	return cse;
@@ -712,13 +717,24 @@ ts_hypertable_get_chunk(Hypertable *h, Point *point)
 		 * ts_chunk_find() must execute on a per-tuple memory context since it
 		 * allocates a lot of transient data. We don't want this allocated on
 		 * the cache's memory context.
+		 *
+		 * Try the chunk cache shared by all backends before scanning the
+		 * catalog for the chunk. Chunks are added to the shared cache when
+		 * the transaction commits, so also chunks created here are added.
 		 */
-		chunk = ts_chunk_find(h->space, point);
+		chunk = ts_shared_chunk_cache_find(h->space, point);
 
 		if (NULL == chunk)
-			chunk = ts_chunk_create(h, point,
-									NameStr(h->fd.associated_schema_name),
-									NameStr(h->fd.associated_table_prefix));
+		{
+			chunk = ts_chunk_find(h->space, point);
+
+			if (NULL == chunk)
+				chunk = ts_chunk_create(h, point,
+										NameStr(h->fd.associated_schema_name),
+										NameStr(h->fd.associated_table_prefix));
+
+			ts_shared_chunk_cache_add(h->space, point, chunk);
+		}
 
 		Assert(chunk != NULL);
 
@@ -1654,3 +1670,281 @@ ts_hypertable_get_all_by_name(Name schema_name, Name table_name, MemoryContext m
 
 	return data.ht_oids;
 }
+
+/*
+ * Maximum number of time intervals to pre-create chunks for, so that
+ * hypertables with very small chunk intervals do not get an excessive number
+ * of empty chunks.
+ */
+#define PRECREATE_MAX_INTERVALS 64
+
+/*
+ * Create the chunks containing the given point's time coordinate, one for
+ * each combination of space partitions.
+ */
+static int
+precreate_chunks_at(Hypertable *h, Point *p)
+{
+	Hyperspace *hs = h->space;
+	int16	   *partitions;
+	int			num_created = 0;
+	int			i;
+
+	/* Open dimensions come first, so the remaining ones are all closed */
+	partitions = palloc0(sizeof(int16) * hs->num_dimensions);
+
+	for (;;)
+	{
+		for (i = 1; i < hs->num_dimensions; i++)
+		{
+			Dimension  *dim = &hs->dimensions[i];
+
+			/* The first coordinate in the partition's default range */
+			p->coordinates[i] = partitions[i] *
+				(DIMENSION_SLICE_CLOSED_MAX / ((int64) dim->fd.num_slices));
+		}
+
+		if (NULL == ts_chunk_find(hs, p))
+		{
+			ts_chunk_create(h, p,
+							NameStr(h->fd.associated_schema_name),
+							NameStr(h->fd.associated_table_prefix));
+			num_created++;
+		}
+
+		/* Advance to the next combination of space partitions */
+		for (i = hs->num_dimensions - 1; i > 0; i--)
+		{
+			if (++partitions[i] < hs->dimensions[i].fd.num_slices)
+				break;
+			partitions[i] = 0;
+		}
+
+		if (i == 0)
+			break;
+	}
+
+	pfree(partitions);
+
+	return num_created;
+}
+
+/*
+ * Create the chunks that will hold data for the next time intervals, one for
+ * each combination of space partitions, so that inserts crossing into those
+ * intervals do not have to wait for chunk creation.
+ *
+ * Chunks are created for the next interval, and for as many following
+ * intervals as needed to cover the lookahead (in microseconds), e.g., the
+ * time until the pre-creation job runs again.
+ *
+ * "Next" is relative to the current time, so only hypertables with a single
+ * open dimension of a timestamp type are handled. Returns the number of
+ * chunks created.
+ */
+int
+ts_hypertable_precreate_chunks(Hypertable *h, int64 lookahead)
+{
+	Hyperspace *hs = h->space;
+	Dimension  *time_dim = hyperspace_get_open_dimension(hs, 0);
+	Interval	ahead = {.time = 0,};
+	Point	   *p;
+	int64		next;
+	int64		num_intervals;
+	int64		n;
+	int			num_created = 0;
+
+	if (NULL == time_dim ||
+		!IS_TIMESTAMP_TYPE(time_dim->fd.column_type) ||
+		NULL != hyperspace_get_open_dimension(hs, 1))
+		return 0;
+
+	/* now() minus a negative interval is one chunk interval ahead of now() */
+	ahead.time = -time_dim->fd.interval_length;
+	next = ts_interval_from_now_to_internal(IntervalPGetDatum(&ahead),
+											time_dim->fd.column_type);
+
+	num_intervals = lookahead / time_dim->fd.interval_length;
+
+	if (lookahead % time_dim->fd.interval_length != 0)
+		num_intervals++;
+
+	num_intervals = Min(Max(num_intervals, 1), PRECREATE_MAX_INTERVALS);
+
+	p = palloc0(POINT_SIZE(hs->num_dimensions));
+	p->cardinality = p->num_coords = hs->num_dimensions;
+
+	for (n = 0; n < num_intervals; n++)
+	{
+		p->coordinates[0] = next + n * time_dim->fd.interval_length;
+		num_created += precreate_chunks_at(h, p);
+	}
+
+	pfree(p);
+
+	return num_created;
+}
+
+TS_FUNCTION_INFO_V1(ts_hypertable_precreate_chunks_sql);
+
+/*
+ * Pre-create the next intervals' chunks of a single hypertable.
+ */
+Datum
+ts_hypertable_precreate_chunks_sql(PG_FUNCTION_ARGS)
+{
+	Oid			table_relid = PG_GETARG_OID(0);
+	int64		lookahead = 0;
+	Cache	   *hcache;
+	Hypertable *ht;
+	int			num_created;
+
+	if (!PG_ARGISNULL(1))
+		lookahead = ts_get_interval_period_approx(PG_GETARG_INTERVAL_P(1));
+
+	ts_hypertable_permissions_check(table_relid, GetUserId());
+
+	hcache = ts_hypertable_cache_pin();
+	ht = ts_hypertable_cache_get_entry(hcache, table_relid);
+
+	if (NULL == ht)
+		ereport(ERROR,
+				(errcode(ERRCODE_TS_HYPERTABLE_NOT_EXIST),
+				 errmsg("table \"%s\" is not a hypertable",
+						get_rel_name(table_relid))));
+
+	num_created = ts_hypertable_precreate_chunks(ht, lookahead);
+	ts_cache_release(hcache);
+
+	PG_RETURN_INT32(num_created);
+}
+
+/*
+ * Pre-create the chunks of a hypertable in a subtransaction. An error is
+ * reported as a warning and does not abort the caller's transaction.
+ */
+static int
+precreate_chunks_in_subtransaction(Oid table_relid, int64 lookahead)
+{
+	MemoryContext oldcontext = CurrentMemoryContext;
+	ResourceOwner oldowner = CurrentResourceOwner;
+	char	   *relname = get_rel_name(table_relid);
+	volatile int num_created = 0;
+
+	/* The hypertable was dropped after it was listed */
+	if (NULL == relname)
+		return 0;
+
+	BeginInternalSubTransaction(NULL);
+	MemoryContextSwitchTo(oldcontext);
+
+	PG_TRY();
+	{
+		Cache	   *hcache = ts_hypertable_cache_pin();
+		Hypertable *ht = ts_hypertable_cache_get_entry(hcache, table_relid);
+
+		if (NULL != ht)
+			num_created = ts_hypertable_precreate_chunks(ht, lookahead);
+
+		ts_cache_release(hcache);
+		ReleaseCurrentSubTransaction();
+		MemoryContextSwitchTo(oldcontext);
+		CurrentResourceOwner = oldowner;
+	}
+	PG_CATCH();
+	{
+		ErrorData  *edata;
+
+		MemoryContextSwitchTo(oldcontext);
+		edata = CopyErrorData();
+		FlushErrorState();
+		RollbackAndReleaseCurrentSubTransaction();
+		MemoryContextSwitchTo(oldcontext);
+		CurrentResourceOwner = oldowner;
+
+		ereport(WARNING,
+				(errcode(edata->sqlerrcode),
+				 errmsg("could not pre-create chunks for hypertable \"%s\": %s",
+						relname, edata->message)));
+		FreeErrorData(edata);
+		num_created = 0;
+	}
+	PG_END_TRY();
+
+	return num_created;
+}
+
+/*
+ * Main function of the chunk pre-creation background job. Creates the chunks
+ * for every hypertable in the database that are needed until the job runs
+ * again. The job does nothing unless timescaledb.precreate_chunks is turned
+ * on, since not every hypertable gets data for the upcoming intervals.
+ *
+ * Each hypertable is handled in a transaction of its own, unless the job is
+ * run in an existing transaction, so that the locks taken for one hypertable
+ * are not held while handling the others. A hypertable whose chunks cannot be
+ * created does not keep the other hypertables from getting theirs.
+ */
+bool
+ts_hypertable_precreate_chunks_main(Interval *schedule_interval)
+{
+	MemoryContext mcxt = CurrentMemoryContext;
+	List	   *hypertables;
+	List	   *relids = NIL;
+	ListCell   *lc;
+	int64		lookahead;
+	int			num_created = 0;
+	bool		started = false;
+
+	if (!ts_guc_precreate_chunks)
+		return true;
+
+	lookahead = ts_get_interval_period_approx(schedule_interval);
+
+	if (!IsTransactionOrTransactionBlock())
+	{
+		started = true;
+		StartTransactionCommand();
+	}
+
+	PushActiveSnapshot(GetTransactionSnapshot());
+
+	hypertables = ts_hypertable_get_all();
+
+	/* The list of hypertables must outlive the transaction */
+	foreach(lc, hypertables)
+	{
+		MemoryContext old = MemoryContextSwitchTo(mcxt);
+
+		relids = lappend_oid(relids, ((Hypertable *) lfirst(lc))->main_table_relid);
+		MemoryContextSwitchTo(old);
+	}
+
+	PopActiveSnapshot();
+
+	foreach(lc, relids)
+	{
+		if (started)
+		{
+			CommitTransactionCommand();
+			StartTransactionCommand();
+		}
+
+		PushActiveSnapshot(GetTransactionSnapshot());
+		num_created += precreate_chunks_in_subtransaction(lfirst_oid(lc), lookahead);
+		PopActiveSnapshot();
+	}
+
+	elog(DEBUG1, "[precreate] created %d chunks in %d hypertables",
+		 num_created, list_length(relids));
+
+	if (started)
+	{
+		CommitTransactionCommand();
+		MemoryContextSwitchTo(mcxt);
+	}
+
+	list_free(relids);
+
+	return true;
+}
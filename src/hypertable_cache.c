@@ -38,6 +38,8 @@ typedef struct
 {
 	Oid			relid;
 	Hypertable *hypertable;
+	/* Holds the hypertable and its chunk cache. NULL for negative entries */
+	MemoryContext mcxt;
 } HypertableCacheEntry;
 
 
@@ -89,6 +91,14 @@ hypertable_cache_create_entry(Cache *cache, CacheQuery *query)
 	HypertableCacheEntry *cache_entry = query->result;
 	int			number_found;
 
+	/*
+	 * Each hypertable gets its own memory context so that it can be freed
+	 * when only this entry is invalidated
+	 */
+	cache_entry->mcxt = AllocSetContextCreate(ts_cache_memory_ctx(cache),
+											  "Hypertable cache entry",
+											  ALLOCSET_SMALL_SIZES);
+
 	if (NULL == hq->schema)
 		hq->schema = get_namespace_name(get_rel_namespace(hq->relid));
 
@@ -101,13 +111,15 @@ hypertable_cache_create_entry(Cache *cache, CacheQuery *query)
 														  query->result,
 														  AccessShareLock,
 														  false,
-														  ts_cache_memory_ctx(cache));
+														  cache_entry->mcxt);
 
 	switch (number_found)
 	{
 		case 0:
 			/* Negative cache entry: table is not a hypertable */
 			cache_entry->hypertable = NULL;
+			MemoryContextDelete(cache_entry->mcxt);
+			cache_entry->mcxt = NULL;
 			break;
 		case 1:
 			Assert(strncmp(cache_entry->hypertable->fd.schema_name.data, hq->schema, NAMEDATALEN) == 0);
@@ -128,6 +140,37 @@ ts_hypertable_cache_invalidate_callback(void)
 	hypertable_cache_current = hypertable_cache_create();
 }
 
+/*
+ * Invalidate the cache entry of a single table, including the chunks cached
+ * for a hypertable.
+ *
+ * Hypertables returned by a pinned cache might still be in use, so a
+ * hypertable cannot be freed while the cache is pinned. In that case, the
+ * entire cache is invalidated instead and freed once it is no longer
+ * pinned. Negative entries hold nothing and can always be removed.
+ */
+void
+ts_hypertable_cache_invalidate_entry(Oid relid)
+{
+	HypertableCacheEntry *entry;
+
+	entry = hash_search(hypertable_cache_current->htab, &relid, HASH_FIND, NULL);
+
+	if (NULL == entry)
+		return;
+
+	if (NULL != entry->hypertable && hypertable_cache_current->refcount > 1)
+	{
+		ts_hypertable_cache_invalidate_callback();
+		return;
+	}
+
+	if (NULL != entry->mcxt)
+		MemoryContextDelete(entry->mcxt);
+
+	ts_cache_remove(hypertable_cache_current, &relid);
+}
+
 /* Get hypertable cache entry. If the entry is not in the cache, add it. */
 Hypertable *
 ts_hypertable_cache_get_entry(Cache *cache, Oid relid)
@@ -17,6 +17,7 @@ extern Hypertable *ts_hypertable_cache_get_entry_with_table(Cache *cache, Oid re
 extern Hypertable *ts_hypertable_cache_get_entry_by_id(Cache *cache, int32 hypertable_id);
 
 extern void ts_hypertable_cache_invalidate_callback(void);
+extern void ts_hypertable_cache_invalidate_entry(Oid relid);
 
 extern Cache *ts_hypertable_cache_pin(void);
 
@@ -18,6 +18,7 @@
 #include "dimension_slice.h"
 #include "chunk.h"
 #include "dimension_vector.h"
+#include "dimension_slice_index.h"
 #include "partitioning.h"
 
 typedef struct DimensionRestrictInfo
@@ -215,7 +216,7 @@ static DimensionVec *
 dimension_restrict_info_open_slices(DimensionRestrictInfoOpen *dri)
 {
 	/* basic idea: slice_end > lower_bound && slice_start < upper_bound */
-	return ts_dimension_slice_scan_range_limit(dri->base.dimension->fd.id, dri->upper_strategy, dri->upper_bound, dri->lower_strategy, dri->lower_bound, 0);
+	return ts_dimension_slice_index_scan_range_limit(dri->base.dimension, dri->upper_strategy, dri->upper_bound, dri->lower_strategy, dri->lower_bound, 0);
 }
 
 static DimensionVec *
@@ -231,12 +232,12 @@ dimension_restrict_info_closed_slices(DimensionRestrictInfoClosed *dri)
 		{
 			int			i;
 			int32		partition = lfirst_int(cell);
-			DimensionVec *tmp = ts_dimension_slice_scan_range_limit(dri->base.dimension->fd.id,
-																	BTLessEqualStrategyNumber,
-																	partition,
-																	BTGreaterEqualStrategyNumber,
-																	partition,
-																	0);
+			DimensionVec *tmp = ts_dimension_slice_index_scan_range_limit(dri->base.dimension,
+																		  BTLessEqualStrategyNumber,
+																		  partition,
+																		  BTGreaterEqualStrategyNumber,
+																		  partition,
+																		  0);
 
 			for (i = 0; i < tmp->num_slices; i++)
 				dim_vec = ts_dimension_vec_add_unique_slice(&dim_vec, tmp->slices[i]);
@@ -245,12 +246,12 @@ dimension_restrict_info_closed_slices(DimensionRestrictInfoClosed *dri)
 	}
 
 	/* get all slices */
-	return ts_dimension_slice_scan_range_limit(dri->base.dimension->fd.id,
-											   InvalidStrategy,
-											   -1,
-											   InvalidStrategy,
-											   -1,
-											   0);
+	return ts_dimension_slice_index_scan_range_limit(dri->base.dimension,
+													 InvalidStrategy,
+													 -1,
+													 InvalidStrategy,
+													 -1,
+													 0);
 }
 
 static DimensionVec *
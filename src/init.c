@@ -32,6 +32,18 @@ extern void _cache_invalidate_fini(void);
 extern void _cache_init(void);
 extern void _cache_fini(void);
 
+extern void _chunk_insert_state_init(void);
+extern void _chunk_insert_state_fini(void);
+
+extern void _chunk_index_init(void);
+extern void _chunk_index_fini(void);
+
+extern void _dimension_slice_index_init(void);
+extern void _dimension_slice_index_fini(void);
+
+extern void _shared_chunk_cache_init(void);
+extern void _shared_chunk_cache_fini(void);
+
 extern void _planner_init(void);
 extern void _planner_fini(void);
 
@@ -71,6 +83,10 @@ _PG_init(void)
 	_cache_init();
 	_hypertable_cache_init();
 	_cache_invalidate_init();
+	_chunk_insert_state_init();
+	_chunk_index_init();
+	_dimension_slice_index_init();
+	_shared_chunk_cache_init();
 	_planner_init();
 	_event_trigger_init();
 	_process_utility_init();
@@ -102,6 +118,10 @@ _PG_fini(void)
 	_process_utility_fini();
 	_event_trigger_fini();
 	_planner_fini();
+	_shared_chunk_cache_fini();
+	_dimension_slice_index_fini();
+	_chunk_index_fini();
+	_chunk_insert_state_fini();
 	_cache_invalidate_fini();
 	_hypertable_cache_fini();
 	_cache_fini();
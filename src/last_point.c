@@ -0,0 +1,1105 @@
+/*
+ * Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+ *
+ * This file is licensed under the Apache License,
+ * see LICENSE-APACHE at the top level directory.
+ */
+#include <postgres.h>
+#include <access/htup_details.h>
+#include <catalog/dependency.h>
+#include <catalog/index.h>
+#include <catalog/pg_class.h>
+#include <catalog/pg_index.h>
+#include <catalog/pg_inherits_fn.h>
+#include <catalog/pg_trigger.h>
+#include <catalog/toasting.h>
+#include <commands/defrem.h>
+#include <commands/tablecmds.h>
+#include <commands/trigger.h>
+#include <access/xact.h>
+#include <executor/spi.h>
+#include <lib/stringinfo.h>
+#include <nodes/makefuncs.h>
+#include <utils/builtins.h>
+#include <utils/fmgroids.h>
+#include <utils/guc.h>
+#include <utils/hsearch.h>
+#include <utils/lsyscache.h>
+#include <utils/memutils.h>
+#include <utils/rel.h>
+#include <utils/syscache.h>
+#include <utils/typcache.h>
+#include <miscadmin.h>
+#include <funcapi.h>
+
+#include "last_point.h"
+#include "hypertable_cache.h"
+#include "catalog.h"
+#include "compat.h"
+#include "errors.h"
+#include "scanner.h"
+#include "trigger.h"
+
+/*
+ * Last-point tables.
+ *
+ * A hypertable can have a last-point table that holds the latest row of each
+ * series, where a series is identified by the value of a series column, e.g.,
+ * a device ID. "Last reading per device" queries can then read one row per
+ * series from that table instead of scanning the newest chunks of every space
+ * partition.
+ *
+ * The table has the hypertable's columns and a unique index on the series
+ * column. It is created next to the hypertable's chunks, in the associated
+ * schema, and named after the associated table prefix (e.g.,
+ * "_timescaledb_internal._hyper_1_last_point"). The hypertable_last_point
+ * catalog table maps the hypertable to the table's name, which is kept
+ * up-to-date when the table is renamed or moved to another schema. Dropping
+ * the table disables tracking and dropping the hypertable drops the table.
+ *
+ * The table is maintained by the chunk dispatch together with an AFTER ROW
+ * trigger on the hypertable's chunks: the trigger passes each row written to
+ * a chunk during an INSERT or COPY to the statement's chunk dispatch, which
+ * remembers the newest row of each series in a hash table and upserts it into
+ * the last-point table at the end of the statement, so the table is written
+ * once per series and statement rather than once per row. Since the trigger
+ * only fires for rows that were actually stored, rows are tracked after any
+ * BEFORE ROW triggers, rows that are not stored due to ON CONFLICT clauses or
+ * triggers are not tracked, and rows written by ON CONFLICT DO UPDATE are
+ * tracked. Rows with a NULL series value are not tracked, and UPDATE or
+ * DELETE statements or dropping chunks do not change last points.
+ *
+ * Renaming a column of the hypertable renames it in the last-point table as
+ * well, and dropping a column drops it from the last-point table. Dropping the
+ * series column drops the last-point table.
+ */
+
+#define LAST_POINT_TABLE_SUFFIX "_last_point"
+#define LAST_POINT_TRIGGER_NAME "ts_last_point"
+#define LAST_POINT_TRIGGER_FUNCTION "last_point_trigger"
+
+/* The upserts run as the table owner, so they must not depend on search_path */
+#define LAST_POINT_SEARCH_PATH "pg_catalog, pg_temp"
+
+/*
+ * The latest row of a series. Series whose values have the same hash are
+ * chained in the same hash table entry.
+ */
+typedef struct LastPoint
+{
+	Datum		series;			/* Series value, points into tuple */
+	int64		time;			/* Internal time of the row */
+	HeapTuple	tuple;
+	struct LastPoint *next;
+} LastPoint;
+
+typedef struct LastPointEntry
+{
+	uint32		hash;			/* Hash of the series value, the key */
+	LastPoint  *points;
+} LastPointEntry;
+
+/*
+ * A chunk that rows are routed to, with the map converting its rows to the
+ * hypertable's rowtype (or NULL if it has the same layout).
+ */
+typedef struct LastPointChunk
+{
+	Oid			relid;			/* The key */
+	bool		map_set;
+	TupleConversionMap *map;
+} LastPointChunk;
+
+struct LastPointState
+{
+	Oid			relid;			/* The last-point table */
+	Oid			owner;			/* Owner of the last-point table */
+	Oid			hypertable_relid;
+	char	   *series_column;
+	char	   *time_column;
+	AttrNumber	series_attno;	/* Series column in the hypertable */
+	Oid			series_collation;
+	FmgrInfo   *hash_proc;
+	FmgrInfo   *eq_proc;
+	Dimension  *time_dim;
+	TupleDesc	tupdesc;		/* The hypertable's, of the tracked tuples */
+	HTAB	   *points;
+	HTAB	   *chunks;			/* Chunks rows are routed to */
+	int64		num_series;
+	MemoryContext mcxt;
+	MemoryContextCallback mcxt_cb;
+	struct LastPointState *next_active;
+};
+
+/*
+ * The states of the statements currently inserting into hypertables with
+ * last-point tables, most recent first. The trigger finds the state to pass
+ * a row to by the chunk it was written to.
+ */
+static LastPointState *active_states = NULL;
+
+static void
+last_point_state_deactivate(void *arg)
+{
+	LastPointState *state = arg;
+	LastPointState **prev;
+
+	for (prev = &active_states; *prev != NULL; prev = &(*prev)->next_active)
+	{
+		if (*prev == state)
+		{
+			*prev = state->next_active;
+			return;
+		}
+	}
+}
+
+static char *
+last_point_table_name(Hypertable *ht)
+{
+	char	   *relname = psprintf("%s" LAST_POINT_TABLE_SUFFIX,
+								   NameStr(ht->fd.associated_table_prefix));
+
+	if (strlen(relname) >= NAMEDATALEN)
+		ereport(ERROR,
+				(errcode(ERRCODE_NAME_TOO_LONG),
+				 errmsg("last-point table name \"%s\" is too long", relname)));
+
+	return relname;
+}
+
+static int
+last_point_catalog_scan(int indexid, ScanKeyData *scankey, int nkeys,
+						tuple_found_func tuple_found, void *data, LOCKMODE lockmode)
+{
+	Catalog    *catalog = ts_catalog_get();
+	ScannerCtx	scanctx = {
+		.table = catalog_get_table_id(catalog, HYPERTABLE_LAST_POINT),
+		.index = catalog_get_index(catalog, HYPERTABLE_LAST_POINT, indexid),
+		.nkeys = nkeys,
+		.scankey = scankey,
+		.tuple_found = tuple_found,
+		.data = data,
+		.lockmode = lockmode,
+		.scandirection = ForwardScanDirection,
+	};
+
+	return ts_scanner_scan(&scanctx);
+}
+
+static ScanTupleResult
+last_point_catalog_tuple_found(TupleInfo *ti, void *data)
+{
+	FormData_hypertable_last_point *form = data;
+
+	memcpy(form, GETSTRUCT(ti->tuple), sizeof(FormData_hypertable_last_point));
+
+	return SCAN_DONE;
+}
+
+static ScanTupleResult
+last_point_catalog_tuple_delete(TupleInfo *ti, void *data)
+{
+	CatalogSecurityContext sec_ctx;
+
+	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+	ts_catalog_delete(ti->scanrel, ti->tuple);
+	ts_catalog_restore_user(&sec_ctx);
+
+	return SCAN_CONTINUE;
+}
+
+static ScanTupleResult
+last_point_catalog_tuple_update(TupleInfo *ti, void *data)
+{
+	HeapTuple	tuple = heap_copytuple(ti->tuple);
+	FormData_hypertable_last_point *form = (FormData_hypertable_last_point *) GETSTRUCT(tuple);
+	FormData_hypertable_last_point *update = data;
+	CatalogSecurityContext sec_ctx;
+
+	namecpy(&form->schema_name, &update->schema_name);
+	namecpy(&form->table_name, &update->table_name);
+
+	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+	ts_catalog_update(ti->scanrel, tuple);
+	ts_catalog_restore_user(&sec_ctx);
+
+	heap_freetuple(tuple);
+
+	return SCAN_DONE;
+}
+
+static void
+last_point_catalog_insert(int32 hypertable_id, const char *schema_name, const char *table_name)
+{
+	Catalog    *catalog = ts_catalog_get();
+	Relation	rel;
+	TupleDesc	desc;
+	Datum		values[Natts_hypertable_last_point];
+	bool		nulls[Natts_hypertable_last_point] = {false};
+	CatalogSecurityContext sec_ctx;
+
+	rel = heap_open(catalog_get_table_id(catalog, HYPERTABLE_LAST_POINT), RowExclusiveLock);
+	desc = RelationGetDescr(rel);
+
+	values[AttrNumberGetAttrOffset(Anum_hypertable_last_point_hypertable_id)] =
+		Int32GetDatum(hypertable_id);
+	values[AttrNumberGetAttrOffset(Anum_hypertable_last_point_schema_name)] =
+		DirectFunctionCall1(namein, CStringGetDatum(schema_name));
+	values[AttrNumberGetAttrOffset(Anum_hypertable_last_point_table_name)] =
+		DirectFunctionCall1(namein, CStringGetDatum(table_name));
+
+	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+	ts_catalog_insert_values(rel, desc, values, nulls);
+	ts_catalog_restore_user(&sec_ctx);
+
+	heap_close(rel, RowExclusiveLock);
+}
+
+static void
+last_point_catalog_delete(int32 hypertable_id)
+{
+	ScanKeyData scankey[1];
+
+	ScanKeyInit(&scankey[0], Anum_hypertable_last_point_pkey_idx_hypertable_id,
+				BTEqualStrategyNumber, F_INT4EQ, Int32GetDatum(hypertable_id));
+
+	last_point_catalog_scan(HYPERTABLE_LAST_POINT_PKEY_IDX, scankey, 1,
+							last_point_catalog_tuple_delete, NULL, RowExclusiveLock);
+}
+
+static int
+last_point_catalog_scan_by_name(const char *schema_name, const char *table_name,
+								tuple_found_func tuple_found, void *data, LOCKMODE lockmode)
+{
+	ScanKeyData scankey[2];
+
+	ScanKeyInit(&scankey[0], Anum_hypertable_last_point_schema_name_table_name_idx_schema_name,
+				BTEqualStrategyNumber, F_NAMEEQ,
+				DirectFunctionCall1(namein, CStringGetDatum(schema_name)));
+	ScanKeyInit(&scankey[1], Anum_hypertable_last_point_schema_name_table_name_idx_table_name,
+				BTEqualStrategyNumber, F_NAMEEQ,
+				DirectFunctionCall1(namein, CStringGetDatum(table_name)));
+
+	return last_point_catalog_scan(HYPERTABLE_LAST_POINT_SCHEMA_NAME_TABLE_NAME_IDX,
+								   scankey, 2, tuple_found, data, lockmode);
+}
+
+/*
+ * Get the last-point table of a hypertable from the catalog.
+ *
+ * Returns InvalidOid if the hypertable has no last-point table. If
+ * catalog_found is given, it is set to whether the hypertable has a catalog
+ * entry, which is only the case without a table if the table was dropped
+ * internally.
+ */
+static Oid
+last_point_table_relid(int32 hypertable_id, bool *catalog_found)
+{
+	FormData_hypertable_last_point form;
+	ScanKeyData scankey[1];
+	Oid			nspid;
+	int			num_found;
+
+	ScanKeyInit(&scankey[0], Anum_hypertable_last_point_pkey_idx_hypertable_id,
+				BTEqualStrategyNumber, F_INT4EQ, Int32GetDatum(hypertable_id));
+
+	num_found = last_point_catalog_scan(HYPERTABLE_LAST_POINT_PKEY_IDX, scankey, 1,
+										last_point_catalog_tuple_found, &form,
+										AccessShareLock);
+
+	if (NULL != catalog_found)
+		*catalog_found = num_found > 0;
+
+	if (num_found == 0)
+		return InvalidOid;
+
+	nspid = get_namespace_oid(NameStr(form.schema_name), true);
+
+	if (!OidIsValid(nspid))
+		return InvalidOid;
+
+	return get_relname_relid(NameStr(form.table_name), nspid);
+}
+
+/*
+ * Remove the catalog entry of a dropped last-point table.
+ */
+void
+ts_last_point_delete_by_name(const char *schema_name, const char *table_name)
+{
+	last_point_catalog_scan_by_name(schema_name, table_name,
+									last_point_catalog_tuple_delete, NULL,
+									RowExclusiveLock);
+}
+
+/*
+ * Remove the catalog entry of a hypertable's last-point table, e.g., when the
+ * hypertable is deleted.
+ */
+void
+ts_last_point_delete_by_hypertable_id(int32 hypertable_id)
+{
+	last_point_catalog_delete(hypertable_id);
+}
+
+static void
+last_point_catalog_set_name(Oid relid, const char *schema_name, const char *table_name)
+{
+	FormData_hypertable_last_point update;
+
+	namestrcpy(&update.schema_name, schema_name);
+	namestrcpy(&update.table_name, table_name);
+
+	last_point_catalog_scan_by_name(get_namespace_name(get_rel_namespace(relid)),
+									get_rel_name(relid),
+									last_point_catalog_tuple_update, &update,
+									RowExclusiveLock);
+}
+
+/*
+ * Update the catalog entry of a last-point table that is being renamed.
+ */
+void
+ts_last_point_set_name(Oid relid, const char *newname)
+{
+	last_point_catalog_set_name(relid, get_namespace_name(get_rel_namespace(relid)), newname);
+}
+
+/*
+ * Update the catalog entry of a last-point table that is being moved to
+ * another schema.
+ */
+void
+ts_last_point_set_schema(Oid relid, const char *newschema)
+{
+	last_point_catalog_set_name(relid, newschema, get_rel_name(relid));
+}
+
+static ScanTupleResult
+last_point_catalog_rename_schema_name(TupleInfo *ti, void *data)
+{
+	HeapTuple	tuple = heap_copytuple(ti->tuple);
+	FormData_hypertable_last_point *form = (FormData_hypertable_last_point *) GETSTRUCT(tuple);
+
+	namestrcpy(&form->schema_name, (char *) data);
+	ts_catalog_update(ti->scanrel, tuple);
+	heap_freetuple(tuple);
+
+	return SCAN_CONTINUE;
+}
+
+/*
+ * Update the catalog entries of last-point tables in a schema that is being
+ * renamed.
+ */
+void
+ts_last_point_rename_schema_name(const char *old_name, const char *new_name)
+{
+	NameData	old_schema_name;
+	ScanKeyData scankey[1];
+
+	namestrcpy(&old_schema_name, old_name);
+
+	ScanKeyInit(&scankey[0], Anum_hypertable_last_point_schema_name_table_name_idx_schema_name,
+				BTEqualStrategyNumber, F_NAMEEQ,
+				NameGetDatum(&old_schema_name));
+
+	last_point_catalog_scan(HYPERTABLE_LAST_POINT_SCHEMA_NAME_TABLE_NAME_IDX, scankey, 1,
+							last_point_catalog_rename_schema_name, (char *) new_name,
+							RowExclusiveLock);
+}
+
+/*
+ * Create the state to track the last points of the rows inserted into a
+ * hypertable.
+ *
+ * Returns NULL if the hypertable has no last-point table.
+ */
+LastPointState *
+ts_last_point_state_create(Hypertable *ht, MemoryContext mcxt)
+{
+	Oid			relid = last_point_table_relid(ht->fd.id, NULL);
+	LastPointState *state;
+	Relation	rel;
+	Relation	htrel;
+	AttrNumber	attno;
+	Oid			typid;
+	int32		typmod;
+	TypeCacheEntry *tce;
+	Dimension  *time_dim;
+	MemoryContext old;
+	HASHCTL		hctl = {
+		.keysize = sizeof(uint32),
+		.entrysize = sizeof(LastPointEntry),
+	};
+	HASHCTL		chunks_hctl = {
+		.keysize = sizeof(Oid),
+		.entrysize = sizeof(LastPointChunk),
+	};
+
+	if (!OidIsValid(relid))
+		return NULL;
+
+	/* Lock the table now for the upserts at the end of the statement */
+	rel = heap_open(relid, RowExclusiveLock);
+	htrel = heap_open(ht->main_table_relid, AccessShareLock);
+	attno = last_point_table_series_attno(rel);
+
+	if (attno == InvalidAttrNumber)
+		ereport(ERROR,
+				(errcode(ERRCODE_TS_INTERNAL_ERROR),
+				 errmsg("last-point table \"%s\" has no unique index on a series column",
+						RelationGetRelationName(rel))));
+
+	state = MemoryContextAllocZero(mcxt, sizeof(LastPointState));
+	state->mcxt = AllocSetContextCreate(mcxt,
+										"Last points",
+										ALLOCSET_DEFAULT_SIZES);
+	state->relid = relid;
+	state->owner = rel->rd_rel->relowner;
+	state->hypertable_relid = ht->main_table_relid;
+	state->series_column =
+		MemoryContextStrdup(mcxt, NameStr(RelationGetDescr(rel)->attrs[attno - 1]->attname));
+	state->series_attno = get_attnum(ht->main_table_relid, state->series_column);
+
+	heap_close(rel, NoLock);
+
+	if (state->series_attno == InvalidAttrNumber)
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_COLUMN),
+				 errmsg("series column \"%s\" does not exist in hypertable \"%s\"",
+						state->series_column, get_rel_name(ht->main_table_relid))));
+
+	get_atttypetypmodcoll(ht->main_table_relid, state->series_attno,
+						  &typid, &typmod, &state->series_collation);
+	tce = series_type_lookup(typid, state->series_column);
+	state->hash_proc = &tce->hash_proc_finfo;
+	state->eq_proc = &tce->eq_opr_finfo;
+
+	time_dim = hyperspace_get_open_dimension(ht->space, 0);
+	state->time_dim = time_dim;
+	state->time_column = MemoryContextStrdup(mcxt, NameStr(time_dim->fd.column_name));
+
+	old = MemoryContextSwitchTo(state->mcxt);
+	state->tupdesc = CreateTupleDescCopy(RelationGetDescr(htrel));
+	MemoryContextSwitchTo(old);
+
+	heap_close(htrel, AccessShareLock);
+
+	hctl.hcxt = state->mcxt;
+	state->points = hash_create("Last points", 64, &hctl,
+								HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	chunks_hctl.hcxt = state->mcxt;
+	state->chunks = hash_create("Last point chunks", 16, &chunks_hctl,
+								HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+	/* The state is no longer active once freed, e.g., on abort */
+	state->mcxt_cb.func = last_point_state_deactivate;
+	state->mcxt_cb.arg = state;
+	MemoryContextRegisterResetCallback(state->mcxt, &state->mcxt_cb);
+	state->next_active = active_states;
+	active_states = state;
+
+	return state;
+}
+
+/*
+ * Add a chunk that the statement routes rows to, so that the rows written to
+ * the chunk are tracked.
+ */
+void
+ts_last_point_add_chunk(LastPointState *state, Oid chunk_relid)
+{
+	LastPointChunk *chunk;
+	bool		found;
+
+	chunk = hash_search(state->chunks, &chunk_relid, HASH_ENTER, &found);
+
+	if (!found)
+	{
+		chunk->map_set = false;
+		chunk->map = NULL;
+	}
+}
+
+/*
+ * Remember a row written to a chunk if it is the latest row of its series.
+ *
+ * The tuple is in the hypertable's rowtype.
+ */
+static void
+last_point_track(LastPointState *state, HeapTuple tuple)
+{
+	LastPointEntry *entry;
+	LastPoint  *lp;
+	MemoryContext old;
+	Datum		series;
+	Datum		timeval;
+	int64		time;
+	uint32		hash;
+	bool		isnull;
+	bool		found;
+
+	series = heap_getattr(tuple, state->series_attno, state->tupdesc, &isnull);
+
+	if (isnull)
+		return;
+
+	timeval = heap_getattr(tuple, state->time_dim->column_attno, state->tupdesc, &isnull);
+
+	if (isnull)
+		return;
+
+	time = state->time_dim->coordinate_func(state->time_dim, timeval);
+	hash = DatumGetUInt32(FunctionCall1Coll(state->hash_proc, state->series_collation, series));
+	entry = hash_search(state->points, &hash, HASH_ENTER, &found);
+
+	if (!found)
+		entry->points = NULL;
+
+	for (lp = entry->points; lp != NULL; lp = lp->next)
+		if (DatumGetBool(FunctionCall2Coll(state->eq_proc, state->series_collation,
+										   lp->series, series)))
+			break;
+
+	/* Of rows with the same time, the one written last wins */
+	if (NULL != lp && lp->time > time)
+		return;
+
+	old = MemoryContextSwitchTo(state->mcxt);
+
+	if (NULL == lp)
+	{
+		lp = palloc(sizeof(LastPoint));
+		lp->next = entry->points;
+		entry->points = lp;
+		state->num_series++;
+	}
+	else
+		heap_freetuple(lp->tuple);
+
+	lp->time = time;
+	lp->tuple = heap_copytuple(tuple);
+	lp->series = heap_getattr(lp->tuple, state->series_attno, state->tupdesc, &isnull);
+
+	MemoryContextSwitchTo(old);
+}
+
+TS_FUNCTION_INFO_V1(ts_last_point_trigger);
+
+/*
+ * AFTER ROW trigger on the chunks of hypertables with a last-point table.
+ *
+ * Passes rows inserted into chunks, or updated by ON CONFLICT DO UPDATE, to
+ * the state of the statement that routed them. Rows written by statements
+ * that do not track last points, e.g., UPDATE statements, are ignored.
+ */
+Datum
+ts_last_point_trigger(PG_FUNCTION_ARGS)
+{
+	TriggerData *trigdata = (TriggerData *) fcinfo->context;
+	LastPointState *state;
+	LastPointChunk *chunk = NULL;
+	HeapTuple	tuple;
+	Oid			relid;
+
+	if (!CALLED_AS_TRIGGER(fcinfo))
+		elog(ERROR, "last_point_trigger: not called by trigger manager");
+
+	if (!TRIGGER_FIRED_AFTER(trigdata->tg_event) ||
+		!TRIGGER_FIRED_FOR_ROW(trigdata->tg_event))
+		elog(ERROR, "last_point_trigger: must be fired after row");
+
+	relid = RelationGetRelid(trigdata->tg_relation);
+
+	for (state = active_states; state != NULL; state = state->next_active)
+	{
+		chunk = hash_search(state->chunks, &relid, HASH_FIND, NULL);
+
+		if (NULL != chunk)
+			break;
+	}
+
+	if (NULL == state)
+		PG_RETURN_NULL();
+
+	if (TRIGGER_FIRED_BY_UPDATE(trigdata->tg_event))
+		tuple = trigdata->tg_newtuple;
+	else
+		tuple = trigdata->tg_trigtuple;
+
+	if (!chunk->map_set)
+	{
+		MemoryContext old = MemoryContextSwitchTo(state->mcxt);
+
+		chunk->map = convert_tuples_by_name(CreateTupleDescCopy(RelationGetDescr(trigdata->tg_relation)),
+											state->tupdesc,
+											gettext_noop("could not convert row type"));
+		chunk->map_set = true;
+		MemoryContextSwitchTo(old);
+	}
+
+	if (NULL != chunk->map)
+		tuple = do_convert_tuple(tuple, chunk->map);
+
+	last_point_track(state, tuple);
+
+	PG_RETURN_NULL();
+}
+
+/*
+ * Upsert the tracked last points into the last-point table.
+ *
+ * A row replaces the stored row of its series unless the stored row is newer.
+ * The table is written as its owner, so that inserting into the hypertable
+ * does not require privileges on the last-point table, and with a search_path
+ * that the inserting user cannot put objects in.
+ */
+void
+ts_last_point_state_flush(LastPointState *state)
+{
+	Relation	rel;
+	TupleDesc	desc;
+	StringInfoData command;
+	StringInfoData values;
+	StringInfoData set;
+	AttrNumber *attnos;
+	Oid		   *argtypes;
+	Datum	   *args;
+	char	   *argnulls;
+	Datum	   *tupvalues;
+	bool	   *tupnulls;
+	int			nargs = 0;
+	int			i;
+	SPIPlanPtr	plan;
+	HASH_SEQ_STATUS status;
+	LastPointEntry *entry;
+	Oid			saved_uid;
+	int			sec_ctx;
+	int			save_nestlevel;
+
+	if (NULL == state)
+		return;
+
+	/* Rows are no longer passed to the state */
+	last_point_state_deactivate(state);
+
+	if (state->num_series == 0)
+		return;
+
+	rel = heap_open(state->relid, NoLock);
+	desc = RelationGetDescr(rel);
+	attnos = palloc(sizeof(AttrNumber) * desc->natts);
+	argtypes = palloc(sizeof(Oid) * desc->natts);
+
+	initStringInfo(&command);
+	initStringInfo(&values);
+	initStringInfo(&set);
+
+	appendStringInfo(&command, "INSERT INTO %s AS t (",
+					 relation_qualified_name(state->relid));
+
+	/* Columns added to the hypertable later are not in the last-point table */
+	for (i = 0; i < desc->natts; i++)
+	{
+		Form_pg_attribute attr = desc->attrs[i];
+		const char *colname = quote_identifier(NameStr(attr->attname));
+		AttrNumber	attno;
+
+		if (attr->attisdropped)
+			continue;
+
+		attno = get_attnum(state->hypertable_relid, NameStr(attr->attname));
+
+		if (attno == InvalidAttrNumber)
+			continue;
+
+		attnos[nargs] = attno;
+		argtypes[nargs] = state->tupdesc->attrs[attno - 1]->atttypid;
+		nargs++;
+
+		appendStringInfo(&command, "%s%s", nargs > 1 ? ", " : "", colname);
+		appendStringInfo(&values, "%s$%d", nargs > 1 ? ", " : "", nargs);
+		appendStringInfo(&set, "%s%s = excluded.%s", nargs > 1 ? ", " : "",
+						 colname, colname);
+	}
+
+	heap_close(rel, NoLock);
+
+	appendStringInfo(&command,
+					 ") VALUES (%s) ON CONFLICT (%s) DO UPDATE SET %s "
+					 "WHERE t.%s OPERATOR(pg_catalog.<=) excluded.%s",
+					 values.data,
+					 quote_identifier(state->series_column),
+					 set.data,
+					 quote_identifier(state->time_column),
+					 quote_identifier(state->time_column));
+
+	args = palloc(sizeof(Datum) * nargs);
+	argnulls = palloc(sizeof(char) * nargs);
+	tupvalues = palloc(sizeof(Datum) * state->tupdesc->natts);
+	tupnulls = palloc(sizeof(bool) * state->tupdesc->natts);
+
+	GetUserIdAndSecContext(&saved_uid, &sec_ctx);
+
+	if (state->owner != saved_uid)
+		SetUserIdAndSecContext(state->owner, sec_ctx | SECURITY_LOCAL_USERID_CHANGE);
+
+	save_nestlevel = last_point_set_search_path();
+
+	if (SPI_connect() != SPI_OK_CONNECT)
+		elog(ERROR, "could not connect to SPI");
+
+	plan = SPI_prepare(command.data, nargs, argtypes);
+
+	if (NULL == plan)
+		elog(ERROR, "could not prepare last-point upsert: %s",
+			 SPI_result_code_string(SPI_result));
+
+	hash_seq_init(&status, state->points);
+
+	while ((entry = hash_seq_search(&status)) != NULL)
+	{
+		LastPoint  *lp;
+
+		for (lp = entry->points; lp != NULL; lp = lp->next)
+		{
+			heap_deform_tuple(lp->tuple, state->tupdesc, tupvalues, tupnulls);
+
+			for (i = 0; i < nargs; i++)
+			{
+				args[i] = tupvalues[attnos[i] - 1];
+				argnulls[i] = tupnulls[attnos[i] - 1] ? 'n' : ' ';
+			}
+
+			if (SPI_execute_plan(plan, args, argnulls, false, 0) != SPI_OK_INSERT)
+				elog(ERROR, "could not upsert last point");
+		}
+	}
+
+	SPI_finish();
+
+	AtEOXact_GUC(false, save_nestlevel);
+
+	if (state->owner != saved_uid)
+		SetUserIdAndSecContext(saved_uid, sec_ctx);
+}
+
+/*
+ * Rename a column of a hypertable's last-point table along with the column of
+ * the hypertable.
+ */
+void
+ts_last_point_rename_column(Hypertable *ht, const char *oldname, const char *newname)
+{
+	Oid			relid = last_point_table_relid(ht->fd.id, NULL);
+	RenameStmt	stmt = {
+		.type = T_RenameStmt,
+		.renameType = OBJECT_COLUMN,
+		.relationType = OBJECT_TABLE,
+		.subname = pstrdup(oldname),
+		.newname = pstrdup(newname),
+	};
+
+	if (!OidIsValid(relid) || get_attnum(relid, oldname) == InvalidAttrNumber)
+		return;
+
+	stmt.relation = makeRangeVar(get_namespace_name(get_rel_namespace(relid)),
+								 get_rel_name(relid), -1);
+	renameatt(&stmt);
+}
+
+/*
+ * Drop a column of a hypertable's last-point table along with the column of
+ * the hypertable. Dropping the series column drops the last-point table, i.e.,
+ * the last points of the hypertable are no longer tracked.
+ */
+void
+ts_last_point_drop_column(Hypertable *ht, const char *colname)
+{
+	Oid			relid = last_point_table_relid(ht->fd.id, NULL);
+	ObjectAddress objaddr;
+	Relation	rel;
+	AttrNumber	attno;
+	AttrNumber	series_attno;
+
+	if (!OidIsValid(relid))
+		return;
+
+	rel = heap_open(relid, AccessExclusiveLock);
+	attno = get_attnum(relid, colname);
+	series_attno = last_point_table_series_attno(rel);
+	heap_close(rel, NoLock);
+
+	if (attno == InvalidAttrNumber)
+		return;
+
+	if (attno == series_attno)
+	{
+		ereport(NOTICE,
+				(errmsg("dropping last-point table \"%s\" of hypertable \"%s\"",
+						get_rel_name(relid), get_rel_name(ht->main_table_relid)),
+				 errdetail("The series column \"%s\" is dropped.", colname)));
+		ObjectAddressSet(objaddr, RelationRelationId, relid);
+		last_point_catalog_delete(ht->fd.id);
+	}
+	else
+		ObjectAddressSubSet(objaddr, RelationRelationId, relid, attno);
+
+	performDeletion(&objaddr, DROP_RESTRICT, PERFORM_DELETION_INTERNAL);
+}
+
+/*
+ * Create the last-point table of a hypertable.
+ *
+ * The table is created with the same permissions rules as chunks: as the
+ * catalog owner in the internal schema and as the hypertable owner in other
+ * schemas. It is owned by the hypertable owner.
+ */
+static Oid
+last_point_table_create(Hypertable *ht, Relation htrel, const char *relname,
+						const char *series_column)
+{
+	TupleDesc	tupdesc = RelationGetDescr(htrel);
+	CreateStmt	stmt = {
+		.type = T_CreateStmt,
+		.relation = makeRangeVar(NameStr(ht->fd.associated_schema_name), pstrdup(relname), 0),
+	};
+	IndexElem	elem = {
+		.type = T_IndexElem,
+		.name = pstrdup(series_column),
+	};
+	IndexStmt	idxstmt = {
+		.type = T_IndexStmt,
+		.accessMethod = DEFAULT_INDEX_TYPE,
+		.relation = stmt.relation,
+		.indexParams = list_make1(&elem),
+		.unique = true,
+	};
+	ObjectAddress objaddr;
+	ObjectAddress htaddr;
+	Oid			uid,
+				saved_uid;
+	int			sec_ctx;
+	int			i;
+
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = tupdesc->attrs[i];
+		ColumnDef  *coldef;
+
+		if (attr->attisdropped)
+			continue;
+
+		coldef = makeNode(ColumnDef);
+		coldef->colname = pstrdup(NameStr(attr->attname));
+		coldef->typeName = makeTypeNameFromOid(attr->atttypid, attr->atttypmod);
+		coldef->collOid = attr->attcollation;
+		coldef->is_local = true;
+		coldef->is_not_null = attr->attnotnull ||
+			namestrcmp(&attr->attname, series_column) == 0;
+		coldef->location = -1;
+		stmt.tableElts = lappend(stmt.tableElts, coldef);
+	}
+
+	if (namestrcmp(&ht->fd.associated_schema_name, INTERNAL_SCHEMA_NAME) == 0)
+		uid = ts_catalog_database_info_get()->owner_uid;
+	else
+		uid = htrel->rd_rel->relowner;
+
+	GetUserIdAndSecContext(&saved_uid, &sec_ctx);
+
+	if (uid != saved_uid)
+		SetUserIdAndSecContext(uid, sec_ctx | SECURITY_LOCAL_USERID_CHANGE);
+
+	objaddr = DefineRelation(&stmt,
+							 RELKIND_RELATION,
+							 htrel->rd_rel->relowner,
+							 NULL
+#if PG10
+							 ,NULL
+#endif
+		);
+
+	NewRelationCreateToastTable(objaddr.objectId, (Datum) 0);
+	CommandCounterIncrement();
+
+	DefineIndex(objaddr.objectId,
+				&idxstmt,
+				InvalidOid,
+				false,			/* is alter table */
+				false,			/* check rights */
+#if PG10
+				false,			/* check not in use */
+#endif
+				false,			/* skip_build */
+				true);			/* quiet */
+
+	if (uid != saved_uid)
+		SetUserIdAndSecContext(saved_uid, sec_ctx);
+
+	/* Drop the last-point table together with the hypertable */
+	ObjectAddressSet(htaddr, RelationRelationId, RelationGetRelid(htrel));
+	recordDependencyOn(&objaddr, &htaddr, DEPENDENCY_AUTO);
+
+	CommandCounterIncrement();
+
+	return objaddr.objectId;
+}
+
+/*
+ * Add the trigger that passes the rows written to chunks to the last-point
+ * tracking to a hypertable and its chunks. Chunks created later get the
+ * trigger from the hypertable, like other row triggers.
+ *
+ * The trigger is kept if the last-point table is dropped, in which case it
+ * does nothing, so it might already exist.
+ */
+static void
+last_point_trigger_add(Oid table_relid)
+{
+	CreateTrigStmt stmt = {
+		.type = T_CreateTrigStmt,
+		.row = true,
+		.timing = TRIGGER_TYPE_AFTER,
+		.trigname = LAST_POINT_TRIGGER_NAME,
+		.relation = makeRangeVar(get_namespace_name(get_rel_namespace(table_relid)),
+								 get_rel_name(table_relid), -1),
+		.funcname = list_make2(makeString(INTERNAL_SCHEMA_NAME),
+							   makeString(LAST_POINT_TRIGGER_FUNCTION)),
+		.args = NIL,
+		.events = TRIGGER_TYPE_INSERT | TRIGGER_TYPE_UPDATE,
+	};
+	ObjectAddress objaddr;
+	List	   *chunks;
+	ListCell   *lc;
+
+	if (NULL != ts_trigger_by_name(table_relid, LAST_POINT_TRIGGER_NAME, true))
+		return;
+
+	objaddr = CreateTrigger(&stmt, NULL, table_relid, InvalidOid, InvalidOid, InvalidOid, false);
+
+	if (!OidIsValid(objaddr.objectId))
+		elog(ERROR, "could not create last-point trigger");
+
+	CommandCounterIncrement();
+
+	chunks = find_inheritance_children(table_relid, NoLock);
+
+	foreach(lc, chunks)
+	{
+		Oid			chunk_relid = lfirst_oid(lc);
+
+		ts_trigger_create_on_chunk(objaddr.objectId,
+								   get_namespace_name(get_rel_namespace(chunk_relid)),
+								   get_rel_name(chunk_relid));
+	}
+}
+
+/*
+ * Fill a new last-point table with the latest row of each series already in
+ * the hypertable.
+ */
+static void
+last_point_table_populate(Oid relid, Oid hypertable_relid,
+						  const char *series_column, const char *time_column)
+{
+	StringInfoData command;
+	int			save_nestlevel;
+
+	initStringInfo(&command);
+	appendStringInfo(&command,
+					 "INSERT INTO %s SELECT DISTINCT ON (%s) * FROM %s "
+					 "WHERE %s IS NOT NULL ORDER BY %s, %s DESC",
+					 relation_qualified_name(relid),
+					 quote_identifier(series_column),
+					 relation_qualified_name(hypertable_relid),
+					 quote_identifier(series_column),
+					 quote_identifier(series_column),
+					 quote_identifier(time_column));
+
+	save_nestlevel = last_point_set_search_path();
+
+	if (SPI_connect() != SPI_OK_CONNECT)
+		elog(ERROR, "could not connect to SPI");
+
+	if (SPI_execute(command.data, false, 0) != SPI_OK_INSERT)
+		elog(ERROR, "could not populate last-point table");
+
+	SPI_finish();
+
+	AtEOXact_GUC(false, save_nestlevel);
+}
+
+TS_FUNCTION_INFO_V1(ts_last_point_enable);
+
+/*
+ * Create a last-point table for a hypertable.
+ *
+ * hypertable - the hypertable to track the last points of
+ * series_column - the column that identifies a series
+ *
+ * Returns the last-point table.
+ */
+Datum
+ts_last_point_enable(PG_FUNCTION_ARGS)
+{
+	Oid			table_relid = PG_GETARG_OID(0);
+	Name		series_column = PG_GETARG_NAME(1);
+	Cache	   *hcache;
+	Hypertable *ht;
+	Relation	rel;
+	AttrNumber	attno;
+	char	   *relname;
+	Oid			relid;
+	bool		catalog_found;
+
+	ts_hypertable_permissions_check(table_relid, GetUserId());
+
+	hcache = ts_hypertable_cache_pin();
+	ht = ts_hypertable_cache_get_entry(hcache, table_relid);
+
+	if (NULL == ht)
+		ereport(ERROR,
+				(errcode(ERRCODE_TS_HYPERTABLE_NOT_EXIST),
+				 errmsg("table \"%s\" is not a hypertable",
+						get_rel_name(table_relid))));
+
+	attno = get_attnum(table_relid, NameStr(*series_column));
+
+	if (attno == InvalidAttrNumber)
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_COLUMN),
+				 errmsg("column \"%s\" does not exist", NameStr(*series_column))));
+
+	series_type_lookup(get_atttype(table_relid, attno), NameStr(*series_column));
+
+	relname = last_point_table_name(ht);
+
+	if (OidIsValid(last_point_table_relid(ht->fd.id, &catalog_found)))
+		ereport(ERROR,
+				(errcode(ERRCODE_DUPLICATE_TABLE),
+				 errmsg("hypertable \"%s\" already has a last-point table",
+						get_rel_name(table_relid))));
+
+	/* The entry of a table that was dropped internally */
+	if (catalog_found)
+		last_point_catalog_delete(ht->fd.id);
+
+	/* Block inserts until the table is populated */
+	rel = heap_open(table_relid, ShareRowExclusiveLock);
+	relid = last_point_table_create(ht, rel, relname, NameStr(*series_column));
+	last_point_catalog_insert(ht->fd.id, NameStr(ht->fd.associated_schema_name), relname);
+	last_point_trigger_add(table_relid);
+	heap_close(rel, NoLock);
+
+	last_point_table_populate(relid,
+							  table_relid,
+							  NameStr(*series_column),
+							  NameStr(hyperspace_get_open_dimension(ht->space, 0)->fd.column_name));
+
+	ts_cache_release(hcache);
+
+	PG_RETURN_OID(relid);
+}
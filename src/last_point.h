@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+ *
+ * This file is licensed under the Apache License,
+ * see LICENSE-APACHE at the top level directory.
+ */
+#ifndef TIMESCALEDB_LAST_POINT_H
+#define TIMESCALEDB_LAST_POINT_H
+
+#include <postgres.h>
+
+#include "hypertable.h"
+#include "dimension.h"
+
+typedef struct LastPointState LastPointState;
+
+extern LastPointState *ts_last_point_state_create(Hypertable *ht, MemoryContext mcxt);
+extern void ts_last_point_add_chunk(LastPointState *state, Oid chunk_relid);
+extern void ts_last_point_state_flush(LastPointState *state);
+extern void ts_last_point_rename_column(Hypertable *ht, const char *oldname, const char *newname);
+extern void ts_last_point_drop_column(Hypertable *ht, const char *colname);
+extern void ts_last_point_delete_by_name(const char *schema_name, const char *table_name);
+extern void ts_last_point_delete_by_hypertable_id(int32 hypertable_id);
+extern void ts_last_point_set_name(Oid relid, const char *newname);
+extern void ts_last_point_set_schema(Oid relid, const char *newschema);
+extern void ts_last_point_rename_schema_name(const char *old_name, const char *new_name);
+
+#endif							/* TIMESCALEDB_LAST_POINT_H */
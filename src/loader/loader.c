@@ -35,6 +35,7 @@
 #include "bgw_launcher.h"
 #include "bgw_message_queue.h"
 #include "bgw_interface.h"
+#include "shared_chunk_cache_shmem.h"
 
 /*
  * Loading process:
@@ -395,6 +396,7 @@ timescale_shmem_startup_hook(void)
 		prev_shmem_startup_hook();
 	ts_bgw_counter_shmem_startup();
 	bgw_message_queue_shmem_startup();
+	ts_shared_chunk_cache_shmem_startup();
 }
 
 static void
@@ -421,6 +423,8 @@ _PG_init(void)
 	ts_bgw_cluster_launcher_register();
 	ts_bgw_counter_setup_gucs();
 	ts_bgw_interface_register_api_version();
+	ts_shared_chunk_cache_setup_gucs();
+	ts_shared_chunk_cache_shmem_alloc();
 
 	/* This is a safety-valve variable to prevent loading the full extension */
 	DefineCustomBoolVariable(GUC_DISABLE_LOAD_NAME, "Disable the loading of the actual extension",
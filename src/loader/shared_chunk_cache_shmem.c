@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+ *
+ * This file is licensed under the Apache License,
+ * see LICENSE-APACHE at the top level directory.
+ */
+#include <postgres.h>
+
+#include <fmgr.h>
+#include <miscadmin.h>
+#include <storage/lwlock.h>
+#include <storage/shmem.h>
+#include <utils/guc.h>
+#include <utils/hsearch.h>
+
+#include "shared_chunk_cache_shmem.h"
+#include "../shared_chunk_cache.h"
+
+/*
+ * The loader allocates the shared chunk cache, since the versioned extension
+ * library is not preloaded and thus cannot reserve shared memory. The cache
+ * itself is used by the versioned library, which finds it through a
+ * rendezvous variable.
+ *
+ * The shared memory is allocated even if the cache is disabled, since it also
+ * holds the counters of transactions that create dimension slices. The
+ * chunks are kept in a shared hash table, which the versioned library
+ * attaches to by name.
+ */
+
+int			ts_guc_shared_chunk_cache_size = 1024;
+
+extern void
+ts_shared_chunk_cache_setup_gucs(void)
+{
+	DefineCustomIntVariable("timescaledb.shared_chunk_cache_size",
+							"Number of chunks in the shared chunk cache",
+							"Number of chunks whose extent is cached in shared memory for all "
+							"backends to find chunks without catalog scans - set to 0 to disable",
+							&ts_guc_shared_chunk_cache_size,
+							ts_guc_shared_chunk_cache_size,
+							0,
+							65536,
+							PGC_POSTMASTER,
+							0,
+							NULL,
+							NULL,
+							NULL);
+}
+
+static Size
+shared_chunk_cache_hash_size(void)
+{
+	if (ts_guc_shared_chunk_cache_size <= 0)
+		return 0;
+
+	return hash_estimate_size(ts_guc_shared_chunk_cache_size, sizeof(SharedChunkCacheEntry));
+}
+
+/*
+ * This gets called by the loader (and therefore the postmaster) at
+ * shared_preload_libraries time
+ */
+extern void
+ts_shared_chunk_cache_shmem_alloc(void)
+{
+	RequestAddinShmemSpace(add_size(MAXALIGN(sizeof(SharedChunkCache)),
+									shared_chunk_cache_hash_size()));
+	RequestNamedLWLockTranche(SHARED_CHUNK_CACHE_TRANCHE_NAME, 1);
+}
+
+extern void
+ts_shared_chunk_cache_shmem_startup(void)
+{
+	SharedChunkCache *cache;
+	void	  **cacheptr;
+	bool		found;
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	cache = ShmemInitStruct(SHARED_CHUNK_CACHE_NAME, sizeof(SharedChunkCache), &found);
+	if (!found)
+	{
+		memset(cache, 0, sizeof(SharedChunkCache));
+		cache->layout_version = SHARED_CHUNK_CACHE_LAYOUT_VERSION;
+		cache->max_entries = ts_guc_shared_chunk_cache_size;
+		cache->lock = &(GetNamedLWLockTranche(SHARED_CHUNK_CACHE_TRANCHE_NAME))->lock;
+	}
+
+	if (cache->max_entries > 0)
+	{
+		HASHCTL		hctl = {
+			.keysize = sizeof(SharedChunkCacheKey),
+			.entrysize = sizeof(SharedChunkCacheEntry),
+		};
+
+		ShmemInitHash(SHARED_CHUNK_CACHE_HASH_NAME,
+					  cache->max_entries,
+					  cache->max_entries,
+					  &hctl,
+					  HASH_ELEM | HASH_BLOBS);
+	}
+	LWLockRelease(AddinShmemInitLock);
+
+	cacheptr = find_rendezvous_variable(RENDEZVOUS_SHARED_CHUNK_CACHE);
+	*cacheptr = cache;
+}
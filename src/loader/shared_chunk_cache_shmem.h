@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+ *
+ * This file is licensed under the Apache License,
+ * see LICENSE-APACHE at the top level directory.
+ */
+#ifndef TIMESCALEDB_SHARED_CHUNK_CACHE_SHMEM_H
+#define TIMESCALEDB_SHARED_CHUNK_CACHE_SHMEM_H
+
+#include <postgres.h>
+
+extern int	ts_guc_shared_chunk_cache_size;
+
+extern void ts_shared_chunk_cache_setup_gucs(void);
+extern void ts_shared_chunk_cache_shmem_alloc(void);
+extern void ts_shared_chunk_cache_shmem_startup(void);
+
+#endif							/* TIMESCALEDB_SHARED_CHUNK_CACHE_SHMEM_H */
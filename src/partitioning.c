@@ -19,6 +19,7 @@
 #include <utils/acl.h>
 #include <utils/rangetypes.h>
 #include <utils/memutils.h>
+#include <utils/uuid.h>
 #include <catalog/namespace.h>
 #include <catalog/pg_type.h>
 #include <access/hash.h>
@@ -107,6 +108,82 @@ ts_partitioning_func_is_default(const char *schema, const char *funcname)
 		strcmp(DEFAULT_PARTITIONING_FUNC_NAME, funcname) == 0;
 }
 
+/*
+ * Native hash functions for common partitioning column types.
+ *
+ * These must compute exactly the same hash values as the hash functions
+ * PostgreSQL registers for the types (e.g., hashint4() and hashtext()), since
+ * existing chunks are partitioned on those values.
+ */
+static uint32
+native_hash_int2(Datum value)
+{
+	return DatumGetUInt32(hash_uint32((int32) DatumGetInt16(value)));
+}
+
+static uint32
+native_hash_int4(Datum value)
+{
+	return DatumGetUInt32(hash_uint32(DatumGetInt32(value)));
+}
+
+static uint32
+native_hash_int8(Datum value)
+{
+	int64		val = DatumGetInt64(value);
+	uint32		lohalf = (uint32) val;
+	uint32		hihalf = (uint32) (val >> 32);
+
+	/* Same as hashint8(), so that int8 hashes like int4 for small values */
+	lohalf ^= (val >= 0) ? hihalf : ~hihalf;
+
+	return DatumGetUInt32(hash_uint32(lohalf));
+}
+
+static uint32
+native_hash_uuid(Datum value)
+{
+	pg_uuid_t  *uuid = DatumGetUUIDP(value);
+
+	return DatumGetUInt32(hash_any(uuid->data, UUID_LEN));
+}
+
+static uint32
+native_hash_text(Datum value)
+{
+	text	   *txt = DatumGetTextPP(value);
+	uint32		hash;
+
+	hash = DatumGetUInt32(hash_any((unsigned char *) VARDATA_ANY(txt),
+								   VARSIZE_ANY_EXHDR(txt)));
+
+	if ((Pointer) txt != DatumGetPointer(value))
+		pfree(txt);
+
+	return hash;
+}
+
+static partition_hash_func
+native_hash_func_get(Oid type)
+{
+	switch (type)
+	{
+		case INT2OID:
+			return native_hash_int2;
+		case INT4OID:
+			return native_hash_int4;
+		case INT8OID:
+			return native_hash_int8;
+		case UUIDOID:
+			return native_hash_uuid;
+		case TEXTOID:
+		case VARCHAROID:
+			return native_hash_text;
+		default:
+			return NULL;
+	}
+}
+
 /*
  * Resolve the partitioning function set for a hypertable.
  */
@@ -191,6 +268,13 @@ ts_partitioning_info_create(const char *schema,
 
 	partitioning_func_set_func_fmgr(&pinfo->partfunc);
 
+	/* Type cache entries are never freed, so we can keep a reference */
+	if (ts_partitioning_func_is_default(schema, partfunc))
+	{
+		pinfo->partfunc.hash_fmgr = &tce->hash_proc_finfo;
+		pinfo->partfunc.native_hash = native_hash_func_get(columntype);
+	}
+
 	/*
 	 * Prepare a function expression for this function. The partition hash
 	 * function needs this to be able to resolve the type of the value to be
@@ -224,18 +308,56 @@ ts_partitioning_func_apply(PartitioningInfo *pinfo, Datum value)
 	return DatumGetInt32(FunctionCall1(&pinfo->partfunc.func_fmgr, value));
 }
 
+/*
+ * Compute the partition hash of a value using the hash function of the
+ * partitioning column's type.
+ *
+ * Gives the same result as applying the default partitioning function
+ * (get_partition_hash()), but without the fmgr round trip.
+ */
 int32
-ts_partitioning_func_apply_tuple(PartitioningInfo *pinfo, HeapTuple tuple, TupleDesc desc)
+ts_partitioning_func_apply_hash(PartitioningInfo *pinfo, Datum value)
 {
-	Datum		value;
-	bool		isnull;
+	uint32		hash;
 
-	value = heap_getattr(tuple, pinfo->column_attnum, desc, &isnull);
+	Assert(NULL != pinfo->partfunc.hash_fmgr);
 
-	if (isnull)
-		return 0;
+	if (NULL != pinfo->partfunc.native_hash)
+		hash = pinfo->partfunc.native_hash(value);
+	else
+		hash = DatumGetUInt32(FunctionCall1(pinfo->partfunc.hash_fmgr, value));
 
-	return ts_partitioning_func_apply(pinfo, value);
+	/* Only positive numbers */
+	return (int32) (hash & 0x7fffffff);
+}
+
+/*
+ * Apply the partitioning function to a vector of values.
+ *
+ * NULL values map to partition 0, same as for single values.
+ */
+void
+ts_partitioning_func_apply_batch(PartitioningInfo *pinfo, const Datum *values,
+								 const bool *isnull, int nvalues, int32 *result)
+{
+	partition_hash_func native_hash = pinfo->partfunc.native_hash;
+	int			i;
+
+	if (NULL != native_hash)
+	{
+		for (i = 0; i < nvalues; i++)
+			result[i] = isnull[i] ? 0 : (int32) (native_hash(values[i]) & 0x7fffffff);
+	}
+	else if (NULL != pinfo->partfunc.hash_fmgr)
+	{
+		for (i = 0; i < nvalues; i++)
+			result[i] = isnull[i] ? 0 : ts_partitioning_func_apply_hash(pinfo, values[i]);
+	}
+	else
+	{
+		for (i = 0; i < nvalues; i++)
+			result[i] = isnull[i] ? 0 : ts_partitioning_func_apply(pinfo, values[i]);
+	}
 }
 
 /*
@@ -301,6 +423,7 @@ typedef struct PartFuncCache
 	Oid			argtype;
 	Oid			coerce_funcid;
 	TypeCacheEntry *tce;
+	partition_hash_func native_hash;
 } PartFuncCache;
 
 static PartFuncCache *
@@ -312,10 +435,40 @@ part_func_cache_create(Oid argtype, TypeCacheEntry *tce, Oid coerce_funcid, Memo
 	pfc->argtype = argtype;
 	pfc->tce = tce;
 	pfc->coerce_funcid = coerce_funcid;
+	pfc->native_hash = NULL;
 
 	return pfc;
 }
 
+/*
+ * Hash the text representation of an integer. The text is generated the same
+ * way as by the types' output functions, but without going through fmgr and
+ * without allocating a text datum.
+ */
+static uint32
+hash_integer_as_text(Oid type, Datum value)
+{
+	/* Large enough for the text of any 64-bit integer, including sign */
+	char		buf[32];
+
+	switch (type)
+	{
+		case INT2OID:
+			pg_itoa(DatumGetInt16(value), buf);
+			break;
+		case INT4OID:
+			pg_ltoa(DatumGetInt32(value), buf);
+			break;
+		case INT8OID:
+			pg_lltoa(DatumGetInt64(value), buf);
+			break;
+		default:
+			elog(ERROR, "unexpected integer type %u", type);
+	}
+
+	return DatumGetUInt32(hash_any((unsigned char *) buf, strlen(buf)));
+}
+
 /* _timescaledb_catalog.ts_get_partition_for_key(key anyelement) RETURNS INT */
 PGDLLEXPORT Datum ts_get_partition_for_key(PG_FUNCTION_ARGS);
 
@@ -342,32 +495,51 @@ ts_get_partition_for_key(PG_FUNCTION_ARGS)
 		Oid			funcid = InvalidOid;
 		Oid			argtype = resolve_function_argtype(fcinfo);
 
-		if (argtype != TEXTOID)
+		switch (argtype)
 		{
-			/* Not TEXT input -> need to convert to text */
-			funcid = find_text_coercion_func(argtype);
-
-			if (!OidIsValid(funcid))
-				elog(ERROR, "could not coerce type %u to text", argtype);
+			case TEXTOID:
+			case VARCHAROID:
+			case INT2OID:
+			case INT4OID:
+			case INT8OID:
+				/* Text conversion handled natively */
+				break;
+			default:
+				/* Not TEXT input -> need to convert to text */
+				funcid = find_text_coercion_func(argtype);
+
+				if (!OidIsValid(funcid))
+					elog(ERROR, "could not coerce type %u to text", argtype);
+				break;
 		}
 
 		pfc = part_func_cache_create(argtype, NULL, funcid, fcinfo->flinfo->fn_mcxt);
 		fcinfo->flinfo->fn_extra = pfc;
 	}
 
-	if (pfc->argtype != TEXTOID)
+	switch (pfc->argtype)
 	{
-		arg = OidFunctionCall1(pfc->coerce_funcid, arg);
-		arg = CStringGetTextDatum(DatumGetCString(arg));
+		case TEXTOID:
+		case VARCHAROID:
+			hash_u = native_hash_text(arg);
+			break;
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+			hash_u = hash_integer_as_text(pfc->argtype, arg);
+			break;
+		default:
+			arg = OidFunctionCall1(pfc->coerce_funcid, arg);
+			arg = CStringGetTextDatum(DatumGetCString(arg));
+			data = DatumGetTextPP(arg);
+			hash_u = DatumGetUInt32(hash_any((unsigned char *) VARDATA_ANY(data),
+											 VARSIZE_ANY_EXHDR(data)));
+			pfree(data);
+			break;
 	}
 
-	data = DatumGetTextPP(arg);
-	hash_u = DatumGetUInt32(hash_any((unsigned char *) VARDATA_ANY(data),
-									 VARSIZE_ANY_EXHDR(data)));
-
 	res = (int32) (hash_u & 0x7fffffff);	/* Only positive numbers */
 
-	PG_FREE_IF_COPY(data, 0);
 	PG_RETURN_INT32(res);
 }
 
@@ -389,7 +561,7 @@ ts_get_partition_hash(PG_FUNCTION_ARGS)
 {
 	Datum		arg = PG_GETARG_DATUM(0);
 	PartFuncCache *pfc = fcinfo->flinfo->fn_extra;
-	Datum		hash;
+	uint32		hash;
 	int32		res;
 
 	if (PG_NARGS() != 1)
@@ -401,16 +573,22 @@ ts_get_partition_hash(PG_FUNCTION_ARGS)
 		TypeCacheEntry *tce = lookup_type_cache(argtype, TYPECACHE_HASH_FLAGS);
 
 		pfc = part_func_cache_create(argtype, tce, InvalidOid, fcinfo->flinfo->fn_mcxt);
+		pfc->native_hash = native_hash_func_get(argtype);
 		fcinfo->flinfo->fn_extra = pfc;
 	}
 
-	if (pfc->tce->hash_proc == InvalidOid)
-		elog(ERROR, "could not find hash function for type %u", pfc->argtype);
+	if (NULL != pfc->native_hash)
+		hash = pfc->native_hash(arg);
+	else
+	{
+		if (pfc->tce->hash_proc == InvalidOid)
+			elog(ERROR, "could not find hash function for type %u", pfc->argtype);
 
-	hash = FunctionCall1(&pfc->tce->hash_proc_finfo, arg);
+		hash = DatumGetUInt32(FunctionCall1(&pfc->tce->hash_proc_finfo, arg));
+	}
 
 	/* Only positive numbers */
-	res = (int32) (DatumGetUInt32(hash) & 0x7fffffff);
+	res = (int32) (hash & 0x7fffffff);
 
 	PG_RETURN_INT32(res);
 }
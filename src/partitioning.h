@@ -23,6 +23,12 @@
 #define DEFAULT_PARTITIONING_FUNC_SCHEMA INTERNAL_SCHEMA_NAME
 #define DEFAULT_PARTITIONING_FUNC_NAME "get_partition_hash"
 
+/*
+ * Native hash function for a specific type. Computes the same (unmasked) hash
+ * value as the type's hash function, but without going through fmgr.
+ */
+typedef uint32 (*partition_hash_func) (Datum value);
+
 typedef struct PartitioningFunc
 {
 	char		schema[NAMEDATALEN];
@@ -33,6 +39,15 @@ typedef struct PartitioningFunc
 	 * partitioning column's text representation.
 	 */
 	FmgrInfo	func_fmgr;
+
+	/*
+	 * The hash function of the partitioning column's type when the default
+	 * partitioning function is used. This allows computing the partition
+	 * hash without first going through the partitioning function.
+	 */
+	FmgrInfo   *hash_fmgr;
+	/* Native hash function, if the column type has one */
+	partition_hash_func native_hash;
 } PartitioningFunc;
 
 
@@ -54,6 +69,8 @@ extern PartitioningInfo *ts_partitioning_info_create(const char *schema,
 							Oid relid);
 extern List *ts_partitioning_func_qualified_name(PartitioningFunc *pf);
 extern int32 ts_partitioning_func_apply(PartitioningInfo *pinfo, Datum value);
-extern int32 ts_partitioning_func_apply_tuple(PartitioningInfo *pinfo, HeapTuple tuple, TupleDesc desc);
+extern int32 ts_partitioning_func_apply_hash(PartitioningInfo *pinfo, Datum value);
+extern void ts_partitioning_func_apply_batch(PartitioningInfo *pinfo, const Datum *values,
+								 const bool *isnull, int nvalues, int32 *result);
 
 #endif							/* TIMESCALEDB_PARTITIONING_H */
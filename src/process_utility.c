@@ -49,6 +49,7 @@
 #include "hypertable_cache.h"
 #include "dimension_vector.h"
 #include "indexing.h"
+#include "last_point.h"
 #include "trigger.h"
 #include "utils.h"
 
@@ -176,7 +177,7 @@ relation_not_only(RangeVar *rv)
 				 errmsg("ONLY option not supported on hypertable operations")));
 }
 
-/* Change the schema of a hypertable or a chunk */
+/* Change the schema of a hypertable, a chunk, or a last-point table */
 static void
 process_alterobjectschema(Node *parsetree)
 {
@@ -202,6 +203,8 @@ process_alterobjectschema(Node *parsetree)
 
 		if (NULL != chunk)
 			ts_chunk_set_schema(chunk, alterstmt->newschema);
+		else
+			ts_last_point_set_schema(relid, alterstmt->newschema);
 	}
 	else
 		ts_hypertable_set_schema(ht, alterstmt->newschema);
@@ -685,7 +688,7 @@ process_reindex(Node *parsetree)
 }
 
 /*
- * Rename a hypertable or a chunk.
+ * Rename a hypertable, a chunk, or a last-point table.
  */
 static void
 process_rename_table(Cache *hcache, Oid relid, RenameStmt *stmt)
@@ -698,6 +701,8 @@ process_rename_table(Cache *hcache, Oid relid, RenameStmt *stmt)
 
 		if (NULL != chunk)
 			ts_chunk_set_name(chunk, stmt->newname);
+		else
+			ts_last_point_set_name(relid, stmt->newname);
 	}
 	else
 		ts_hypertable_set_name(ht, stmt->newname);
@@ -722,6 +727,8 @@ process_rename_column(Cache *hcache, Oid relid, RenameStmt *stmt)
 		return;
 	}
 
+	ts_last_point_rename_column(ht, stmt->subname, stmt->newname);
+
 	dim = ts_hyperspace_get_dimension_by_name(ht->space, DIMENSION_TYPE_ANY, stmt->subname);
 
 	if (NULL == dim)
@@ -773,6 +780,7 @@ process_rename_schema(RenameStmt *stmt)
 	ts_chunks_rename_schema_name(stmt->subname, stmt->newname);
 	ts_dimensions_rename_schema_name(stmt->subname, stmt->newname);
 	ts_hypertables_rename_schema_name(stmt->subname, stmt->newname);
+	ts_last_point_rename_schema_name(stmt->subname, stmt->newname);
 }
 
 static void
@@ -970,6 +978,8 @@ process_altertable_drop_column(Hypertable *ht, AlterTableCmd *cmd)
 					 errmsg("cannot drop column named in partition key"),
 					 errdetail("cannot drop column that is a hypertable partitioning (space or time) dimension")));
 	}
+
+	ts_last_point_drop_column(ht, cmd->name);
 }
 
 /* process all regular-table alter commands to make sure they aren't adding
@@ -2120,6 +2130,7 @@ process_drop_table(EventTriggerDropObject *obj)
 
 	ts_hypertable_delete_by_name(table->schema, table->table_name);
 	ts_chunk_delete_by_name(table->schema, table->table_name);
+	ts_last_point_delete_by_name(table->schema, table->table_name);
 }
 
 static void
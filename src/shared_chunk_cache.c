@@ -0,0 +1,583 @@
+/*
+ * Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+ *
+ * This file is licensed under the Apache License,
+ * see LICENSE-APACHE at the top level directory.
+ */
+#include <postgres.h>
+#include <access/hash.h>
+#include <access/xact.h>
+#include <fmgr.h>
+#include <miscadmin.h>
+#include <access/transam.h>
+#include <storage/lwlock.h>
+#include <storage/procarray.h>
+#include <storage/shmem.h>
+#include <utils/memutils.h>
+
+#include "shared_chunk_cache.h"
+#include "chunk.h"
+#include "chunk_constraint.h"
+#include "dimension.h"
+#include "dimension_slice.h"
+#include "hypercube.h"
+
+static SharedChunkCache *shared_chunk_cache = NULL;
+static bool shared_chunk_cache_looked_up = false;
+static HTAB *shared_chunk_cache_hash = NULL;
+
+/* An entry to add when the (sub)transaction that found its chunk commits */
+typedef struct SharedChunkCachePending
+{
+	SubTransactionId subid;
+	SharedChunkCacheEntry entry;
+} SharedChunkCachePending;
+
+/* Entries to add and IDs of chunks to remove at the end of the transaction */
+static List *pending_entries = NIL;
+static List *pending_removals = NIL;
+
+/*
+ * Get the shared memory allocated by the loader. Returns NULL if the loader
+ * was not preloaded or uses a different layout.
+ */
+static SharedChunkCache *
+shared_chunk_cache_get_shmem(void)
+{
+	if (!shared_chunk_cache_looked_up)
+	{
+		SharedChunkCache *cache = *find_rendezvous_variable(RENDEZVOUS_SHARED_CHUNK_CACHE);
+
+		if (NULL != cache &&
+			cache->layout_version == SHARED_CHUNK_CACHE_LAYOUT_VERSION)
+			shared_chunk_cache = cache;
+
+		shared_chunk_cache_looked_up = true;
+	}
+
+	return shared_chunk_cache;
+}
+
+/*
+ * Get the shared chunk cache, attaching to its hash table on first use.
+ * Returns NULL if the shared memory is not available or the cache is
+ * disabled.
+ */
+static SharedChunkCache *
+shared_chunk_cache_get(void)
+{
+	SharedChunkCache *cache = shared_chunk_cache_get_shmem();
+
+	if (NULL == cache || cache->max_entries <= 0)
+		return NULL;
+
+	if (NULL == shared_chunk_cache_hash)
+	{
+		HASHCTL		hctl = {
+			.keysize = sizeof(SharedChunkCacheKey),
+			.entrysize = sizeof(SharedChunkCacheEntry),
+		};
+
+		/* The loader created the hash table, so this only attaches to it */
+		shared_chunk_cache_hash = ShmemInitHash(SHARED_CHUNK_CACHE_HASH_NAME,
+												cache->max_entries,
+												cache->max_entries,
+												&hctl,
+												HASH_ELEM | HASH_BLOBS);
+	}
+
+	return cache;
+}
+
+/*
+ * Compute the key for a point from the default slices that it falls into.
+ */
+static void
+shared_chunk_cache_key_init(SharedChunkCacheKey *key, Hyperspace *hs, Point *point)
+{
+	int			i;
+
+	/* Keys are compared as blobs, so unused slice starts must be zero */
+	memset(key, 0, sizeof(SharedChunkCacheKey));
+	key->database_id = MyDatabaseId;
+	key->hypertable_id = hs->hypertable_id;
+
+	for (i = 0; i < point->num_coords; i++)
+	{
+		DimensionSlice *slice = ts_dimension_calculate_default_slice(&hs->dimensions[i],
+																	 point->coordinates[i]);
+
+		key->slice_start[i] = slice->fd.range_start;
+		ts_dimension_slice_free(slice);
+	}
+}
+
+static bool
+shared_chunk_cache_entry_covers(SharedChunkCacheEntry *entry, Point *point)
+{
+	int			i;
+
+	if (entry->num_dimensions != point->num_coords)
+		return false;
+
+	for (i = 0; i < point->num_coords; i++)
+		if (point->coordinates[i] < entry->range_start[i] ||
+			point->coordinates[i] >= entry->range_end[i])
+			return false;
+
+	return true;
+}
+
+/*
+ * Build a chunk from its entry. The chunk has the dimension constraints that
+ * correspond to its slices, but not the constraints inherited from the
+ * hypertable.
+ */
+static Chunk *
+shared_chunk_cache_entry_to_chunk(SharedChunkCacheEntry *entry, Hyperspace *hs)
+{
+	Chunk	   *chunk = ts_chunk_create_stub(entry->chunk_id, entry->num_dimensions);
+	int			i;
+
+	chunk->fd.hypertable_id = entry->key.hypertable_id;
+	chunk->table_id = entry->chunk_relid;
+	chunk->hypertable_relid = entry->hypertable_relid;
+	chunk->cube = ts_hypercube_alloc(entry->num_dimensions);
+
+	for (i = 0; i < entry->num_dimensions; i++)
+	{
+		DimensionSlice *slice = ts_dimension_slice_create(hs->dimensions[i].fd.id,
+														  entry->range_start[i],
+														  entry->range_end[i]);
+
+		slice->fd.id = entry->slice_id[i];
+		ts_hypercube_add_slice(chunk->cube, slice);
+	}
+
+	ts_chunk_constraints_add_dimension_constraints(chunk->constraints, chunk->fd.id, chunk->cube);
+
+	return chunk;
+}
+
+/*
+ * Find the chunk that covers a point through the shared chunk cache.
+ *
+ * The chunk is built from the cache entry without reading the catalog, and
+ * has only what is needed to route tuples to it: its ID, table, hypercube and
+ * dimension constraints. Returns NULL on a cache miss, in which case the
+ * caller should scan for the chunk.
+ */
+Chunk *
+ts_shared_chunk_cache_find(Hyperspace *hs, Point *point)
+{
+	SharedChunkCache *cache = shared_chunk_cache_get();
+	SharedChunkCacheKey key;
+	SharedChunkCacheEntry *found;
+	SharedChunkCacheEntry entry;
+
+	if (NULL == cache ||
+		hs->num_dimensions > SHARED_CHUNK_CACHE_MAX_DIMENSIONS ||
+		point->num_coords != hs->num_dimensions)
+		return NULL;
+
+	shared_chunk_cache_key_init(&key, hs, point);
+
+	LWLockAcquire(cache->lock, LW_SHARED);
+	found = hash_search(shared_chunk_cache_hash, &key, HASH_FIND, NULL);
+
+	if (NULL != found)
+		entry = *found;
+
+	LWLockRelease(cache->lock);
+
+	if (NULL == found)
+		return NULL;
+
+	/*
+	 * An entry for another table was left behind by a dropped database or
+	 * extension whose IDs are now reused
+	 */
+	if (entry.hypertable_relid != hs->main_table_relid)
+	{
+		LWLockAcquire(cache->lock, LW_EXCLUSIVE);
+		found = hash_search(shared_chunk_cache_hash, &key, HASH_FIND, NULL);
+
+		if (NULL != found && found->hypertable_relid == entry.hypertable_relid)
+			hash_search(shared_chunk_cache_hash, &key, HASH_REMOVE, NULL);
+
+		LWLockRelease(cache->lock);
+		return NULL;
+	}
+
+	if (!shared_chunk_cache_entry_covers(&entry, point))
+		return NULL;
+
+	/* The chunk was deleted or rewritten by the current transaction */
+	if (list_member_int(pending_removals, entry.chunk_id))
+		return NULL;
+
+	return shared_chunk_cache_entry_to_chunk(&entry, hs);
+}
+
+/*
+ * Add the chunk that covers a point to the shared chunk cache once the
+ * current transaction commits.
+ *
+ * Adding at commit makes the chunk visible to other backends before they can
+ * find it in the cache, also if the chunk was created by the transaction.
+ */
+void
+ts_shared_chunk_cache_add(Hyperspace *hs, Point *point, Chunk *chunk)
+{
+	SharedChunkCachePending *pending;
+	MemoryContext old;
+	int			i;
+
+	if (NULL == shared_chunk_cache_get() ||
+		hs->num_dimensions > SHARED_CHUNK_CACHE_MAX_DIMENSIONS ||
+		point->num_coords != hs->num_dimensions ||
+		chunk->cube->num_slices != hs->num_dimensions)
+		return;
+
+	pending = MemoryContextAllocZero(TopTransactionContext, sizeof(SharedChunkCachePending));
+	pending->subid = GetCurrentSubTransactionId();
+	shared_chunk_cache_key_init(&pending->entry.key, hs, point);
+	pending->entry.hypertable_relid = hs->main_table_relid;
+	pending->entry.chunk_id = chunk->fd.id;
+	pending->entry.chunk_relid = chunk->table_id;
+	pending->entry.num_dimensions = hs->num_dimensions;
+
+	for (i = 0; i < hs->num_dimensions; i++)
+	{
+		DimensionSlice *slice =
+		ts_hypercube_get_slice_by_dimension_id(chunk->cube, hs->dimensions[i].fd.id);
+
+		if (NULL == slice)
+		{
+			pfree(pending);
+			return;
+		}
+
+		pending->entry.slice_id[i] = slice->fd.id;
+		pending->entry.range_start[i] = slice->fd.range_start;
+		pending->entry.range_end[i] = slice->fd.range_end;
+	}
+
+	old = MemoryContextSwitchTo(TopTransactionContext);
+	pending_entries = lappend(pending_entries, pending);
+	MemoryContextSwitchTo(old);
+}
+
+/*
+ * Remove a deleted or rewritten chunk from the shared chunk cache at the end
+ * of the current transaction.
+ */
+void
+ts_shared_chunk_cache_remove(int32 chunk_id)
+{
+	MemoryContext old;
+
+	if (NULL == shared_chunk_cache_get())
+		return;
+
+	old = MemoryContextSwitchTo(TopTransactionContext);
+	pending_removals = lappend_int(pending_removals, chunk_id);
+	MemoryContextSwitchTo(old);
+}
+
+/*
+ * Make room for an entry in a full cache by removing the oldest entries.
+ *
+ * Entries are stamped in the order they are added. Of the max_entries
+ * stamps of a full cache, at least an eighth are below the threshold, so
+ * an eighth of the cache is removed in one pass over the hash table.
+ */
+static void
+shared_chunk_cache_evict(SharedChunkCache *cache)
+{
+	uint64		threshold = cache->next_stamp - cache->max_entries +
+	Max(cache->max_entries / 8, 1);
+	HASH_SEQ_STATUS status;
+	SharedChunkCacheEntry *entry;
+
+	hash_seq_init(&status, shared_chunk_cache_hash);
+
+	while ((entry = hash_seq_search(&status)) != NULL)
+		if (entry->stamp < threshold)
+			hash_search(shared_chunk_cache_hash, &entry->key, HASH_REMOVE, NULL);
+}
+
+static void
+shared_chunk_cache_apply_pending(bool commit)
+{
+	SharedChunkCache *cache = shared_chunk_cache_get();
+	ListCell   *lc;
+
+	if (NULL == cache || (pending_removals == NIL && (!commit || pending_entries == NIL)))
+		return;
+
+	LWLockAcquire(cache->lock, LW_EXCLUSIVE);
+
+	if (commit)
+	{
+		foreach(lc, pending_entries)
+		{
+			SharedChunkCachePending *pending = lfirst(lc);
+			SharedChunkCacheEntry *entry;
+
+			if (hash_get_num_entries(shared_chunk_cache_hash) >= cache->max_entries)
+				shared_chunk_cache_evict(cache);
+
+			entry = hash_search(shared_chunk_cache_hash, &pending->entry.key, HASH_ENTER_NULL, NULL);
+
+			if (NULL != entry)
+			{
+				*entry = pending->entry;
+				entry->stamp = cache->next_stamp++;
+			}
+		}
+	}
+
+	/* Removals go last, in case a chunk was added and deleted */
+	if (pending_removals != NIL)
+	{
+		HASH_SEQ_STATUS status;
+		SharedChunkCacheEntry *entry;
+
+		hash_seq_init(&status, shared_chunk_cache_hash);
+
+		while ((entry = hash_seq_search(&status)) != NULL)
+			if (entry->key.database_id == MyDatabaseId &&
+				list_member_int(pending_removals, entry->chunk_id))
+				hash_search(shared_chunk_cache_hash, &entry->key, HASH_REMOVE, NULL);
+	}
+
+	LWLockRelease(cache->lock);
+}
+
+static void
+shared_chunk_cache_xact_end(XactEvent event, void *arg)
+{
+	switch (event)
+	{
+		case XACT_EVENT_COMMIT:
+		case XACT_EVENT_PARALLEL_COMMIT:
+			shared_chunk_cache_apply_pending(true);
+			break;
+		case XACT_EVENT_ABORT:
+		case XACT_EVENT_PARALLEL_ABORT:
+		case XACT_EVENT_PREPARE:
+
+			/*
+			 * Removing entries is always safe, while the chunks of a prepared
+			 * transaction might never become visible
+			 */
+			shared_chunk_cache_apply_pending(false);
+			break;
+		default:
+			return;
+	}
+
+	/* The lists were allocated on the transaction's memory context */
+	pending_entries = NIL;
+	pending_removals = NIL;
+}
+
+static void
+shared_chunk_cache_subxact_end(SubXactEvent event, SubTransactionId mySubid,
+							   SubTransactionId parentSubid, void *arg)
+{
+	ListCell   *lc;
+	ListCell   *prev = NULL;
+	ListCell   *next;
+
+	switch (event)
+	{
+		case SUBXACT_EVENT_COMMIT_SUB:
+			foreach(lc, pending_entries)
+			{
+				SharedChunkCachePending *pending = lfirst(lc);
+
+				if (pending->subid == mySubid)
+					pending->subid = parentSubid;
+			}
+			break;
+		case SUBXACT_EVENT_ABORT_SUB:
+			/* Chunks created by the subtransaction are gone */
+			for (lc = list_head(pending_entries); lc != NULL; lc = next)
+			{
+				SharedChunkCachePending *pending = lfirst(lc);
+
+				next = lnext(lc);
+
+				if (pending->subid == mySubid)
+					pending_entries = list_delete_cell(pending_entries, lc, prev);
+				else
+					prev = lc;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/*
+ * Get the slot counting the slice creations of a dimension.
+ */
+static SharedSliceCreations *
+shared_slice_creations(SharedChunkCache *cache, int32 dimension_id)
+{
+	uint32		hash = DatumGetUInt32(hash_uint32((uint32) dimension_id)) ^
+	DatumGetUInt32(hash_uint32((uint32) MyDatabaseId));
+
+	return &cache->slice_creations[hash % SHARED_CHUNK_CACHE_SLICE_SLOTS];
+}
+
+/*
+ * Count the slice creations of prepared transactions as finished if all the
+ * prepared transactions of a slot have been committed or rolled back. This can
+ * happen in any backend, so it is checked by comparing the newest prepared
+ * transaction with the oldest transaction that is still running. Returns true
+ * if any creations were finished.
+ */
+static bool
+shared_slice_creations_finish_prepared(SharedChunkCache *cache, SharedSliceCreations *creations)
+{
+	/* Taken before the lock, since it scans the proc array */
+	TransactionId oldest_xmin = GetOldestXmin(NULL, 0);
+	bool		finished = false;
+
+	LWLockAcquire(cache->lock, LW_EXCLUSIVE);
+
+	if (creations->num_prepared > 0 &&
+		TransactionIdPrecedes(creations->prepared_xmax, oldest_xmin))
+	{
+		creations->finished += creations->num_prepared;
+		creations->num_prepared = 0;
+		creations->prepared_xmax = InvalidTransactionId;
+		finished = true;
+	}
+
+	LWLockRelease(cache->lock);
+
+	return finished;
+}
+
+/*
+ * Get the number of transactions that finished creating slices in a
+ * dimension (or in the other dimensions of its slot).
+ *
+ * Returns false if the shared memory is not available or slices are currently
+ * being created in the dimension, in which case the catalog is the only
+ * complete source of its slices.
+ */
+bool
+ts_shared_chunk_cache_slice_generation(int32 dimension_id, uint64 *generation)
+{
+	SharedChunkCache *cache = shared_chunk_cache_get_shmem();
+	SharedSliceCreations *creations;
+	bool		stable;
+	bool		prepared;
+
+	if (NULL == cache)
+		return false;
+
+	creations = shared_slice_creations(cache, dimension_id);
+
+	LWLockAcquire(cache->lock, LW_SHARED);
+	stable = creations->started == creations->finished;
+	prepared = creations->num_prepared > 0;
+	*generation = creations->finished;
+	LWLockRelease(cache->lock);
+
+	if (stable || !prepared || !shared_slice_creations_finish_prepared(cache, creations))
+		return stable;
+
+	LWLockAcquire(cache->lock, LW_SHARED);
+	stable = creations->started == creations->finished;
+	*generation = creations->finished;
+	LWLockRelease(cache->lock);
+
+	return stable;
+}
+
+/*
+ * Count a transaction that is about to create slices in a dimension. Returns
+ * false if the shared memory is not available. Every successful call must be
+ * paired with a call to ts_shared_chunk_cache_slice_creation_finish() for the
+ * same dimension once the transaction has ended and its slices are visible
+ * (or gone).
+ */
+bool
+ts_shared_chunk_cache_slice_creation_start(int32 dimension_id)
+{
+	SharedChunkCache *cache = shared_chunk_cache_get_shmem();
+	SharedSliceCreations *creations;
+
+	if (NULL == cache)
+		return false;
+
+	creations = shared_slice_creations(cache, dimension_id);
+
+	LWLockAcquire(cache->lock, LW_EXCLUSIVE);
+	creations->started++;
+	LWLockRelease(cache->lock);
+
+	return true;
+}
+
+void
+ts_shared_chunk_cache_slice_creation_finish(int32 dimension_id)
+{
+	SharedChunkCache *cache = shared_chunk_cache_get_shmem();
+	SharedSliceCreations *creations;
+
+	Assert(NULL != cache);
+
+	creations = shared_slice_creations(cache, dimension_id);
+
+	LWLockAcquire(cache->lock, LW_EXCLUSIVE);
+	creations->finished++;
+	Assert(creations->finished <= creations->started);
+	LWLockRelease(cache->lock);
+}
+
+/*
+ * Note that a transaction that started creating slices in a dimension was
+ * prepared. Its slices become visible when it is committed, possibly by
+ * another backend, so the creation is only finished once the transaction is
+ * no longer running (see shared_slice_creations_finish_prepared()).
+ */
+void
+ts_shared_chunk_cache_slice_creation_prepare(int32 dimension_id, TransactionId xid)
+{
+	SharedChunkCache *cache = shared_chunk_cache_get_shmem();
+	SharedSliceCreations *creations;
+
+	Assert(NULL != cache);
+	Assert(TransactionIdIsNormal(xid));
+
+	creations = shared_slice_creations(cache, dimension_id);
+
+	LWLockAcquire(cache->lock, LW_EXCLUSIVE);
+	if (creations->num_prepared == 0 ||
+		TransactionIdFollows(xid, creations->prepared_xmax))
+		creations->prepared_xmax = xid;
+	creations->num_prepared++;
+	Assert(creations->finished + creations->num_prepared <= creations->started);
+	LWLockRelease(cache->lock);
+}
+
+void
+_shared_chunk_cache_init(void)
+{
+	RegisterXactCallback(shared_chunk_cache_xact_end, NULL);
+	RegisterSubXactCallback(shared_chunk_cache_subxact_end, NULL);
+}
+
+void
+_shared_chunk_cache_fini(void)
+{
+	UnregisterXactCallback(shared_chunk_cache_xact_end, NULL);
+	UnregisterSubXactCallback(shared_chunk_cache_subxact_end, NULL);
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+ *
+ * This file is licensed under the Apache License,
+ * see LICENSE-APACHE at the top level directory.
+ */
+#ifndef TIMESCALEDB_SHARED_CHUNK_CACHE_H
+#define TIMESCALEDB_SHARED_CHUNK_CACHE_H
+
+#include <postgres.h>
+#include <storage/lwlock.h>
+
+/*
+ * The shared chunk cache maps points in a hypertable's hyperspace to the
+ * chunks that cover them. It lives in shared memory so that backends can find
+ * the chunk for a point without scanning the dimension slice catalog on a
+ * miss in their private chunk caches.
+ *
+ * The shared memory is allocated by the loader, since only a preloaded
+ * library can reserve shared memory, and published through a rendezvous
+ * variable. The loader and the versioned extension library may be of
+ * different versions, so the layout below carries a version and must only be
+ * changed together with SHARED_CHUNK_CACHE_LAYOUT_VERSION.
+ *
+ * Chunks are kept in a shared hash table that the loader creates and the
+ * versioned library attaches to by name. An entry is keyed on the starts of
+ * the default slices (see ts_dimension_calculate_default_slice()) that a
+ * point falls into, so a lookup is a single probe. The entry holds the
+ * chunk's table and extent, which is enough to build the chunk without
+ * reading the catalog. Since the extent of a chunk might differ from the
+ * default slices, e.g., after the chunk interval changed, an entry is only
+ * used if the chunk covers the point.
+ *
+ * Chunks are added when the transaction that found or created them commits,
+ * so every entry refers to a committed chunk. Chunk IDs are never reused and
+ * the extent of a chunk never changes, so an entry is valid until its chunk is
+ * deleted, which removes it. Entries of dropped databases or extensions are
+ * detected through the hypertable's table, which is also part of the entry.
+ *
+ * The shared memory also counts the transactions that create dimension
+ * slices, which tells backends whether their in-memory slice indexes are
+ * complete (see dimension_slice_index.c). The counters exist even if the
+ * cache itself is disabled. Dimensions are mapped to a fixed number of
+ * counter slots by hashing their database and dimension ID, so creating
+ * slices in one dimension only affects the indexes of dimensions that share
+ * its slot.
+ */
+
+#define SHARED_CHUNK_CACHE_NAME "ts_shared_chunk_cache"
+#define SHARED_CHUNK_CACHE_HASH_NAME "ts_shared_chunk_cache_hash"
+#define SHARED_CHUNK_CACHE_TRANCHE_NAME "ts_shared_chunk_cache_tranche"
+#define RENDEZVOUS_SHARED_CHUNK_CACHE "timescaledb.shared_chunk_cache"
+#define SHARED_CHUNK_CACHE_LAYOUT_VERSION 4
+#define SHARED_CHUNK_CACHE_MAX_DIMENSIONS 4
+#define SHARED_CHUNK_CACHE_SLICE_SLOTS 256
+
+typedef struct SharedChunkCacheKey
+{
+	Oid			database_id;	/* The cache is shared by all databases */
+	int32		hypertable_id;
+	/* Default slice starts, in the order of the hyperspace's dimensions */
+	int64		slice_start[SHARED_CHUNK_CACHE_MAX_DIMENSIONS];
+} SharedChunkCacheKey;
+
+typedef struct SharedChunkCacheEntry
+{
+	SharedChunkCacheKey key;
+	Oid			hypertable_relid;
+	int32		chunk_id;
+	Oid			chunk_relid;
+	int16		num_dimensions;
+	/* Slices of the chunk, in the order of the hyperspace's dimensions */
+	int32		slice_id[SHARED_CHUNK_CACHE_MAX_DIMENSIONS];
+	int64		range_start[SHARED_CHUNK_CACHE_MAX_DIMENSIONS];
+	int64		range_end[SHARED_CHUNK_CACHE_MAX_DIMENSIONS];
+	uint64		stamp;			/* Order of addition, for eviction */
+} SharedChunkCacheEntry;
+
+/*
+ * Transactions that started and finished creating slices in a slot's
+ * dimensions. Prepared transactions are finished once no transaction as old
+ * as the newest of them is running anymore.
+ */
+typedef struct SharedSliceCreations
+{
+	uint64		started;
+	uint64		finished;
+	uint32		num_prepared;
+	TransactionId prepared_xmax;
+} SharedSliceCreations;
+
+typedef struct SharedChunkCache
+{
+	int32		layout_version;
+	int32		max_entries;	/* Size of the hash table, 0 if disabled */
+	LWLock	   *lock;			/* Protects everything below and the hash */
+	uint64		next_stamp;
+	SharedSliceCreations slice_creations[SHARED_CHUNK_CACHE_SLICE_SLOTS];
+} SharedChunkCache;
+
+/* Used by the versioned extension library only */
+typedef struct Hyperspace Hyperspace;
+typedef struct Point Point;
+typedef struct Chunk Chunk;
+
+extern Chunk *ts_shared_chunk_cache_find(Hyperspace *hs, Point *point);
+extern void ts_shared_chunk_cache_add(Hyperspace *hs, Point *point, Chunk *chunk);
+extern void ts_shared_chunk_cache_remove(int32 chunk_id);
+extern bool ts_shared_chunk_cache_slice_generation(int32 dimension_id, uint64 *generation);
+extern bool ts_shared_chunk_cache_slice_creation_start(int32 dimension_id);
+extern void ts_shared_chunk_cache_slice_creation_finish(int32 dimension_id);
+extern void ts_shared_chunk_cache_slice_creation_prepare(int32 dimension_id, TransactionId xid);
+
+extern void _shared_chunk_cache_init(void);
+extern void _shared_chunk_cache_fini(void);
+
+#endif							/* TIMESCALEDB_SHARED_CHUNK_CACHE_H */
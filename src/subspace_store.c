@@ -6,6 +6,8 @@
  */
 #include <postgres.h>
 #include <utils/memutils.h>
+#include <utils/hsearch.h>
+#include <lib/ilist.h>
 
 #include "dimension.h"
 #include "dimension_slice.h"
@@ -29,13 +31,45 @@ typedef struct SubspaceStoreInternalNode
 	bool		last_internal_node;
 } SubspaceStoreInternalNode;
 
+/*
+ * A leaf entry in the store. The leaf slices of the tree point to entries,
+ * which are also kept in a list ordered on recency of use. The entry
+ * remembers a point in its subspace so that it can be found in the tree when
+ * evicted.
+ */
+struct SubspaceStoreEntry
+{
+	dlist_node	lru_node;
+	void	   *object;
+	Size		object_size;
+	void		(*object_free) (void *);
+	int64		coordinates[FLEXIBLE_ARRAY_MEMBER];
+};
+
+#define SUBSPACE_STORE_ENTRY_SIZE(num_dimensions)						\
+	(sizeof(SubspaceStoreEntry) + sizeof(int64) * (num_dimensions))
+
+/*
+ * Maximum number of evicted subspaces to remember. Stores can live for a long
+ * time, e.g., the chunk cache of a cached hypertable, so the evicted
+ * subspaces are forgotten once this many have been remembered. Readditions
+ * are then only counted for recent evictions.
+ */
+#define SUBSPACE_STORE_MAX_EVICTED 1024
+
 typedef struct SubspaceStore
 {
 	MemoryContext mcxt;
 	int16		num_dimensions;
-/* limit growth of store by  limiting number of slices in first dimension,	0 for no limit */
+/* limit growth of store by limiting the number of leaf objects, 0 for no limit */
 	int16		max_items;
+	/* limit on the total size of the objects, 0 for no limit */
+	Size		max_size;
+	Size		total_size;
 	SubspaceStoreInternalNode *origin;	/* origin of the tree */
+	dlist_head	lru;			/* entries, most recently used first */
+	HTAB	   *evicted;		/* subspaces evicted from the store */
+	SubspaceStoreStats stats;
 } SubspaceStore;
 
 static inline SubspaceStoreInternalNode *
@@ -56,25 +90,24 @@ subspace_store_internal_node_free(void *node)
 	pfree(node);
 }
 
-static size_t
-subspace_store_internal_node_descendants(SubspaceStoreInternalNode *node, int index)
+static void
+subspace_store_entry_free(void *entryptr)
 {
-	DimensionSlice *slice = ts_dimension_vec_get(node->vector, index);
+	SubspaceStoreEntry *entry = entryptr;
 
-	if (slice == NULL)
-		return 0;
+	dlist_delete(&entry->lru_node);
 
-	if (node->last_internal_node)
-		return 1;
+	if (NULL != entry->object_free)
+		entry->object_free(entry->object);
 
-	return ((SubspaceStoreInternalNode *) slice->storage)->descendants;
+	pfree(entry);
 }
 
 SubspaceStore *
 ts_subspace_store_init(Hyperspace *space, MemoryContext mcxt, int16 max_items)
 {
 	MemoryContext old = MemoryContextSwitchTo(mcxt);
-	SubspaceStore *sst = palloc(sizeof(SubspaceStore));
+	SubspaceStore *sst = palloc0(sizeof(SubspaceStore));
 
 	/*
 	 * make sure that the first dimension is a time dimension, otherwise the
@@ -87,21 +120,132 @@ ts_subspace_store_init(Hyperspace *space, MemoryContext mcxt, int16 max_items)
 	/* max_items = 0 is treated as unlimited */
 	sst->max_items = max_items;
 	sst->mcxt = mcxt;
+	dlist_init(&sst->lru);
 	MemoryContextSwitchTo(old);
 	return sst;
 }
 
 void
+ts_subspace_store_set_max_size(SubspaceStore *store, Size max_size)
+{
+	store->max_size = max_size;
+}
+
+/*
+ * Remember that a subspace was evicted, so that we can count how often evicted
+ * subspaces are added back to the store.
+ */
+static void
+subspace_store_remember_evicted(SubspaceStore *store, SubspaceStoreEntry *entry)
+{
+	if (NULL != store->evicted &&
+		hash_get_num_entries(store->evicted) >= SUBSPACE_STORE_MAX_EVICTED)
+	{
+		hash_destroy(store->evicted);
+		store->evicted = NULL;
+	}
+
+	if (NULL == store->evicted)
+	{
+		HASHCTL		hctl = {
+			.keysize = sizeof(int64) * store->num_dimensions,
+			.entrysize = sizeof(int64) * store->num_dimensions,
+			.hcxt = store->mcxt,
+		};
+
+		store->evicted = hash_create("SubspaceStore evicted subspaces", 32, &hctl,
+									 HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	}
+
+	hash_search(store->evicted, entry->coordinates, HASH_ENTER, NULL);
+}
+
+/*
+ * Remove the path to the entry containing the given coordinates from the
+ * subtree rooted at the given node. Slices that no longer have any descendants
+ * are removed, and the entry is freed along with the leaf slice.
+ */
+static void
+subspace_store_remove_path(SubspaceStoreInternalNode *node, const int64 *coordinates)
+{
+	DimensionSlice *match = ts_dimension_vec_find_slice(node->vector, coordinates[0]);
+	int			i;
+
+	Assert(NULL != match);
+	Assert(node->descendants > 0);
+
+	node->descendants--;
+
+	if (!node->last_internal_node &&
+		((SubspaceStoreInternalNode *) match->storage)->descendants > 1)
+	{
+		subspace_store_remove_path(match->storage, coordinates + 1);
+		return;
+	}
+
+	/* The slice has no other descendants, so remove it along with its subtree */
+	for (i = 0; i < node->vector->num_slices; i++)
+	{
+		if (node->vector->slices[i] == match)
+		{
+			ts_dimension_vec_remove_slice(&node->vector, i);
+			return;
+		}
+	}
+
+	Assert(false);
+}
+
+/*
+ * Evict the least recently used object from the store.
+ */
+static void
+subspace_store_evict(SubspaceStore *store)
+{
+	SubspaceStoreEntry *entry;
+
+	Assert(!dlist_is_empty(&store->lru));
+
+	entry = dlist_tail_element(SubspaceStoreEntry, lru_node, &store->lru);
+	subspace_store_remember_evicted(store, entry);
+	store->stats.evictions++;
+	store->total_size -= entry->object_size;
+
+	/* Frees the entry and its object */
+	subspace_store_remove_path(store->origin, entry->coordinates);
+}
+
+SubspaceStoreEntry *
 ts_subspace_store_add(SubspaceStore *store, const Hypercube *hc,
-					  void *object, void (*object_free) (void *))
+					  void *object, Size object_size, void (*object_free) (void *))
 {
 	SubspaceStoreInternalNode *node = store->origin;
+	SubspaceStoreEntry *entry;
 	DimensionSlice *last = NULL;
 	MemoryContext old = MemoryContextSwitchTo(store->mcxt);
 	int			i;
 
 	Assert(hc->num_slices == store->num_dimensions);
 
+	/* Make room for the new object by evicting the least recently used one */
+	if (store->max_items > 0 && node->descendants >= (size_t) store->max_items)
+		subspace_store_evict(store);
+
+	/*
+	 * Evict as many objects as needed to stay within the maximum size. An
+	 * object that is larger than the maximum size on its own is still added.
+	 */
+	while (store->max_size > 0 &&
+		   store->total_size + object_size > store->max_size &&
+		   !dlist_is_empty(&store->lru))
+		subspace_store_evict(store);
+
+	entry = palloc(SUBSPACE_STORE_ENTRY_SIZE(hc->num_slices));
+	entry->object = object;
+	entry->object_size = object_size;
+	entry->object_free = object_free;
+	store->total_size += object_size;
+
 	for (i = 0; i < hc->num_slices; i++)
 	{
 		const DimensionSlice *target = hc->slices[i];
@@ -109,6 +253,8 @@ ts_subspace_store_add(SubspaceStore *store, const Hypercube *hc,
 
 		Assert(target->storage == NULL);
 
+		entry->coordinates[i] = target->fd.range_start;
+
 		if (node == NULL)
 		{
 			/*
@@ -122,8 +268,6 @@ ts_subspace_store_add(SubspaceStore *store, const Hypercube *hc,
 			node = last->storage;
 		}
 
-		Assert(store->max_items == 0 || node->descendants <= (size_t) store->max_items);
-
 		/*
 		 * We only call this function on a cache miss, so number of leaves
 		 * will definitely increase see `Assert(last != NULL && last->storage
@@ -134,37 +278,6 @@ ts_subspace_store_add(SubspaceStore *store, const Hypercube *hc,
 		Assert(0 == node->vector->num_slices ||
 			   node->vector->slices[0]->fd.dimension_id == target->fd.dimension_id);
 
-		/* Do we have enough space to store the object? */
-		if (store->max_items > 0 && node->descendants > store->max_items)
-		{
-			/*
-			 * Always delete the slice corresponding to the earliest time
-			 * range. In the normal case that inserts are performed in
-			 * time-order this is the one least likely to be reused. (Note
-			 * that we made sure that the first dimension is a time dimension
-			 * when creating the subspace_store). If out-of-order inserts are
-			 * become significant we may wish to change this to something more
-			 * sophisticated like LRU.
-			 */
-			size_t		items_removed = subspace_store_internal_node_descendants(node, i);
-
-			/*
-			 * descendants at the root is inclusive of the descendants at the
-			 * children, so if we have an overflow it must be in the time dim
-			 */
-			Assert(i == 0);
-
-			Assert(store->max_items + 1 == node->descendants);
-
-			ts_dimension_vec_remove_slice(&node->vector, i);
-
-			/*
-			 * Note we would have to do this to ancestors if this was not the
-			 * root.
-			 */
-			node->descendants -= items_removed;
-		}
-
 		match = ts_dimension_vec_find_slice(node->vector, target->fd.range_start);
 
 		/* Do we have a slot in this vector for the new object? */
@@ -182,17 +295,51 @@ ts_subspace_store_add(SubspaceStore *store, const Hypercube *hc,
 			match = copy;
 		}
 
-		Assert(store->max_items == 0 || node->descendants <= (size_t) store->max_items);
-
 		last = match;
 		/* internal slices point to the next SubspaceStoreInternalNode */
 		node = last->storage;
 	}
 
+	Assert(store->max_items == 0 || store->origin->descendants <= (size_t) store->max_items);
 	Assert(last != NULL && last->storage == NULL);
-	last->storage = object;		/* at the end we store the object */
-	last->storage_free = object_free;
+
+	/* at the end we store the object, via its entry */
+	last->storage = entry;
+	last->storage_free = subspace_store_entry_free;
+	dlist_push_head(&store->lru, &entry->lru_node);
+
+	store->stats.additions++;
+
+	if (NULL != store->evicted &&
+		NULL != hash_search(store->evicted, entry->coordinates, HASH_REMOVE, NULL))
+		store->stats.readditions++;
+
 	MemoryContextSwitchTo(old);
+
+	return entry;
+}
+
+/*
+ * Mark an object as the most recently used one, e.g., when it was found
+ * without a lookup in the store.
+ */
+void
+ts_subspace_store_touch(SubspaceStore *store, SubspaceStoreEntry *entry)
+{
+	dlist_move_head(&store->lru, &entry->lru_node);
+}
+
+/*
+ * Update the size of an object that grew or shrank after it was added. Objects
+ * are not evicted here, since the object might be in use, but the next
+ * addition evicts objects until the new total size fits.
+ */
+void
+ts_subspace_store_resize(SubspaceStore *store, SubspaceStoreEntry *entry, Size object_size)
+{
+	store->total_size += object_size;
+	store->total_size -= entry->object_size;
+	entry->object_size = object_size;
 }
 
 
@@ -202,6 +349,7 @@ ts_subspace_store_get(SubspaceStore *store, Point *target)
 	int			i;
 	DimensionVec *vec = store->origin->vector;
 	DimensionSlice *match = NULL;
+	SubspaceStoreEntry *entry;
 
 	Assert(target->cardinality == store->num_dimensions);
 
@@ -215,13 +363,22 @@ ts_subspace_store_get(SubspaceStore *store, Point *target)
 		vec = ((SubspaceStoreInternalNode *) match->storage)->vector;
 	}
 	Assert(match != NULL);
-	return match->storage;
+
+	/* Mark the entry as most recently used */
+	entry = match->storage;
+	dlist_move_head(&store->lru, &entry->lru_node);
+
+	return entry->object;
 }
 
 void
 ts_subspace_store_free(SubspaceStore *store)
 {
 	subspace_store_internal_node_free(store->origin);
+
+	if (NULL != store->evicted)
+		hash_destroy(store->evicted);
+
 	pfree(store);
 }
 
@@ -230,3 +387,9 @@ ts_subspace_store_mcxt(SubspaceStore *store)
 {
 	return store->mcxt;
 }
+
+const SubspaceStoreStats *
+ts_subspace_store_stats(SubspaceStore *store)
+{
+	return &store->stats;
+}
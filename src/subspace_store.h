@@ -19,12 +19,36 @@
 typedef struct Hypercube Hypercube;
 typedef struct Point Point;
 typedef struct SubspaceStore SubspaceStore;
+typedef struct SubspaceStoreEntry SubspaceStoreEntry;
+
+/*
+ * Counters for objects added to and evicted from a store. Objects are evicted
+ * in least-recently-used order when the store is full, i.e., it has reached
+ * its maximum number of objects or the total size of its objects would exceed
+ * its maximum size. A readdition is the
+ * addition of an object for a subspace that was previously evicted, which
+ * indicates that the store is too small for the access pattern.
+ */
+typedef struct SubspaceStoreStats
+{
+	int64		additions;
+	int64		evictions;
+	int64		readditions;
+} SubspaceStoreStats;
 
 extern SubspaceStore *ts_subspace_store_init(Hyperspace *space, MemoryContext mcxt, int16 max_items);
+extern void ts_subspace_store_set_max_size(SubspaceStore *store, Size max_size);
 
-/* Store an object associate with the subspace represented by a hypercube */
-extern void ts_subspace_store_add(SubspaceStore *cache, const Hypercube *hc,
-					  void *object, void (*object_free) (void *));
+/*
+ * Store an object associate with the subspace represented by a hypercube. The
+ * size of the object counts towards the store's maximum size, if any. The
+ * returned entry is valid until the object is freed, and can be used to mark
+ * the object as used without a lookup.
+ */
+extern SubspaceStoreEntry *ts_subspace_store_add(SubspaceStore *cache, const Hypercube *hc,
+					  void *object, Size object_size, void (*object_free) (void *));
+extern void ts_subspace_store_touch(SubspaceStore *cache, SubspaceStoreEntry *entry);
+extern void ts_subspace_store_resize(SubspaceStore *cache, SubspaceStoreEntry *entry, Size object_size);
 
 /* Get the object stored for the subspace that a point is in.
  * Return the object stored or NULL if this subspace is not in the store.
@@ -32,5 +56,6 @@ extern void ts_subspace_store_add(SubspaceStore *cache, const Hypercube *hc,
 extern void *ts_subspace_store_get(SubspaceStore *cache, Point *target);
 extern void ts_subspace_store_free(SubspaceStore *cache);
 extern MemoryContext ts_subspace_store_mcxt(SubspaceStore *cache);
+extern const SubspaceStoreStats *ts_subspace_store_stats(SubspaceStore *cache);
 
 #endif							/* TIMESCALEDB_SUBSPACE_STORE_H */
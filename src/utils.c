@@ -96,7 +96,12 @@ TS_FUNCTION_INFO_V1(ts_pg_timestamp_to_unix_microseconds);
 Datum
 ts_pg_timestamp_to_unix_microseconds(PG_FUNCTION_ARGS)
 {
-	TimestampTz timestamp = PG_GETARG_TIMESTAMPTZ(0);
+	PG_RETURN_INT64(ts_timestamp_to_unix_microseconds(PG_GETARG_TIMESTAMPTZ(0)));
+}
+
+int64
+ts_timestamp_to_unix_microseconds(TimestampTz timestamp)
+{
 	int64		epoch_diff_microseconds = (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) * USECS_PER_DAY;
 	int64		microseconds;
 
@@ -120,7 +125,7 @@ ts_pg_timestamp_to_unix_microseconds(PG_FUNCTION_ARGS)
 		microseconds = (seconds * USECS_PER_SEC) + ((timestamp - seconds) * USECS_PER_SEC) + epoch_diff_microseconds;
 	}
 #endif
-	PG_RETURN_INT64(microseconds);
+	return microseconds;
 }
 
 TS_FUNCTION_INFO_V1(ts_pg_unix_microseconds_to_timestamp);
@@ -173,8 +178,7 @@ ts_time_to_internal(PG_FUNCTION_ARGS)
 int64
 ts_time_value_to_internal(Datum time_val, Oid type_oid, bool failure_ok)
 {
-	Datum		res,
-				tz;
+	Datum		res;
 
 	switch (type_oid)
 	{
@@ -190,18 +194,13 @@ ts_time_value_to_internal(Datum time_val, Oid type_oid, bool failure_ok)
 			 * for timestamps, ignore timezones, make believe the timestamp is
 			 * at UTC
 			 */
-			res = DirectFunctionCall1(ts_pg_timestamp_to_unix_microseconds, time_val);
-
-			return DatumGetInt64(res);
+			return ts_timestamp_to_unix_microseconds(DatumGetTimestamp(time_val));
 		case TIMESTAMPTZOID:
-			res = DirectFunctionCall1(ts_pg_timestamp_to_unix_microseconds, time_val);
-
-			return DatumGetInt64(res);
+			return ts_timestamp_to_unix_microseconds(DatumGetTimestampTz(time_val));
 		case DATEOID:
-			tz = DirectFunctionCall1(date_timestamp, time_val);
-			res = DirectFunctionCall1(ts_pg_timestamp_to_unix_microseconds, tz);
+			res = DirectFunctionCall1(date_timestamp, time_val);
 
-			return DatumGetInt64(res);
+			return ts_timestamp_to_unix_microseconds(DatumGetTimestamp(res));
 		default:
 			if (ts_type_is_int8_binary_compatible(type_oid))
 				return DatumGetInt64(time_val);
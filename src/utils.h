@@ -20,6 +20,7 @@ extern bool ts_type_is_int8_binary_compatible(Oid sourcetype);
  * Convert a column value into the internal time representation.
  */
 extern int64 ts_time_value_to_internal(Datum time_val, Oid type, bool failure_ok);
+extern int64 ts_timestamp_to_unix_microseconds(TimestampTz timestamp);
 
 /*
  * Convert the difference of interval and current timestamp to internal representation
@@ -0,0 +1,35 @@
+# Backends that wait for another backend to create the same chunk
+# should not hold up chunk creation in other space partitions once the
+# chunk exists.
+
+setup
+{
+ CREATE TABLE chunk_create_test(time timestamptz, device int, temp float);
+ SELECT schema_name, table_name FROM create_hypertable('chunk_create_test', 'time', 'device', 2, chunk_time_interval => interval '1 day');
+}
+
+teardown { DROP TABLE chunk_create_test; }
+
+session "s1"
+setup	    { BEGIN; SET LOCAL lock_timeout = '500ms'; SET LOCAL deadlock_timeout = '10ms'; }
+step "s1a"	{ INSERT INTO chunk_create_test VALUES ('2018-01-20T09:00:01', 1, 23.4); }
+step "s1c"	{ COMMIT; }
+
+session "s2"
+setup	    { BEGIN; SET LOCAL lock_timeout = '500ms'; SET LOCAL deadlock_timeout = '10ms'; }
+step "s2a"	{ INSERT INTO chunk_create_test VALUES ('2018-01-20T09:00:02', 1, 0.72); }
+step "s2c"	{ COMMIT; }
+
+session "s3"
+setup	    { BEGIN; SET LOCAL lock_timeout = '500ms'; SET LOCAL deadlock_timeout = '10ms'; }
+step "s3a"	{ INSERT INTO chunk_create_test VALUES ('2018-01-20T09:00:03', 2, 12.1); }
+step "s3c"	{ COMMIT; }
+
+# s2 waits for s1 to create the chunk in partition 1 and then lets s3
+# create the chunk in partition 2 while s2 is still open
+permutation "s1a" "s2a" "s1c" "s3a" "s2c" "s3c"
+# creating a chunk in another partition still waits for an open
+# transaction that created a chunk, since PostgreSQL locks the parent
+# table when adding an inheritance child
+permutation "s1a" "s3a" "s1c" "s3c" "s2a" "s2c"
+permutation "s1a" "s1c" "s2a" "s3a" "s2c" "s3c"
@@ -0,0 +1,28 @@
+# Changing the metadata of one hypertable only invalidates that
+# hypertable in the caches of other backends. Backends that have the
+# hypertable cached must still see the change.
+
+setup
+{
+ CREATE TABLE cache_inval_a(time timestamptz, temp float);
+ CREATE TABLE cache_inval_b(time timestamptz, temp float);
+ SELECT create_hypertable('cache_inval_a', 'time', chunk_time_interval => interval '1 day');
+ SELECT create_hypertable('cache_inval_b', 'time', chunk_time_interval => interval '1 day');
+ INSERT INTO cache_inval_b VALUES ('2018-01-20T09:00:00+00', 0.5);
+}
+
+teardown { DROP TABLE cache_inval_a; DROP TABLE cache_inval_b; }
+
+session "s1"
+step "s1a"	{ INSERT INTO cache_inval_a VALUES ('2018-01-20T09:00:00+00', 23.4); }
+step "s1b"	{ INSERT INTO cache_inval_a VALUES ('2018-01-20T10:00:00+00', 0.72); }
+step "s1c"	{ INSERT INTO cache_inval_b VALUES ('2018-01-21T09:30:00+00', 12.1); }
+step "s1d"	{ SELECT h.table_name, s.range_end - s.range_start AS length FROM _timescaledb_catalog.hypertable h JOIN _timescaledb_catalog.chunk c ON (c.hypertable_id = h.id) JOIN _timescaledb_catalog.chunk_constraint cc ON (cc.chunk_id = c.id) JOIN _timescaledb_catalog.dimension_slice s ON (s.id = cc.dimension_slice_id) WHERE h.table_name LIKE 'cache_inval_%' ORDER BY h.table_name, s.range_start; }
+
+session "s2"
+step "s2a"	{ SELECT count(*) FROM drop_chunks('2018-02-01'::timestamptz, 'cache_inval_a'); }
+step "s2b"	{ SELECT count(*) FROM set_chunk_time_interval('cache_inval_b', interval '1 hour'); }
+
+# s1 has both hypertables and the chunk of cache_inval_a cached when s2
+# drops that chunk and changes the interval of cache_inval_b
+permutation "s1a" "s2a" "s2b" "s1b" "s1c" "s1d"
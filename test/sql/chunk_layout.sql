@@ -0,0 +1,61 @@
+-- Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+--
+-- This file is licensed under the Apache License,
+-- see LICENSE-APACHE at the top level directory.
+
+\c single :ROLE_SUPERUSER
+CREATE OR REPLACE FUNCTION _timescaledb_internal.test_chunk_tuple_conversion_needed(chunk REGCLASS) RETURNS BOOLEAN
+    AS :MODULE_PATHNAME, 'ts_test_chunk_tuple_conversion_needed' LANGUAGE C VOLATILE STRICT;
+\c single :ROLE_DEFAULT_PERM_USER
+
+-- A chunk created after a column was dropped from the hypertable lacks
+-- the dropped column, so tuples inserted into it need conversion
+CREATE TABLE layout(time bigint NOT NULL, dropped int, device int DEFAULT 1 CHECK (device > 0), temp float);
+CREATE INDEX ON layout(device, time);
+SELECT table_name FROM create_hypertable('layout', 'time', chunk_time_interval => 10);
+INSERT INTO layout VALUES (1, 0, 1, 1.0);
+ALTER TABLE layout DROP COLUMN dropped;
+INSERT INTO layout VALUES (11, 2, 2.0);
+GRANT SELECT ON layout TO :ROLE_DEFAULT_PERM_USER_2;
+SELECT chunk, _timescaledb_internal.test_chunk_tuple_conversion_needed(chunk)
+FROM show_chunks('layout') AS chunk;
+
+-- Only the chunk with a different layout is rewritten, after which no
+-- chunk needs conversion
+SELECT _timescaledb_internal.repair_chunk_layout('_timescaledb_internal._hyper_1_1_chunk');
+SELECT _timescaledb_internal.repair_chunk_layout('_timescaledb_internal._hyper_1_2_chunk');
+SELECT _timescaledb_internal.repair_chunk_layout('_timescaledb_internal._hyper_1_2_chunk');
+SELECT chunk, _timescaledb_internal.test_chunk_tuple_conversion_needed(chunk)
+FROM show_chunks('layout') AS chunk;
+
+-- The rewritten chunk keeps its rows, default, constraints, indexes and
+-- privileges, and is still a child of the hypertable
+INSERT INTO layout VALUES (12, 3, 3.0);
+INSERT INTO layout(time, temp) VALUES (13, 4.0);
+SELECT * FROM layout ORDER BY time;
+SELECT * FROM _timescaledb_internal._hyper_1_2_chunk ORDER BY time;
+\set ON_ERROR_STOP 0
+INSERT INTO layout VALUES (14, 0, 5.0);
+INSERT INTO _timescaledb_internal._hyper_1_2_chunk VALUES (25, 1, 5.0);
+\set ON_ERROR_STOP 1
+SELECT conname FROM pg_constraint
+WHERE conrelid = '_timescaledb_internal._hyper_1_2_chunk'::regclass
+ORDER BY conname;
+SELECT "Index" FROM test.show_indexes('_timescaledb_internal._hyper_1_2_chunk');
+SELECT chunk_id, index_name, hypertable_index_name FROM _timescaledb_catalog.chunk_index
+ORDER BY chunk_id, index_name;
+SELECT has_table_privilege(:'ROLE_DEFAULT_PERM_USER_2', '_timescaledb_internal._hyper_1_2_chunk', 'SELECT');
+SELECT inhparent::regclass FROM pg_inherits
+WHERE inhrelid = '_timescaledb_internal._hyper_1_2_chunk'::regclass;
+
+-- Columns dropped from the hypertable are also dropped from the
+-- rewritten chunk
+ALTER TABLE layout DROP COLUMN temp;
+SELECT * FROM test.show_columns('_timescaledb_internal._hyper_1_2_chunk');
+SELECT chunk, _timescaledb_internal.test_chunk_tuple_conversion_needed(chunk)
+FROM show_chunks('layout') AS chunk;
+
+-- Only chunks can be rewritten
+\set ON_ERROR_STOP 0
+SELECT _timescaledb_internal.repair_chunk_layout('layout');
+\set ON_ERROR_STOP 1
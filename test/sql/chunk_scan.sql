@@ -0,0 +1,46 @@
+-- Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+--
+-- This file is licensed under the Apache License,
+-- see LICENSE-APACHE at the top level directory.
+
+-- Chunks are found by looking up the chunk constraints of the matching
+-- dimension slices in the dimension_slice_id index of the chunk_constraint
+-- catalog table. Queries over wide ranges of a space-partitioned hypertable
+-- must find the same chunks as a plain join of the catalog tables.
+CREATE TABLE wide(time bigint NOT NULL, device int);
+SELECT table_name FROM create_hypertable('wide', 'time', 'device', 3, chunk_time_interval => 10);
+INSERT INTO wide SELECT t, d FROM generate_series(0, 99, 5) t, generate_series(1, 6) d;
+
+CREATE VIEW wide_chunk_time_ranges AS
+SELECT format('%I.%I', c.schema_name, c.table_name)::regclass AS chunk, s.range_start, s.range_end
+FROM _timescaledb_catalog.chunk c
+INNER JOIN _timescaledb_catalog.chunk_constraint cc ON (cc.chunk_id = c.id)
+INNER JOIN _timescaledb_catalog.dimension_slice s ON (s.id = cc.dimension_slice_id)
+INNER JOIN _timescaledb_catalog.dimension d ON (d.id = s.dimension_id)
+WHERE d.column_name = 'time';
+
+SELECT count(*) AS num_rows,
+       array_agg(DISTINCT tableoid ORDER BY tableoid) =
+       (SELECT array_agg(chunk::oid ORDER BY chunk::oid) FROM wide_chunk_time_ranges) AS same_chunks
+FROM wide WHERE time >= 0 AND time < 100;
+
+SELECT count(*) AS num_rows,
+       array_agg(DISTINCT tableoid ORDER BY tableoid) =
+       (SELECT array_agg(chunk::oid ORDER BY chunk::oid) FROM wide_chunk_time_ranges
+        WHERE range_start < 60 AND range_end > 20) AS same_chunks
+FROM wide WHERE time >= 20 AND time < 60;
+
+SELECT count(*) AS num_rows,
+       array_agg(DISTINCT tableoid ORDER BY tableoid) =
+       (SELECT array_agg(chunk::oid ORDER BY chunk::oid) FROM wide_chunk_time_ranges
+        WHERE range_end > 42) AS same_chunks
+FROM wide WHERE time > 42;
+
+-- Restricting the space dimension as well finds one chunk per time interval
+SELECT count(*) AS num_rows, count(DISTINCT tableoid) AS num_chunks
+FROM wide WHERE time >= 20 AND time < 60 AND device = 2;
+
+SELECT count(*) AS num_rows FROM wide WHERE device IN (1, 2);
+
+DROP VIEW wide_chunk_time_ranges;
+DROP TABLE wide;
@@ -54,3 +54,117 @@ COPY hyper (time, meta_id, value) FROM STDIN DELIMITER ',';
 \set ON_ERROR_STOP 1
 
 COPY (SELECT * FROM hyper ORDER BY time, meta_id) TO STDOUT;
+
+-- test buffered multi-inserts with rows interleaved across chunks
+CREATE TABLE "hyper_interleaved" (
+    "time" bigint NOT NULL,
+    "device" integer NOT NULL,
+    "value" double precision
+);
+CREATE UNIQUE INDEX ON "hyper_interleaved" ("time", "device");
+CREATE TABLE "hyper_interleaved_count" ("count" integer);
+INSERT INTO "hyper_interleaved_count" VALUES (0);
+
+CREATE OR REPLACE FUNCTION count_rows() RETURNS TRIGGER LANGUAGE PLPGSQL AS
+$BODY$
+BEGIN
+    UPDATE "hyper_interleaved_count" SET count = count + 1;
+    RETURN NEW;
+END
+$BODY$;
+
+CREATE TRIGGER count_rows_trigger AFTER INSERT ON "hyper_interleaved"
+    FOR EACH ROW EXECUTE PROCEDURE count_rows();
+
+SELECT table_name FROM create_hypertable('hyper_interleaved', 'time', chunk_time_interval => 10);
+
+COPY hyper_interleaved FROM STDIN DELIMITER ',';
+1,1,1.5
+11,2,2.5
+2,3,3.5
+21,4,4.5
+12,5,5.5
+3,6,6.5
+22,7,7.5
+\.
+
+SELECT * FROM hyper_interleaved_count;
+SELECT * FROM hyper_interleaved ORDER BY time;
+
+-- index entries must exist for buffered tuples
+\set ON_ERROR_STOP 0
+COPY hyper_interleaved FROM STDIN DELIMITER ',';
+30,8,8.5
+12,5,5.5
+\.
+\set ON_ERROR_STOP 1
+
+SELECT count(*) FROM hyper_interleaved;
+
+-- with deferred index builds, new chunks get their non-unique indexes
+-- built when the statement ends
+SET timescaledb.defer_chunk_index_build = on;
+CREATE TABLE "hyper_deferred" ("time" bigint NOT NULL, "device" integer, "value" float);
+CREATE INDEX ON "hyper_deferred" ("device");
+CREATE UNIQUE INDEX ON "hyper_deferred" ("time", "device");
+SELECT table_name FROM create_hypertable('hyper_deferred', 'time', chunk_time_interval => 10);
+
+COPY hyper_deferred FROM STDIN DELIMITER ',';
+1,1,1.5
+11,2,2.5
+2,1,3.5
+12,2,4.5
+\.
+
+INSERT INTO hyper_deferred VALUES (21, 2, 5.5), (22, 3, 6.5);
+
+SELECT count(*), bool_and(i.indisvalid AND i.indisready) AS all_valid
+FROM show_chunks('hyper_deferred') c
+INNER JOIN pg_index i ON (i.indrelid = c);
+
+SET enable_seqscan = off;
+SELECT * FROM hyper_deferred WHERE device = 2 ORDER BY time;
+RESET enable_seqscan;
+
+-- a load cut short by an error in a subtransaction does not keep index
+-- builds deferred for the rest of the transaction
+BEGIN;
+SAVEPOINT failing;
+\set ON_ERROR_STOP 0
+INSERT INTO hyper_deferred VALUES (31, 1, 7.5), (NULL, 1, 8.5);
+\set ON_ERROR_STOP 1
+ROLLBACK TO SAVEPOINT failing;
+INSERT INTO hyper_deferred VALUES (41, 1, 9.5);
+SELECT bool_and(i.indisvalid AND i.indisready) AS all_valid
+FROM show_chunks('hyper_deferred') c
+INNER JOIN pg_index i ON (i.indrelid = c);
+COMMIT;
+RESET timescaledb.defer_chunk_index_build;
+
+-- ingest() inserts rows given as one array per column
+CREATE TABLE "hyper_ingest" ("time" bigint NOT NULL, "device" int, "value" float);
+SELECT table_name FROM create_hypertable('hyper_ingest', 'time', chunk_time_interval => 10);
+SELECT ingest('hyper_ingest', ARRAY[1, 11, 2, 21]::bigint[], ARRAY[1, 2, 1, NULL], ARRAY[1.5, 2.5, 3.5, 4.5]::float[]);
+SELECT count(*) FROM show_chunks('hyper_ingest');
+SELECT * FROM hyper_ingest ORDER BY time;
+
+\set ON_ERROR_STOP 0
+SELECT ingest('hyper_ingest', ARRAY[1, 2]::bigint[], ARRAY[1], ARRAY[1.5, 2.5]::float[]);
+SELECT ingest('hyper_ingest', ARRAY[1]::bigint[], ARRAY[1]);
+SELECT ingest('hyper_ingest', ARRAY[1], ARRAY[1], ARRAY[1.5]::float[]);
+\set ON_ERROR_STOP 1
+
+-- Grouping rows by chunk buffers up to work_mem of rows before writing
+-- them chunk by chunk
+SET timescaledb.group_rows_by_chunk = on;
+CREATE TABLE "hyper_grouped" ("time" bigint NOT NULL, "value" float);
+SELECT table_name FROM create_hypertable('hyper_grouped', 'time', chunk_time_interval => 10);
+COPY hyper_grouped FROM STDIN DELIMITER ',';
+1,1.5
+11,2.5
+21,3.5
+2,4.5
+12,5.5
+\.
+SELECT * FROM hyper_grouped ORDER BY time;
+RESET timescaledb.group_rows_by_chunk;
@@ -0,0 +1,32 @@
+-- Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+--
+-- This file is licensed under the Apache License,
+-- see LICENSE-APACHE at the top level directory.
+
+\c single :ROLE_SUPERUSER
+CREATE OR REPLACE FUNCTION _timescaledb_internal.test_tuple_frozen(rel REGCLASS, tid TID) RETURNS BOOLEAN
+    AS :MODULE_PATHNAME, 'ts_test_tuple_frozen' LANGUAGE C VOLATILE STRICT;
+\c single :ROLE_DEFAULT_PERM_USER
+
+-- COPY FREEZE freezes the tuples written to chunks created in the
+-- same transaction
+BEGIN;
+CREATE TABLE "hyper_freeze" ("time" bigint NOT NULL, "value" float);
+SELECT table_name FROM create_hypertable('hyper_freeze', 'time', chunk_time_interval => 10);
+COPY hyper_freeze FROM STDIN WITH (FORMAT csv, FREEZE);
+1,1.5
+11,2.5
+\.
+COMMIT;
+
+-- chunks that already existed are written normally
+BEGIN;
+COPY hyper_freeze FROM STDIN WITH (FORMAT csv, FREEZE);
+2,3.5
+21,4.5
+\.
+COMMIT;
+
+SELECT time, value, _timescaledb_internal.test_tuple_frozen(tableoid, ctid) AS frozen
+FROM hyper_freeze
+ORDER BY time;
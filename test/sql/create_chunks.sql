@@ -122,3 +122,18 @@ SELECT set_chunk_time_interval('chunk_test', NULL::BIGINT);
 SELECT set_chunk_time_interval('chunk_test2', NULL::BIGINT);
 SELECT set_chunk_time_interval('chunk_test2', NULL::INTERVAL);
 \set ON_ERROR_STOP 1
+
+-- Pre-create the chunks of the next time interval, one per space
+-- partition. now() is fixed within the transaction.
+CREATE TABLE precreate_test(time timestamptz, device int, temp float);
+SELECT create_hypertable('precreate_test', 'time', 'device', 2, chunk_time_interval => INTERVAL '1 day');
+BEGIN;
+SELECT _timescaledb_internal.precreate_chunks('precreate_test');
+-- the chunks exist now, so nothing more is created
+SELECT _timescaledb_internal.precreate_chunks('precreate_test');
+-- a lookahead of three days also covers the two intervals after the next
+SELECT _timescaledb_internal.precreate_chunks('precreate_test', INTERVAL '3 days');
+COMMIT;
+SELECT count(*) FROM show_chunks('precreate_test');
+-- "next" is undefined for integer time, so nothing is created
+SELECT _timescaledb_internal.precreate_chunks('chunk_test');
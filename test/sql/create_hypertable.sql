@@ -283,3 +283,12 @@ select add_dimension('test_schema.test_partfunc', 'device', 2, partitioning_func
 -- A valid function should work:
 select add_dimension('test_schema.test_partfunc', 'device', 2, partitioning_func => 'partfunc_valid');
 
+
+-- Chunk indexes are built once all data has been migrated
+create table test_schema.test_migrate_idx(time timestamp, temp float);
+create index test_migrate_idx_temp on test_schema.test_migrate_idx(temp);
+insert into test_schema.test_migrate_idx VALUES ('2004-10-19 10:23:54+02', 1.0), ('2004-12-19 10:23:54+02', 2.0);
+select table_name from create_hypertable('test_schema.test_migrate_idx', 'time', migrate_data => true, create_default_indexes => false);
+select count(*), bool_and(i.indisvalid and i.indisready) as all_valid
+from show_chunks('test_schema.test_migrate_idx') c
+inner join pg_index i on (i.indrelid = c);
@@ -0,0 +1,59 @@
+-- Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+--
+-- This file is licensed under the Apache License,
+-- see LICENSE-APACHE at the top level directory.
+
+\c single :ROLE_SUPERUSER
+CREATE OR REPLACE FUNCTION _timescaledb_internal.test_dimension_slice_index_scan(dimension_id INTEGER, coordinate BIGINT, lim INTEGER = 0) RETURNS INTEGER
+    AS :MODULE_PATHNAME, 'ts_test_dimension_slice_index_scan' LANGUAGE C VOLATILE STRICT;
+CREATE OR REPLACE FUNCTION _timescaledb_internal.test_dimension_slice_index_scan_range(dimension_id INTEGER, start_strategy SMALLINT, start_value BIGINT, end_strategy SMALLINT, end_value BIGINT, lim INTEGER = 0) RETURNS INTEGER
+    AS :MODULE_PATHNAME, 'ts_test_dimension_slice_index_scan_range' LANGUAGE C VOLATILE STRICT;
+CREATE OR REPLACE FUNCTION _timescaledb_internal.test_dimension_slice_index_collision_scan(dimension_id INTEGER, range_start BIGINT, range_end BIGINT, lim INTEGER = 0) RETURNS INTEGER
+    AS :MODULE_PATHNAME, 'ts_test_dimension_slice_index_collision_scan' LANGUAGE C VOLATILE STRICT;
+\c single :ROLE_DEFAULT_PERM_USER
+
+-- The test functions look up slices in the slice index of a dimension and
+-- raise an error unless the corresponding catalog scan finds the same slices
+-- in the same order. They return the number of slices found.
+CREATE TABLE slices(time bigint NOT NULL, device int);
+SELECT table_name FROM create_hypertable('slices', 'time', 'device', 2, chunk_time_interval => 10);
+INSERT INTO slices VALUES (1, 1), (12, 1), (25, 2), (45, 2);
+SELECT id AS time_dim FROM _timescaledb_catalog.dimension WHERE column_name = 'time' \gset
+SELECT id AS space_dim FROM _timescaledb_catalog.dimension WHERE column_name = 'device' \gset
+
+-- Point lookups
+SELECT coordinate, _timescaledb_internal.test_dimension_slice_index_scan(:time_dim, coordinate) AS num_slices
+FROM unnest(ARRAY[-1, 0, 15, 35, 40, 50, 9223372036854775807]::bigint[]) AS coordinate;
+SELECT _timescaledb_internal.test_dimension_slice_index_scan(:time_dim, 15, 1) AS num_slices;
+SELECT _timescaledb_internal.test_dimension_slice_index_scan(:space_dim, 0) IN (0, 1) AS found;
+
+-- Range lookups, with strategies 1 (<), 2 (<=), 3 (=), 4 (>=), 5 (>) and 0
+-- for no condition. The end value is inclusive.
+SELECT s.*, _timescaledb_internal.test_dimension_slice_index_scan_range(:time_dim, start_strategy, start_value, end_strategy, end_value, lim) AS num_slices
+FROM (VALUES (4::smallint, 10::bigint, 2::smallint, 30::bigint, 0),
+             (4, 10, 2, 30, 1),
+             (4, 20, 0, 0, 0),
+             (1, 10, 0, 0, 0),
+             (3, 40, 3, 49, 0),
+             (0, 0, 5, 25, 0)) AS s(start_strategy, start_value, end_strategy, end_value, lim);
+
+-- Collision lookups
+SELECT s.*, _timescaledb_internal.test_dimension_slice_index_collision_scan(:time_dim, range_start, range_end, lim) AS num_slices
+FROM (VALUES (15::bigint, 45::bigint, 0),
+             (15, 45, 2),
+             (30, 40, 0),
+             (-100, 100, 0)) AS s(range_start, range_end, lim);
+SELECT _timescaledb_internal.test_dimension_slice_index_collision_scan(:space_dim, -9223372036854775808, 9223372036854775807) =
+       (SELECT count(*) FROM _timescaledb_catalog.dimension_slice WHERE dimension_id = :space_dim) AS all_found;
+
+-- Slices created after the index was built are found
+INSERT INTO slices VALUES (35, 1);
+SELECT _timescaledb_internal.test_dimension_slice_index_scan(:time_dim, 35) AS num_slices;
+
+-- Slices created in the current transaction are found, and are gone after a
+-- rollback
+BEGIN;
+INSERT INTO slices VALUES (65, 1);
+SELECT _timescaledb_internal.test_dimension_slice_index_scan(:time_dim, 65) AS num_slices;
+ROLLBACK;
+SELECT _timescaledb_internal.test_dimension_slice_index_scan(:time_dim, 65) AS num_slices;
@@ -77,3 +77,10 @@ SELECT _timescaledb_internal.get_partition_for_key(187::numeric);
 SELECT _timescaledb_internal.get_partition_for_key(187::double precision);
 SELECT _timescaledb_internal.get_partition_for_key(int4range(10, 20));
 SELECT _timescaledb_internal.get_partition_hash('08002b:010203'::macaddr);
+
+-- Types with native hashing should hash the same as through their
+-- type's hash function or text representation
+SELECT _timescaledb_internal.get_partition_hash(-187::bigint) = _timescaledb_internal.get_partition_hash(-187::int) AS int8_int4;
+SELECT _timescaledb_internal.get_partition_hash('dev1'::text) = _timescaledb_internal.get_partition_hash('dev1'::name) AS text_name;
+SELECT _timescaledb_internal.get_partition_for_key(-187::smallint) = _timescaledb_internal.get_partition_for_key('-187'::text) AS int2_text;
+SELECT _timescaledb_internal.get_partition_for_key(9223372036854775807) = _timescaledb_internal.get_partition_for_key('9223372036854775807'::text) AS int8_text;
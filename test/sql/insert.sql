@@ -85,6 +85,13 @@ select * from chunk_assert_fail;
 
 set timescaledb.max_open_chunks_per_insert=default;
 
+-- Out-of-order insertion with a memory budget that only fits one open
+-- chunk at a time
+set timescaledb.max_open_chunks_memory='1kB';
+insert into chunk_assert_fail values (1, 3), (2, 2), (1, 4), (2, 3);
+select * from chunk_assert_fail order by i, j;
+set timescaledb.max_open_chunks_memory=default;
+
 
 SELECT * FROM many_partitions_test_1m ORDER BY time, device LIMIT 10;
 
@@ -108,3 +115,105 @@ WITH insert_cte as (
 		('2001-01-01 01:03:01', 1.0, 'device')
 	)
 SELECT 1 \g | grep -v "Planning" | grep -v "Execution"
+
+-- Batched inserts return tuples grouped by chunk, but keep the order
+-- of tuples within a chunk so that the first duplicate wins
+CREATE TABLE batch_test(time int NOT NULL, device int, value float8);
+SELECT table_name FROM create_hypertable('batch_test', 'time', chunk_time_interval => 10);
+CREATE UNIQUE INDEX ON batch_test (time, device);
+SET timescaledb.insert_batch_size = 4;
+INSERT INTO batch_test VALUES
+(1, 1, 1.0), (11, 1, 2.0), (1, 1, 3.0), (21, 1, 4.0), (12, 1, 5.0), (2, 1, 6.0), (11, 1, 7.0)
+ON CONFLICT DO NOTHING;
+SELECT * FROM batch_test ORDER BY time, device;
+RESET timescaledb.insert_batch_size;
+
+-- Grouping rows by chunk batches up to work_mem of rows, again keeping
+-- the order of tuples within a chunk
+TRUNCATE batch_test;
+SET timescaledb.group_rows_by_chunk = on;
+INSERT INTO batch_test
+SELECT t % 30, 1, t FROM generate_series(0, 89) t
+ON CONFLICT DO NOTHING;
+SELECT count(*), min(value), max(value) FROM batch_test;
+RESET timescaledb.group_rows_by_chunk;
+
+-- Chunk insert state caching across statements in a transaction. The
+-- cached state must be invalidated when the chunk gets a new index.
+CREATE TABLE xact_cache(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('xact_cache', 'time', chunk_time_interval => 10);
+BEGIN;
+INSERT INTO xact_cache VALUES (1, 1);
+INSERT INTO xact_cache VALUES (2, 1);
+CREATE UNIQUE INDEX ON xact_cache (time);
+INSERT INTO xact_cache VALUES (1, 2), (3, 2) ON CONFLICT (time) DO UPDATE SET value = excluded.value;
+INSERT INTO xact_cache VALUES (2, 3), (3, 3) ON CONFLICT (time) DO UPDATE SET value = excluded.value;
+SELECT * FROM xact_cache ORDER BY time;
+COMMIT;
+
+-- Tuples that alternate between chunks are routed through the memo of
+-- recently used chunk insert states. When chunks have to be closed to
+-- make room for others, memo hits count as uses, so the chunk used on
+-- every other tuple is never the one closed.
+CREATE TABLE memo_test(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('memo_test', 'time', chunk_time_interval => 10);
+EXPLAIN (analyze, costs off, timing off)
+WITH insert_cte as (
+	INSERT INTO memo_test SELECT (i % 3) * 10, i FROM generate_series(1, 12) i
+	)
+SELECT 1 \g | grep -v "Planning" | grep -v "Execution"
+SET timescaledb.max_open_chunks_per_insert = 2;
+EXPLAIN (analyze, costs off, timing off)
+WITH insert_cte as (
+	INSERT INTO memo_test VALUES (0, 1), (10, 1), (0, 2), (20, 1), (0, 3), (30, 1), (0, 4)
+	)
+SELECT 1 \g | grep -v "Planning" | grep -v "Execution"
+RESET timescaledb.max_open_chunks_per_insert;
+SELECT time, count(*) FROM memo_test GROUP BY time ORDER BY time;
+
+-- Batched routing partitions the values of a space dimension for the
+-- whole batch at once. Rows must still go to the same chunks as when
+-- they are routed one at a time.
+CREATE TABLE batch_space(time int NOT NULL, device text, value int);
+SELECT table_name FROM create_hypertable('batch_space', 'time', 'device', 4, chunk_time_interval => 10);
+INSERT INTO batch_space SELECT t % 20, 'dev' || (t % 7), t FROM generate_series(0, 39) t;
+SET timescaledb.insert_batch_size = 8;
+INSERT INTO batch_space SELECT t % 20, 'dev' || (t % 7), t FROM generate_series(40, 79) t;
+INSERT INTO batch_space VALUES (1, NULL, 80), (2, 'dev1', 81);
+RESET timescaledb.insert_batch_size;
+SELECT count(*) FROM batch_space;
+SELECT device, time / 10 AS bucket, count(DISTINCT tableoid) AS chunks
+FROM batch_space
+GROUP BY device, bucket
+HAVING count(DISTINCT tableoid) > 1;
+
+-- Cached chunk insert state shared across statements and subtransactions.
+-- The CHECK constraints of space-partitioned chunks call the partitioning
+-- function, and are kept when there are BEFORE ROW triggers.
+CREATE TABLE xact_space(time int NOT NULL, device text, value int);
+SELECT table_name FROM create_hypertable('xact_space', 'time', 'device', 2, chunk_time_interval => 10);
+CREATE FUNCTION xact_space_check() RETURNS TRIGGER LANGUAGE plpgsql AS
+$BODY$
+BEGIN
+    IF NEW.value < 0 THEN
+        RAISE EXCEPTION 'negative value';
+    END IF;
+    RETURN NEW;
+END
+$BODY$;
+CREATE TRIGGER xact_space_check BEFORE INSERT ON xact_space
+FOR EACH ROW EXECUTE PROCEDURE xact_space_check();
+BEGIN;
+INSERT INTO xact_space VALUES (1, 'a', 1);
+INSERT INTO xact_space VALUES (2, 'a', 2);
+SAVEPOINT failing;
+\set ON_ERROR_STOP 0
+INSERT INTO xact_space VALUES (3, 'a', -1);
+\set ON_ERROR_STOP 1
+ROLLBACK TO SAVEPOINT failing;
+-- The rollback releases the cached state of the failed insert, so that it
+-- can be rebuilt when a new constraint invalidates it
+ALTER TABLE xact_space ADD CONSTRAINT value_limit CHECK (value < 100);
+INSERT INTO xact_space VALUES (4, 'a', 4);
+SELECT * FROM xact_space ORDER BY time;
+COMMIT;
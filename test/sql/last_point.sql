@@ -0,0 +1,108 @@
+-- Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+--
+-- This file is licensed under the Apache License,
+-- see LICENSE-APACHE at the top level directory.
+
+CREATE TABLE readings(time bigint NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('readings', 'time', 'device', 2, chunk_time_interval => 10);
+INSERT INTO readings VALUES (1, 1, 1.0), (2, 2, 2.0), (12, 1, 3.0), (3, NULL, 0.5);
+
+-- The last-point table is populated with the rows already in the hypertable
+SELECT enable_last_point('readings', 'device');
+SELECT * FROM _timescaledb_internal._hyper_1_last_point ORDER BY device;
+SELECT * FROM _timescaledb_catalog.hypertable_last_point;
+
+-- Inserts update the last point of a series only with newer rows
+INSERT INTO readings VALUES (25, 1, 4.0), (15, 1, 5.0), (5, 2, 6.0), (30, 3, 7.0);
+SELECT * FROM _timescaledb_internal._hyper_1_last_point ORDER BY device;
+
+COPY readings FROM STDIN DELIMITER ',';
+40,2,8.0
+20,3,9.0
+\.
+SELECT * FROM _timescaledb_internal._hyper_1_last_point ORDER BY device;
+
+\set ON_ERROR_STOP 0
+SELECT enable_last_point('readings', 'device');
+SELECT enable_last_point('readings', 'sensor');
+\set ON_ERROR_STOP 1
+
+-- Rows are tracked as stored: rows skipped by ON CONFLICT DO NOTHING or
+-- suppressed by a BEFORE ROW trigger are not tracked and rows changed by a
+-- trigger are tracked as changed
+CREATE UNIQUE INDEX readings_time_device_idx ON readings(time, device);
+INSERT INTO readings VALUES (30, 3, 10.0) ON CONFLICT DO NOTHING;
+SELECT * FROM _timescaledb_internal._hyper_1_last_point ORDER BY device;
+-- Rows written by ON CONFLICT DO UPDATE are tracked, unless the update is
+-- skipped
+INSERT INTO readings VALUES (30, 3, 11.0) ON CONFLICT (time, device) DO UPDATE SET value = excluded.value;
+INSERT INTO readings VALUES (25, 1, 12.0) ON CONFLICT (time, device) DO UPDATE SET value = excluded.value
+WHERE readings.value > 100;
+SELECT * FROM _timescaledb_internal._hyper_1_last_point ORDER BY device;
+CREATE FUNCTION readings_trigger() RETURNS TRIGGER LANGUAGE plpgsql AS
+$BODY$
+BEGIN
+    IF NEW.value < 0 THEN
+        RETURN NULL;
+    END IF;
+    NEW.value := NEW.value * 10;
+    RETURN NEW;
+END
+$BODY$;
+CREATE TRIGGER readings_trigger BEFORE INSERT ON readings
+FOR EACH ROW EXECUTE PROCEDURE readings_trigger();
+INSERT INTO readings VALUES (50, 1, -1.0), (45, 2, 2.0);
+COPY readings FROM STDIN DELIMITER ',';
+60,3,-1.0
+55,3,1.5
+\.
+DROP TRIGGER readings_trigger ON readings;
+SELECT * FROM _timescaledb_internal._hyper_1_last_point ORDER BY device;
+
+-- Last points are upserted with a search_path that users cannot put
+-- operators in
+CREATE FUNCTION bigint_le_fail(bigint, bigint) RETURNS BOOL LANGUAGE plpgsql AS
+$BODY$
+BEGIN
+    RAISE EXCEPTION 'operator in search_path used';
+END
+$BODY$;
+CREATE OPERATOR <= (PROCEDURE = bigint_le_fail, LEFTARG = bigint, RIGHTARG = bigint);
+SET search_path = public, pg_catalog;
+INSERT INTO readings VALUES (58, 1, 7.0);
+RESET search_path;
+DROP OPERATOR <= (bigint, bigint);
+DROP FUNCTION bigint_le_fail(bigint, bigint);
+
+-- Renaming columns renames them in the last-point table
+ALTER TABLE readings RENAME COLUMN time TO ts;
+ALTER TABLE readings RENAME COLUMN device TO sensor;
+ALTER TABLE readings RENAME COLUMN value TO reading;
+INSERT INTO readings VALUES (48, 2, 6.5);
+SELECT * FROM _timescaledb_internal._hyper_1_last_point ORDER BY sensor;
+
+-- Dropping a column drops it from the last-point table
+ALTER TABLE readings DROP COLUMN reading;
+INSERT INTO readings VALUES (59, 1);
+SELECT * FROM _timescaledb_internal._hyper_1_last_point ORDER BY sensor;
+
+-- The last-point table is looked up in the catalog, which follows renames
+ALTER TABLE _timescaledb_internal._hyper_1_last_point RENAME TO readings_last_point;
+ALTER TABLE _timescaledb_internal.readings_last_point SET SCHEMA public;
+SELECT * FROM _timescaledb_catalog.hypertable_last_point;
+INSERT INTO readings VALUES (61, 2);
+SELECT * FROM readings_last_point ORDER BY sensor;
+
+-- Dropping the series column drops the last-point table
+CREATE TABLE metrics(time bigint NOT NULL, sensor int, value float);
+SELECT table_name FROM create_hypertable('metrics', 'time', chunk_time_interval => 10);
+SELECT enable_last_point('metrics', 'sensor');
+ALTER TABLE metrics DROP COLUMN sensor;
+SELECT count(*) FROM pg_class WHERE relname = '_hyper_2_last_point';
+SELECT * FROM _timescaledb_catalog.hypertable_last_point;
+INSERT INTO metrics VALUES (1, 1.0);
+
+-- The last-point table is dropped with the hypertable
+DROP TABLE readings;
+SELECT count(*) FROM pg_class WHERE relname = 'readings_last_point';
+SELECT * FROM _timescaledb_catalog.hypertable_last_point;
@@ -31,3 +31,17 @@ REINDEX SCHEMA public;
 -- Not only simple statements should work
 CREATE TABLE a (aa TEXT);
 CREATE TABLE z (b TEXT, PRIMARY KEY(aa, b)) inherits (a);
+
+-- The planner caches that a table is not a hypertable. The cached
+-- entry must not be used once the table is made a hypertable, nor
+-- after that is rolled back.
+CREATE TABLE plain_then_hypertable(time timestamptz NOT NULL, temp float8);
+SELECT * FROM plain_then_hypertable;
+BEGIN;
+SELECT table_name FROM create_hypertable('plain_then_hypertable', 'time');
+INSERT INTO plain_then_hypertable VALUES ('2018-01-20T09:00:00+00', 23.4);
+SELECT count(*) FROM show_chunks('plain_then_hypertable');
+SELECT count(*) FROM ONLY plain_then_hypertable;
+ROLLBACK;
+INSERT INTO plain_then_hypertable VALUES ('2018-01-20T09:00:00+00', 23.4);
+SELECT count(*) FROM ONLY plain_then_hypertable;
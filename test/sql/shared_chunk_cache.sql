@@ -0,0 +1,56 @@
+-- Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+--
+-- This file is licensed under the Apache License,
+-- see LICENSE-APACHE at the top level directory.
+
+\c single :ROLE_SUPERUSER
+CREATE OR REPLACE FUNCTION _timescaledb_internal.test_shared_chunk_cache_find(hypertable REGCLASS, coordinates BIGINT[]) RETURNS REGCLASS
+    AS :MODULE_PATHNAME, 'ts_test_shared_chunk_cache_find' LANGUAGE C VOLATILE STRICT;
+\c single :ROLE_DEFAULT_PERM_USER
+
+-- The shared chunk cache is allocated by the loader. The test function finds
+-- the chunk covering a point through the cache, and raises an error unless
+-- the chunk matches the one in the catalog.
+SHOW timescaledb.shared_chunk_cache_size;
+CREATE TABLE cached(time bigint NOT NULL, device int);
+SELECT table_name FROM create_hypertable('cached', 'time', chunk_time_interval => 10);
+
+-- Chunks are added when the transaction that created them commits
+BEGIN;
+INSERT INTO cached VALUES (1, 1), (15, 1);
+SELECT _timescaledb_internal.test_shared_chunk_cache_find('cached', ARRAY[1]) AS chunk;
+COMMIT;
+SELECT coordinate, _timescaledb_internal.test_shared_chunk_cache_find('cached', ARRAY[coordinate]) AS chunk
+FROM unnest(ARRAY[1, 9, 15, 25]::bigint[]) AS coordinate;
+
+-- Other backends find the chunks as well, and can insert into them
+\c single :ROLE_DEFAULT_PERM_USER
+SELECT coordinate, _timescaledb_internal.test_shared_chunk_cache_find('cached', ARRAY[coordinate]) AS chunk
+FROM unnest(ARRAY[1, 9, 15, 25]::bigint[]) AS coordinate;
+INSERT INTO cached VALUES (5, 2);
+SELECT * FROM cached ORDER BY time, device;
+
+-- Chunks of rolled back transactions and subtransactions are not added
+BEGIN;
+INSERT INTO cached VALUES (25, 1);
+ROLLBACK;
+BEGIN;
+SAVEPOINT before_insert;
+INSERT INTO cached VALUES (35, 1);
+ROLLBACK TO SAVEPOINT before_insert;
+INSERT INTO cached VALUES (45, 1);
+COMMIT;
+SELECT coordinate, _timescaledb_internal.test_shared_chunk_cache_find('cached', ARRAY[coordinate]) AS chunk
+FROM unnest(ARRAY[25, 35, 45]::bigint[]) AS coordinate;
+
+-- Dropped chunks are removed
+DROP TABLE _timescaledb_internal._hyper_1_1_chunk;
+SELECT coordinate, _timescaledb_internal.test_shared_chunk_cache_find('cached', ARRAY[coordinate]) AS chunk
+FROM unnest(ARRAY[1, 15]::bigint[]) AS coordinate;
+
+-- Space partitioned hypertables are keyed on the slices of all dimensions
+CREATE TABLE cached_space(time bigint NOT NULL, device int);
+SELECT table_name FROM create_hypertable('cached_space', 'time', 'device', 2, chunk_time_interval => 10);
+INSERT INTO cached_space VALUES (1, 1), (1, 2);
+SELECT device, _timescaledb_internal.test_shared_chunk_cache_find('cached_space', ARRAY[1, _timescaledb_internal.get_partition_hash(device)]::bigint[]) IS NOT NULL AS found
+FROM unnest(ARRAY[1, 2]) AS device;
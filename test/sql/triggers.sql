@@ -295,3 +295,26 @@ DROP TRIGGER create_vehicle_trigger ON location;
 SELECT count(1) FROM pg_depend d WHERE d.classid = 'pg_trigger'::regclass AND NOT EXISTS (SELECT 1 FROM pg_trigger WHERE oid = d.objid);
 DROP TABLE location;
 
+
+-- A BEFORE ROW trigger that moves a tuple out of the chunk it was routed
+-- to still fails the chunk's dimension constraints
+CREATE TABLE move_test(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('move_test', 'time', chunk_time_interval => 10);
+CREATE OR REPLACE FUNCTION move_time_trigger_fn() RETURNS TRIGGER LANGUAGE PLPGSQL AS
+$BODY$
+BEGIN
+    NEW.time := NEW.time + 10;
+    RETURN NEW;
+END
+$BODY$;
+INSERT INTO move_test VALUES (1, 1);
+CREATE TRIGGER move_time_trigger BEFORE INSERT ON move_test
+    FOR EACH ROW EXECUTE PROCEDURE move_time_trigger_fn();
+DO $$
+BEGIN
+    INSERT INTO move_test VALUES (2, 2);
+EXCEPTION WHEN check_violation THEN
+    RAISE NOTICE 'tuple moved out of its chunk';
+END
+$$;
+SELECT * FROM move_test ORDER BY time;
@@ -5,6 +5,14 @@
 
 SELECT * FROM public."two_Partitions";
 
+-- Chunks of a wide range over the space-partitioned hypertable are found
+-- through the dimension_slice_id index of the chunk constraints, which the
+-- update script adds
+SELECT tableoid::regclass AS chunk, count(*)
+FROM public."two_Partitions"
+WHERE "timeCustom" >= 1257894000000000000 AND "timeCustom" <= 1258894000000000000
+GROUP BY 1 ORDER BY 1;
+
 \d+ _timescaledb_internal.*
 
 CREATE OR REPLACE FUNCTION timescaledb_integrity_test()
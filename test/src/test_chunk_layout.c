@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+ *
+ * This file is licensed under the Apache License,
+ * see LICENSE-APACHE at the top level directory.
+ */
+#include <postgres.h>
+#include <access/heapam.h>
+#include <fmgr.h>
+#include <utils/rel.h>
+
+#include "compat.h"
+#include "chunk.h"
+#include "chunk_insert_state.h"
+
+TS_FUNCTION_INFO_V1(ts_test_chunk_tuple_conversion_needed);
+
+/*
+ * Check if tuples inserted into a chunk's hypertable need conversion to the
+ * chunk's rowtype, i.e., if the chunk's insert state gets a tuple conversion
+ * map.
+ */
+Datum
+ts_test_chunk_tuple_conversion_needed(PG_FUNCTION_ARGS)
+{
+	Chunk	   *chunk = ts_chunk_get_by_relid(PG_GETARG_OID(0), 0, true);
+	Relation	htrel = heap_open(chunk->hypertable_relid, AccessShareLock);
+	Relation	chunkrel = heap_open(chunk->table_id, AccessShareLock);
+	bool		needed;
+
+	needed = NULL != ts_chunk_insert_state_tuple_conversion_map(RelationGetDescr(htrel),
+																RelationGetDescr(chunkrel));
+
+	heap_close(chunkrel, AccessShareLock);
+	heap_close(htrel, AccessShareLock);
+
+	PG_RETURN_BOOL(needed);
+}
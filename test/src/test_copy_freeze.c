@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+ *
+ * This file is licensed under the Apache License,
+ * see LICENSE-APACHE at the top level directory.
+ */
+#include <postgres.h>
+#include <access/heapam.h>
+#include <access/htup_details.h>
+#include <fmgr.h>
+#include <storage/bufmgr.h>
+#include <utils/rel.h>
+#include <utils/tqual.h>
+
+#include "compat.h"
+
+TS_FUNCTION_INFO_V1(ts_test_tuple_frozen);
+
+/*
+ * Check if the tuple at the given position in a table is frozen, e.g.,
+ * because it was written by COPY FREEZE.
+ */
+Datum
+ts_test_tuple_frozen(PG_FUNCTION_ARGS)
+{
+	Relation	rel = heap_open(PG_GETARG_OID(0), AccessShareLock);
+	HeapTupleData tuple;
+	Buffer		buffer;
+	bool		frozen;
+
+	tuple.t_self = *((ItemPointer) PG_GETARG_POINTER(1));
+
+	if (!heap_fetch(rel, SnapshotAny, &tuple, &buffer, true, NULL))
+		elog(ERROR, "tuple (%u,%u) not found in \"%s\"",
+			 ItemPointerGetBlockNumber(&tuple.t_self),
+			 ItemPointerGetOffsetNumber(&tuple.t_self),
+			 RelationGetRelationName(rel));
+
+	LockBuffer(buffer, BUFFER_LOCK_SHARE);
+	frozen = HeapTupleHeaderXminFrozen(tuple.t_data);
+	UnlockReleaseBuffer(buffer);
+
+	heap_close(rel, AccessShareLock);
+
+	PG_RETURN_BOOL(frozen);
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+ *
+ * This file is licensed under the Apache License,
+ * see LICENSE-APACHE at the top level directory.
+ */
+#include <postgres.h>
+#include <fmgr.h>
+
+#include "compat.h"
+#include "dimension.h"
+#include "dimension_slice.h"
+#include "dimension_slice_index.h"
+#include "hypertable.h"
+#include "hypertable_cache.h"
+
+TS_FUNCTION_INFO_V1(ts_test_dimension_slice_index_scan);
+TS_FUNCTION_INFO_V1(ts_test_dimension_slice_index_scan_range);
+TS_FUNCTION_INFO_V1(ts_test_dimension_slice_index_collision_scan);
+
+/*
+ * Get a dimension from the hypertable cache, where it keeps its slice index.
+ * The cache must stay pinned while the dimension is used.
+ */
+static Dimension *
+test_get_dimension(Cache *hcache, int32 dimension_id)
+{
+	Oid			relid = ts_hypertable_id_to_relid(ts_dimension_get_hypertable_id(dimension_id));
+	Hypertable *ht = ts_hypertable_cache_get_entry(hcache, relid);
+	Dimension  *dim;
+
+	if (NULL == ht)
+		elog(ERROR, "no hypertable for dimension %d", dimension_id);
+
+	dim = ts_hyperspace_get_dimension_by_id(ht->space, dimension_id);
+
+	if (NULL == dim)
+		elog(ERROR, "dimension %d not found", dimension_id);
+
+	return dim;
+}
+
+/*
+ * Check that a slice index lookup found the same slices, in the same order, as
+ * the corresponding catalog scan. Returns the number of slices found.
+ */
+static int32
+test_compare_slices(DimensionVec *found, DimensionVec *scanned)
+{
+	int			i;
+
+	if (found->num_slices != scanned->num_slices)
+		elog(ERROR, "slice index found %d slices, catalog scan found %d",
+			 found->num_slices, scanned->num_slices);
+
+	for (i = 0; i < found->num_slices; i++)
+		if (found->slices[i]->fd.id != scanned->slices[i]->fd.id)
+			elog(ERROR, "slice index found slice %d at position %d, catalog scan found slice %d",
+				 found->slices[i]->fd.id, i, scanned->slices[i]->fd.id);
+
+	return found->num_slices;
+}
+
+Datum
+ts_test_dimension_slice_index_scan(PG_FUNCTION_ARGS)
+{
+	int32		dimension_id = PG_GETARG_INT32(0);
+	int64		coordinate = PG_GETARG_INT64(1);
+	int32		limit = PG_GETARG_INT32(2);
+	Cache	   *hcache = ts_hypertable_cache_pin();
+	Dimension  *dim = test_get_dimension(hcache, dimension_id);
+	int32		num_slices;
+
+	num_slices = test_compare_slices(ts_dimension_slice_index_scan_limit(dim, coordinate, limit),
+									 ts_dimension_slice_scan_limit(dimension_id, coordinate, limit));
+	ts_cache_release(hcache);
+
+	PG_RETURN_INT32(num_slices);
+}
+
+Datum
+ts_test_dimension_slice_index_scan_range(PG_FUNCTION_ARGS)
+{
+	int32		dimension_id = PG_GETARG_INT32(0);
+	StrategyNumber start_strategy = PG_GETARG_INT16(1);
+	int64		start_value = PG_GETARG_INT64(2);
+	StrategyNumber end_strategy = PG_GETARG_INT16(3);
+	int64		end_value = PG_GETARG_INT64(4);
+	int32		limit = PG_GETARG_INT32(5);
+	Cache	   *hcache = ts_hypertable_cache_pin();
+	Dimension  *dim = test_get_dimension(hcache, dimension_id);
+	int32		num_slices;
+
+	num_slices = test_compare_slices(ts_dimension_slice_index_scan_range_limit(dim,
+																			   start_strategy,
+																			   start_value,
+																			   end_strategy,
+																			   end_value,
+																			   limit),
+									 ts_dimension_slice_scan_range_limit(dimension_id,
+																		 start_strategy,
+																		 start_value,
+																		 end_strategy,
+																		 end_value,
+																		 limit));
+	ts_cache_release(hcache);
+
+	PG_RETURN_INT32(num_slices);
+}
+
+Datum
+ts_test_dimension_slice_index_collision_scan(PG_FUNCTION_ARGS)
+{
+	int32		dimension_id = PG_GETARG_INT32(0);
+	int64		range_start = PG_GETARG_INT64(1);
+	int64		range_end = PG_GETARG_INT64(2);
+	int32		limit = PG_GETARG_INT32(3);
+	Cache	   *hcache = ts_hypertable_cache_pin();
+	Dimension  *dim = test_get_dimension(hcache, dimension_id);
+	int32		num_slices;
+
+	num_slices = test_compare_slices(ts_dimension_slice_index_collision_scan_limit(dim, range_start, range_end, limit),
+									 ts_dimension_slice_collision_scan_limit(dimension_id, range_start, range_end, limit));
+	ts_cache_release(hcache);
+
+	PG_RETURN_INT32(num_slices);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2016-2018  Timescale, Inc. All Rights Reserved.
+ *
+ * This file is licensed under the Apache License,
+ * see LICENSE-APACHE at the top level directory.
+ */
+#include <postgres.h>
+#include <catalog/pg_type.h>
+#include <fmgr.h>
+#include <utils/array.h>
+#include <utils/lsyscache.h>
+
+#include "compat.h"
+#include "chunk.h"
+#include "dimension.h"
+#include "dimension_slice.h"
+#include "hypercube.h"
+#include "hypertable.h"
+#include "hypertable_cache.h"
+#include "shared_chunk_cache.h"
+
+TS_FUNCTION_INFO_V1(ts_test_shared_chunk_cache_find);
+
+/*
+ * Check that a chunk built from the shared chunk cache matches the chunk in
+ * the catalog.
+ */
+static void
+test_compare_chunks(Chunk *cached, Chunk *chunk)
+{
+	int			i;
+
+	if (NULL == chunk)
+		elog(ERROR, "shared chunk cache found chunk %d, catalog has no chunk", cached->fd.id);
+
+	if (cached->fd.id != chunk->fd.id || cached->table_id != chunk->table_id)
+		elog(ERROR, "shared chunk cache found chunk %d, catalog has chunk %d",
+			 cached->fd.id, chunk->fd.id);
+
+	if (cached->cube->num_slices != chunk->cube->num_slices ||
+		cached->constraints->num_dimension_constraints != chunk->cube->num_slices)
+		elog(ERROR, "chunk %d from shared chunk cache has %d slices and %d dimension constraints, expected %d",
+			 cached->fd.id, cached->cube->num_slices,
+			 cached->constraints->num_dimension_constraints, chunk->cube->num_slices);
+
+	for (i = 0; i < chunk->cube->num_slices; i++)
+	{
+		DimensionSlice *left = cached->cube->slices[i];
+		DimensionSlice *right = chunk->cube->slices[i];
+
+		if (left->fd.id != right->fd.id ||
+			left->fd.dimension_id != right->fd.dimension_id ||
+			left->fd.range_start != right->fd.range_start ||
+			left->fd.range_end != right->fd.range_end)
+			elog(ERROR, "chunk %d from shared chunk cache has slice %d, expected slice %d",
+				 cached->fd.id, left->fd.id, right->fd.id);
+	}
+}
+
+/*
+ * Find the chunk covering a point through the shared chunk cache. Returns the
+ * chunk's table or NULL on a cache miss, and raises an error unless the
+ * chunk matches the catalog.
+ */
+Datum
+ts_test_shared_chunk_cache_find(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	ArrayType  *coordinates = PG_GETARG_ARRAYTYPE_P(1);
+	Cache	   *hcache = ts_hypertable_cache_pin();
+	Hypertable *ht = ts_hypertable_cache_get_entry(hcache, relid);
+	Datum	   *values;
+	bool	   *nulls;
+	int			num_values;
+	Point	   *point;
+	Chunk	   *chunk;
+	int			i;
+
+	if (NULL == ht)
+		elog(ERROR, "table \"%s\" is not a hypertable", get_rel_name(relid));
+
+	deconstruct_array(coordinates, INT8OID, 8, FLOAT8PASSBYVAL, 'd', &values, &nulls, &num_values);
+
+	if (num_values != ht->space->num_dimensions)
+		elog(ERROR, "expected %d coordinates", ht->space->num_dimensions);
+
+	point = palloc0(POINT_SIZE(num_values));
+	point->cardinality = num_values;
+	point->num_coords = num_values;
+
+	for (i = 0; i < num_values; i++)
+	{
+		if (nulls[i])
+			elog(ERROR, "coordinates cannot be NULL");
+
+		point->coordinates[i] = DatumGetInt64(values[i]);
+	}
+
+	chunk = ts_shared_chunk_cache_find(ht->space, point);
+
+	if (NULL != chunk)
+		test_compare_chunks(chunk, ts_chunk_find(ht->space, point));
+
+	ts_cache_release(hcache);
+
+	if (NULL == chunk)
+		PG_RETURN_NULL();
+
+	PG_RETURN_OID(chunk->table_id);
+}